@@ -522,6 +522,11 @@ public:
   /// IR as a constant, and thus can be used as a constant initializer in C.
   bool isConstantInitializer(ASTContext &Ctx, bool ForRef) const;
 
+  /// getLiteralValue - Return true if this is an integer, character or
+  /// floating-point literal, possibly parenthesized and negated, and set
+  /// \p Result to its value.  The constant evaluator is not involved.
+  bool getLiteralValue(APValue &Result, const ASTContext &Ctx) const;
+
   /// EvalStatus is a struct with detailed info about an evaluation in progress.
   struct EvalStatus {
     /// HasSideEffects - Whether the evaluated expression has side effects.
@@ -1472,12 +1477,13 @@ private:
   unsigned CharByteWidth : 4;
   unsigned Kind : 3;
   unsigned IsPascal : 1;
+  unsigned IsEmbedded : 1;
   unsigned NumConcatenated;
   SourceLocation TokLocs[1];
 
   StringLiteral(QualType Ty) :
     Expr(StringLiteralClass, Ty, VK_LValue, OK_Ordinary, false, false, false,
-         false) {}
+         false), IsEmbedded(false) {}
 
   static int mapCharByteWidth(TargetInfo const &target,StringKind k);
 
@@ -1548,6 +1554,12 @@ public:
   bool isUTF32() const { return Kind == UTF32; }
   bool isPascal() const { return IsPascal; }
 
+  /// \brief Whether this literal holds the contents of a file embedded with
+  /// __builtin_embed.  Its contents were never spelled in the source, so its
+  /// only token is the name of the file.
+  bool isEmbedded() const { return IsEmbedded; }
+  void setEmbedded(bool E) { IsEmbedded = E; }
+
   bool containsNonAsciiOrNull() const {
     StringRef Str = getString();
     for (unsigned i = 0, e = Str.size(); i != e; ++i)
@@ -1575,6 +1587,7 @@ public:
   /// Strings are amazingly complex.  They can be formed from multiple tokens
   /// and can have escape sequences in them in addition to the usual trigraph
   /// and escaped newline business.  This routine handles this complexity.
+  /// Every byte of an embedded file maps to the file name.
   ///
   SourceLocation getLocationOfByte(unsigned ByteNo, const SourceManager &SM,
                                    const LangOptions &Features,
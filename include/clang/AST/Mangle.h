@@ -155,6 +155,9 @@ public:
   virtual void mangleTypeName(QualType T, raw_ostream &) = 0;
 
   /// @}
+
+  /// \brief Print statistics about the names mangled so far.
+  virtual void PrintStats() const { }
 };
 
 class ItaniumMangleContext : public MangleContext {
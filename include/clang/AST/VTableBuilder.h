@@ -272,7 +272,7 @@ public:
 
   bool isMicrosoft() const { return IsMicrosoftABI; }
 
-  virtual ~VTableContextBase() {}
+  virtual ~VTableContextBase();
 
 protected:
   typedef llvm::DenseMap<const CXXMethodDecl *, ThunkInfoVectorTy> ThunksMapTy;
@@ -280,15 +280,55 @@ protected:
   /// \brief Contains all thunks that a given method decl will need.
   ThunksMapTy Thunks;
 
+  typedef llvm::DenseMap<const CXXRecordDecl *, CXXFinalOverriderMap *>
+    FinalOverriderMapsTy;
+
+  /// \brief The final overriders of every virtual function in every base
+  /// subobject of a class, for each class whose vtables were laid out.
+  ///
+  /// They are shared between the vtables of the class itself and the
+  /// construction vtables in which it is the most derived class.
+  FinalOverriderMapsTy FinalOverriderMaps;
+
+  // Statistics.
+  unsigned NumVTableLayouts;
+  unsigned NumFinalOverriderMaps;
+  unsigned NumFinalOverriderMapHits;
+  unsigned NumThunkQueries;
+
+  /// \brief The wall clock time spent laying out vtables, in microseconds.
+  uint64_t LayoutTime;
+
   /// Compute and store all vtable related information (vtable layout, vbase
   /// offset offsets, thunks etc) for the given record decl.
   virtual void computeVTableRelatedInformation(const CXXRecordDecl *RD) = 0;
 
-  VTableContextBase(bool MS) : IsMicrosoftABI(MS) {}
+  VTableContextBase(bool MS)
+    : NumVTableLayouts(0), NumFinalOverriderMaps(0),
+      NumFinalOverriderMapHits(0), NumThunkQueries(0), LayoutTime(0),
+      IsMicrosoftABI(MS) {}
+
+  /// \brief Time the layout of a vtable, counting it in the statistics.
+  class LayoutTimer {
+    VTableContextBase &VTables;
+    uint64_t Start;
+
+  public:
+    explicit LayoutTimer(VTableContextBase &VTables);
+    ~LayoutTimer();
+  };
 
 public:
+  /// \brief Retrieve the final overriders of all virtual functions in all
+  /// base subobjects of \p RD, computing them on first use.
+  const CXXFinalOverriderMap &getFinalOverriders(const CXXRecordDecl *RD);
+
+  /// \brief Print statistics about the vtables laid out so far.
+  void PrintStats() const;
+
   virtual const ThunkInfoVectorTy *getThunkInfo(GlobalDecl GD) {
     const CXXMethodDecl *MD = cast<CXXMethodDecl>(GD.getDecl()->getCanonicalDecl());
+    ++NumThunkQueries;
     computeVTableRelatedInformation(MD->getParent());
 
     // This assumes that all the destructors present in the vtable
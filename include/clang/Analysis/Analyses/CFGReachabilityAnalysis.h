@@ -18,6 +18,8 @@
 
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "clang/Basic/LLVM.h"
 
 namespace clang {
 
@@ -25,15 +27,29 @@ class CFG;
 class CFGBlock;
   
 // A class that performs reachability queries for CFGBlocks. Several internal
-// checks in this checker require reachability information. The requests all
-// tend to have a common destination, so we lazily do a predecessor search
-// from the destination node and cache the results to prevent work
-// duplication.
+// checks in this checker require reachability information.
+//
+// On construction, the CFG is indexed in linear time: blocks are grouped into
+// strongly connected components numbered in reverse topological order, each
+// component is labeled with the interval of component numbers reachable from
+// it, and each block is labeled with its interval in a depth-first spanning
+// forest.  Most queries are answered from these labels in constant time.
+// Queries the labels cannot decide fall back to a predecessor search from the
+// destination node; the requests all tend to have a common destination, so
+// the results of that search are cached to prevent work duplication.
 class CFGReverseBlockReachabilityAnalysis {
   typedef llvm::BitVector ReachableSet;
   typedef llvm::DenseMap<unsigned, ReachableSet> ReachableMap;
   ReachableSet analyzed;
   ReachableMap reachable;
+
+  /// The strongly connected component of each block, by block ID.
+  SmallVector<unsigned, 16> SCCOf;
+  /// The smallest component number reachable from each component.
+  SmallVector<unsigned, 16> SCCLow;
+  /// Pre-order number of each block, and the largest pre-order number in its
+  /// depth-first spanning subtree.
+  SmallVector<unsigned, 16> TreeIn, TreeOut;
 public:
   CFGReverseBlockReachabilityAnalysis(const CFG &cfg);
 
@@ -41,6 +57,7 @@ public:
   bool isReachable(const CFGBlock *Src, const CFGBlock *Dst);
 
 private:
+  void buildIndex(const CFG &cfg);
   void mapReachability(const CFGBlock *Dst);
 };
   
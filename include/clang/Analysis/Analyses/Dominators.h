@@ -17,6 +17,7 @@
 #include "clang/Analysis/AnalysisContext.h"
 #include "clang/Analysis/CFG.h"
 #include "llvm/ADT/GraphTraits.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/GenericDomTree.h"
 #include "llvm/Support/GenericDomTreeConstruction.h"
 
@@ -161,6 +162,97 @@ private:
   CFG *cfg;
 };
 
+/// \brief A dominator or post-dominator tree computed directly on a Clang CFG.
+///
+/// Unlike DominatorTree, this does not go through LLVM's generic dominator
+/// tree construction.  Immediate dominators are computed with the iterative
+/// algorithm of Cooper, Harvey and Kennedy ("A Simple, Fast Dominance
+/// Algorithm") and stored in flat arrays indexed by CFGBlock ID.  The tree is
+/// then numbered by a depth-first walk so that dominance queries are answered
+/// in constant time.
+///
+/// For a post-dominator tree the root is the exit block and the CFG is walked
+/// along predecessor edges.  Blocks that cannot reach the root (or, for
+/// dominators, cannot be reached from it) are not part of the tree.
+class CFGDomTree : public ManagedAnalysis {
+  virtual void anchor();
+public:
+  CFGDomTree(const CFG &cfg, bool IsPostDom);
+
+  /// \brief Returns true if this is a post-dominator tree.
+  bool isPostDominator() const { return IsPostDom; }
+
+  /// \brief Returns the root of the tree: the entry block for dominators and
+  /// the exit block for post-dominators.
+  const CFGBlock *getRoot() const { return Root; }
+
+  /// \brief Returns true if the given block is part of the tree.
+  bool isReachableFromRoot(const CFGBlock *B) const {
+    return B && DFSIn[B->getBlockID()] != Unnumbered;
+  }
+
+  /// \brief Returns the immediate (post-)dominator of \p B, or null if \p B
+  /// is the root or is not part of the tree.
+  const CFGBlock *getIDom(const CFGBlock *B) const;
+
+  /// \brief Returns true if \p A (post-)dominates \p B.  A block always
+  /// dominates itself.
+  bool dominates(const CFGBlock *A, const CFGBlock *B) const {
+    if (!isReachableFromRoot(A) || !isReachableFromRoot(B))
+      return false;
+    unsigned AID = A->getBlockID(), BID = B->getBlockID();
+    return DFSIn[AID] <= DFSIn[BID] && DFSOut[BID] <= DFSOut[AID];
+  }
+
+  /// \brief Returns true if \p A (post-)dominates \p B and A != B.
+  bool properlyDominates(const CFGBlock *A, const CFGBlock *B) const {
+    return A != B && dominates(A, B);
+  }
+
+  /// \brief Finds the nearest block that (post-)dominates both \p A and
+  /// \p B, or null if either block is not part of the tree.
+  const CFGBlock *findNearestCommonDominator(const CFGBlock *A,
+                                             const CFGBlock *B) const;
+
+  /// \brief Prints the immediate (post-)dominator of each block in the same
+  /// "(Node#,IDom#)" format as DominatorTree::dump().  The root and blocks
+  /// outside of the tree are printed as their own immediate dominator.
+  void print(raw_ostream &OS) const;
+  void dump() const;
+
+private:
+  static const unsigned Unnumbered = ~0U;
+
+  bool IsPostDom;
+  const CFGBlock *Root;
+
+  /// Maps block IDs back to blocks.
+  SmallVector<const CFGBlock *, 16> Blocks;
+  /// Block ID of the immediate dominator, or Unnumbered.
+  SmallVector<unsigned, 16> IDom;
+  /// Pre- and post-order numbers of each block in the dominator tree.
+  SmallVector<unsigned, 16> DFSIn, DFSOut;
+};
+
+/// \brief The CFGDomTree of a function's CFG, managed by AnalysisDeclContext.
+class CFGDominatorTree : public CFGDomTree {
+public:
+  explicit CFGDominatorTree(const CFG &cfg) : CFGDomTree(cfg, false) {}
+
+  static CFGDominatorTree *create(AnalysisDeclContext &Ctx);
+  static const void *getTag();
+};
+
+/// \brief The post-dominator CFGDomTree of a function's CFG, managed by
+/// AnalysisDeclContext.
+class CFGPostDominatorTree : public CFGDomTree {
+public:
+  explicit CFGPostDominatorTree(const CFG &cfg) : CFGDomTree(cfg, true) {}
+
+  static CFGPostDominatorTree *create(AnalysisDeclContext &Ctx);
+  static const void *getTag();
+};
+
 } // end namespace clang
 
 //===-------------------------------------
@@ -20,6 +20,7 @@
 #define LLVM_CLANG_FORMAT_H
 
 #include "clang/AST/CanonicalType.h"
+#include <vector>
 
 namespace clang {
 
@@ -646,6 +647,64 @@ bool ParseScanfString(FormatStringHandler &H,
                       const char *beg, const char *end, const LangOptions &LO,
                       const TargetInfo &Target);
 
+/// \brief The handler callbacks produced by parsing a printf or scanf format
+/// string, recorded so that they can be replayed into any number of handlers
+/// without parsing the string again.
+///
+/// The pointers passed to a handler during replay point into the buffer that
+/// was originally parsed, so that buffer must outlive this object, and
+/// handlers must compute string positions relative to getBegin().
+class ParsedFormatString {
+public:
+  enum Kind { Printf, Scanf };
+
+  ParsedFormatString(Kind K, const char *beg, const char *end,
+                     const LangOptions &LO, const TargetInfo &Target);
+
+  Kind getKind() const { return K; }
+  const char *getBegin() const { return Beg; }
+  const char *getEnd() const { return End; }
+
+  /// \brief Invokes \p H exactly as ParsePrintfString or ParseScanfString
+  /// would have for the parsed string.
+  ///
+  /// \returns true if processing stopped early, in which case the caller
+  /// should not finish processing the format string.
+  bool Replay(FormatStringHandler &H) const;
+
+private:
+  class Recorder;
+
+  enum EventKind {
+    EK_NullChar,
+    EK_Position,
+    EK_InvalidPosition,
+    EK_ZeroPosition,
+    EK_IncompleteSpecifier,
+    EK_InvalidPrintfConversionSpecifier,
+    EK_PrintfSpecifier,
+    EK_InvalidScanfConversionSpecifier,
+    EK_ScanfSpecifier,
+    EK_IncompleteScanList
+  };
+
+  struct Event {
+    EventKind Kind;
+    const char *Start;
+    unsigned Length;
+    /// The index of the recorded specifier, or the PositionContext.
+    unsigned Extra;
+  };
+
+  Kind K;
+  const char *Beg, *End;
+  /// Whether the parser itself stopped, independently of the handler.
+  bool ParseStopped;
+  std::vector<Event> Events;
+  std::vector<analyze_printf::PrintfSpecifier> PrintfSpecifiers;
+  std::vector<analyze_scanf::ScanfSpecifier> ScanfSpecifiers;
+};
+
 } // end analyze_format_string namespace
 } // end clang namespace
 #endif
@@ -224,6 +224,14 @@ private:
 
     DiagnosticMappingInfo &getOrAddMappingInfo(diag::kind Diag);
 
+    /// \brief Returns a copy of this state to be modified at a new state
+    /// point.
+    ///
+    /// Entries that merely cache the default mapping of a diagnostic are left
+    /// out, since they are recomputed on demand; otherwise every state
+    /// created by a pragma would carry every diagnostic queried so far.
+    DiagState cloneForNewPoint() const;
+
     const_iterator begin() const { return DiagMap.begin(); }
     const_iterator end() const { return DiagMap.end(); }
   };
@@ -285,6 +293,15 @@ private:
   /// the given source location.
   DiagStatePointsTy::iterator GetDiagStatePointForLoc(SourceLocation Loc) const;
 
+  /// \brief The result of the last GetDiagStatePointForLoc query with a
+  /// valid location, and the number of state points at the time.
+  ///
+  /// Queries come in runs for the same or nearby locations, so the state
+  /// point found last is checked before searching all of them.  Any change to
+  /// DiagStatePoints adds points, which invalidates this cache.
+  mutable unsigned LastDiagStatePointPos;
+  mutable unsigned LastDiagStatePointCount;
+
   /// \brief Sticky flag set to \c true when an error is emitted.
   bool ErrorOccurred;
 
@@ -104,6 +104,17 @@ public:
 
   bool hasNoErrorAsFatal() const { return HasNoErrorAsFatal; }
   void setNoErrorAsFatal(bool Value) { HasNoErrorAsFatal = Value; }
+
+  bool operator==(const DiagnosticMappingInfo &RHS) const {
+    return Mapping == RHS.Mapping && IsUser == RHS.IsUser &&
+           IsPragma == RHS.IsPragma &&
+           HasShowInSystemHeader == RHS.HasShowInSystemHeader &&
+           HasNoWarningAsError == RHS.HasNoWarningAsError &&
+           HasNoErrorAsFatal == RHS.HasNoErrorAsFatal;
+  }
+  bool operator!=(const DiagnosticMappingInfo &RHS) const {
+    return !(*this == RHS);
+  }
 };
 
 /// \brief Used for handling and querying diagnostic IDs.
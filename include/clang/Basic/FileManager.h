@@ -20,6 +20,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
@@ -46,10 +47,12 @@ class FileSystemStatCache;
 /// the virtual file system).
 class DirectoryEntry {
   const char *Name;   // Name of the directory.
+  time_t ModTime;     // Modification time of the directory.
   friend class FileManager;
 public:
-  DirectoryEntry() : Name(0) {}
+  DirectoryEntry() : Name(0), ModTime(0) {}
   const char *getName() const { return Name; }
+  time_t getModificationTime() const { return ModTime; }
 };
 
 /// \brief Cached information about one file (either on disk
@@ -110,6 +113,7 @@ public:
 };
 
 struct FileData;
+class FilePrefetcher;
 
 /// \brief Implements support for file system lookup, file system caching,
 /// and directory search management.
@@ -164,6 +168,22 @@ class FileManager : public RefCountedBase<FileManager> {
   ///
   unsigned NextFileUID;
 
+  /// \brief Whether to record the entries of SeenDirEntries and
+  /// SeenFileEntries that are looked up, for discardUnusedEntries().
+  bool TrackUsedEntries;
+
+  /// \brief The entries of SeenDirEntries looked up since tracking started or
+  /// since the last call to discardUnusedEntries().
+  ///
+  /// These are only ever compared against, never dereferenced, so entries
+  /// erased from the map in the meantime do no harm.
+  llvm::SmallPtrSet<llvm::StringMapEntry<DirectoryEntry *> *, 64>
+    UsedDirEntries;
+
+  /// \brief The entries of SeenFileEntries looked up since tracking started
+  /// or since the last call to discardUnusedEntries().
+  llvm::SmallPtrSet<llvm::StringMapEntry<FileEntry *> *, 64> UsedFileEntries;
+
   // Statistics.
   unsigned NumDirLookups, NumFileLookups;
   unsigned NumDirCacheMisses, NumFileCacheMisses;
@@ -171,9 +191,17 @@ class FileManager : public RefCountedBase<FileManager> {
   // Caching.
   OwningPtr<FileSystemStatCache> StatCache;
 
+  /// \brief Reads files on background threads before they are asked for,
+  /// if enabled by FileSystemOptions::PrefetchThreads.
+  OwningPtr<FilePrefetcher> Prefetcher;
+
   bool getStatValue(const char *Path, FileData &Data, bool isFile,
                     int *FileDescriptor);
 
+  /// \brief Put FileSystemOpts.Overlay, if any, at the beginning of the
+  /// chain of stat caches.
+  void installOverlayStatCache();
+
   /// Add all ancestors of the given path (pointing to either a file
   /// or a directory) as virtual directories.
   void addAncestorsAsVirtualDirs(StringRef Path);
@@ -192,15 +220,24 @@ public:
   ///
   /// \param AtBeginning whether this new stat cache must be installed at the
   /// beginning of the chain of stat caches. Otherwise, it will be added to
-  /// the end of the chain.
+  /// the end of the chain, below the FileSystemOptions::Overlay if there is
+  /// one.
   void addStatCache(FileSystemStatCache *statCache, bool AtBeginning = false);
 
   /// \brief Removes the specified FileSystemStatCache object from the manager.
   void removeStatCache(FileSystemStatCache *statCache);
 
   /// \brief Removes all FileSystemStatCache objects from the manager.
+  ///
+  /// The FileSystemOptions::Overlay stays in effect.
   void clearStatCaches();
 
+  /// \brief Retrieve the prefetcher used to read files ahead of time, or
+  /// null if prefetching is disabled.
+  ///
+  /// The prefetcher's threads are started by the first call.
+  FilePrefetcher *getPrefetcher();
+
   /// \brief Lookup, cache, and verify the specified directory (real or
   /// virtual).
   ///
@@ -244,13 +281,45 @@ public:
   /// \brief Get the 'stat' information for the given \p Path.
   ///
   /// If the path is relative, it will be resolved against the WorkingDir of the
-  /// FileManager's FileSystemOptions.
-  bool getNoncachedStatValue(StringRef Path,
-                             llvm::sys::fs::file_status &Result);
+  /// FileManager's FileSystemOptions.  The stat caches are bypassed, but the
+  /// FileSystemOptions::Overlay is not.
+  ///
+  /// \returns true if \p Path does not exist, or is not a file (if \p isFile)
+  /// or not a directory (otherwise).
+  bool getNoncachedStatValue(StringRef Path, FileData &Result, bool isFile);
 
   /// \brief Remove the real file \p Entry from the cache.
   void invalidateCache(const FileEntry *Entry);
 
+  /// \brief Check whether the file system has changed in a way that could
+  /// affect the lookups cached so far.
+  ///
+  /// Every real file and directory seen is re-stat'ed and compared against
+  /// the cached size, modification time and unique ID; directories that did
+  /// not exist are checked for existence.  A change to a directory's
+  /// modification time also covers files created or removed in it, and thus
+  /// the cached failed lookups.  Virtual files cannot be validated, so their
+  /// presence is reported as a change.
+  ///
+  /// This is intended for clients that keep a FileManager alive across
+  /// several compilations and must drop it once it goes stale.  Such
+  /// clients should also use discardUnusedEntries(), so that the cost of
+  /// this check doesn't grow with every compilation.
+  bool hasFileSystemChanged();
+
+  /// \brief Start recording which cached files and directories are looked
+  /// up, for discardUnusedEntries().
+  void trackUsedEntries() { TrackUsedEntries = true; }
+
+  /// \brief Drop the cached lookups that weren't repeated since
+  /// trackUsedEntries() or the previous call, keeping what they depend on
+  /// (the directories of files, and of failed file lookups).
+  ///
+  /// Whatever is left is exactly what hasFileSystemChanged() checks, so a
+  /// client that calls this after each compilation only re-stats what the
+  /// last compilation used.
+  void discardUnusedEntries();
+
   /// \brief If path is not absolute and FileSystemOptions set the working
   /// directory, the path is modified to be relative to the given
   /// working directory.
@@ -0,0 +1,107 @@
+//===--- FileOverlay.h - Files layered over the file system -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the FileOverlay interface and the InMemoryFileOverlay.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FILEOVERLAY_H
+#define LLVM_CLANG_FILEOVERLAY_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <ctime>
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+namespace clang {
+
+struct FileData;
+
+/// \brief A set of files that the FileManager sees on top of the real file
+/// system.
+///
+/// A file in the overlay hides a file with the same path on disk.  A
+/// directory in the overlay is only used when no directory with that path
+/// exists on disk, so overlay files can be added to real directories.
+///
+/// Overlays are reference counted so that any number of FileManagers (and
+/// thus CompilerInstances) can share one, through
+/// FileSystemOptions::Overlay.
+class FileOverlay : public llvm::RefCountedBaseVPTR {
+  virtual void anchor();
+
+public:
+  virtual ~FileOverlay();
+
+  /// \brief Get the 'stat' information for \p Path.
+  ///
+  /// \returns true if \p Path is a file or directory in the overlay.
+  virtual bool getStat(StringRef Path, FileData &Data) const = 0;
+
+  /// \brief Get the contents of the overlay file at \p Path, or null if
+  /// there is no such file.
+  ///
+  /// The returned buffer is owned by the caller, but may refer to memory
+  /// owned by the overlay, which must outlive it.
+  virtual llvm::MemoryBuffer *getBuffer(StringRef Path) const = 0;
+};
+
+/// \brief An overlay holding files whose contents are in memory.
+///
+/// The contents are never copied: every FileManager reading a file gets a
+/// buffer that refers to the memory held here.  Files must not be added or
+/// replaced while a FileManager using the overlay is active.
+class InMemoryFileOverlay : public FileOverlay {
+  struct OverlayFile {
+    llvm::MemoryBuffer *Buffer;
+    time_t ModTime;
+  };
+
+  /// \brief The overlay below this one, if any.
+  IntrusiveRefCntPtr<FileOverlay> Parent;
+
+  llvm::StringMap<OverlayFile> Files;
+
+  /// \brief The directories containing the files, mapped to the latest
+  /// modification time of a file added in them.
+  llvm::StringMap<time_t> Directories;
+
+  InMemoryFileOverlay(const InMemoryFileOverlay &) LLVM_DELETED_FUNCTION;
+  void operator=(const InMemoryFileOverlay &) LLVM_DELETED_FUNCTION;
+
+public:
+  /// \brief Create an empty overlay on top of \p Parent, whose files are
+  /// visible unless hidden by files with the same path in this overlay.
+  explicit InMemoryFileOverlay(FileOverlay *Parent = 0);
+  ~InMemoryFileOverlay();
+
+  /// \brief Add the file \p Path with the contents of \p Buffer, replacing
+  /// any file already in this overlay at that path.
+  ///
+  /// Takes ownership of \p Buffer, which must be null terminated.  \p Path
+  /// must be spelled the way the file will be looked up, which usually means
+  /// it should be absolute.
+  void addFile(StringRef Path, llvm::MemoryBuffer *Buffer, time_t ModTime = 0);
+
+  /// \brief Retrieve the number of files in this overlay.
+  unsigned size() const { return Files.size(); }
+
+  virtual bool getStat(StringRef Path, FileData &Data) const;
+  virtual llvm::MemoryBuffer *getBuffer(StringRef Path) const;
+};
+
+} // end namespace clang
+
+#endif
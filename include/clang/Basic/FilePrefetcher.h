@@ -0,0 +1,99 @@
+//===--- FilePrefetcher.h - Background reading of files ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the FilePrefetcher interface.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FILEPREFETCHER_H
+#define LLVM_CLANG_FILEPREFETCHER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compiler.h"
+#include <ctime>
+#include <string>
+#include <sys/types.h>
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+namespace clang {
+
+struct FileData;
+class FileSystemStatCache;
+
+/// \brief Stats and reads files on background threads, ahead of the
+/// FileManager asking for them.
+///
+/// A request is the ordered list of paths at which one file may be found, as
+/// a header search would try them.  A worker thread stats the candidates in
+/// turn and reads the first regular file it finds into memory.  The
+/// FileManager then takes the stat results and file contents from here
+/// instead of going to the file system, which hides the latency of slow
+/// (e.g. network) file systems behind the lexing of the including file.
+///
+/// All of the public methods are meant to be called from the thread that owns
+/// the FileManager.  When a path is asked for before a worker got to it, the
+/// caller takes the request off the queue and works through it itself; when
+/// a worker is in the middle of it, the caller waits for the result.  Paths
+/// that no request covers are left to the caller.
+class FilePrefetcher {
+  class Implementation;
+  Implementation &Impl;
+
+  FilePrefetcher(const FilePrefetcher &) LLVM_DELETED_FUNCTION;
+  void operator=(const FilePrefetcher &) LLVM_DELETED_FUNCTION;
+
+public:
+  /// \brief Start \p NumThreads worker threads.
+  explicit FilePrefetcher(unsigned NumThreads);
+
+  /// \brief Stop the worker threads, dropping any outstanding requests.
+  ~FilePrefetcher();
+
+  /// \brief Whether this build of clang can read files in the background.
+  static bool isSupported();
+
+  /// \brief Queue a request to stat \p Candidates in order and read the
+  /// first one that is a regular file.
+  void prefetch(ArrayRef<std::string> Candidates);
+
+  enum StatResult {
+    StatUnknown, ///< No prefetched information; go to the file system.
+    StatMissing, ///< There is no file at the path.
+    StatExists   ///< There is a file at the path; its data was filled in.
+  };
+
+  /// \brief Retrieve the prefetched 'stat' information for the file at
+  /// \p Path.
+  ///
+  /// Each result is handed out once; later queries for the same path go to
+  /// the file system, which keeps a long-lived FileManager from seeing stale
+  /// data.
+  StatResult getStat(StringRef Path, FileData &Data);
+
+  /// \brief Create a stat cache that answers from the prefetched results and
+  /// passes everything else on to the next cache in the chain.
+  FileSystemStatCache *createStatCache();
+
+  /// \brief Take ownership of the prefetched contents of the file at
+  /// \p Path, if they were read and the file's size and modification time
+  /// still match \p Size and \p ModTime.
+  llvm::MemoryBuffer *takeBuffer(StringRef Path, off_t Size, time_t ModTime);
+
+  void PrintStats() const;
+};
+
+} // end namespace clang
+
+#endif
@@ -15,6 +15,8 @@
 #ifndef LLVM_CLANG_BASIC_FILESYSTEMOPTIONS_H
 #define LLVM_CLANG_BASIC_FILESYSTEMOPTIONS_H
 
+#include "clang/Basic/FileOverlay.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include <string>
 
 namespace clang {
@@ -25,6 +27,16 @@ public:
   /// \brief If set, paths are resolved as if the working directory was
   /// set to the value of WorkingDir.
   std::string WorkingDir;
+
+  /// \brief The number of threads used to read \#included files ahead of
+  /// time, or 0 to read every file when it is needed.
+  unsigned PrefetchThreads;
+
+  /// \brief Files that are seen on top of the real file system, shared by
+  /// every FileManager created with these options.
+  IntrusiveRefCntPtr<FileOverlay> Overlay;
+
+  FileSystemOptions() : PrefetchThreads(0) { }
 };
 
 } // end namespace clang
@@ -24,6 +24,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/PointerLikeTypeTraits.h"
 #include <cassert>
+#include <cstring>
 #include <string>
 
 namespace llvm {
@@ -424,6 +425,53 @@ class IdentifierTable {
 
   IdentifierInfoLookup* ExternalLookup;
 
+  /// \brief A slot of the lookup cache.
+  struct LookupCacheEntry {
+    unsigned Hash;
+    llvm::StringMapEntry<IdentifierInfo*> *Entry;
+  };
+
+  enum { LookupCacheSize = 4096 };
+
+  /// \brief A direct-mapped cache of the identifiers most recently looked up
+  /// by getWithHash(), indexed by the low bits of their hash.
+  ///
+  /// The lexer computes the hash while it scans an identifier, so a hit costs
+  /// a single comparison of the spelling, without rehashing the identifier
+  /// and probing the StringMap.
+  LookupCacheEntry LookupCache[LookupCacheSize];
+
+  // Statistics for -print-stats.
+  unsigned NumHashedLookups, NumLookupCacheHits, NumLookupCacheCollisions;
+
+  /// \brief Return the identifier for \p Entry, creating it (or retrieving
+  /// it from the external lookup) if \p Entry is new.
+  IdentifierInfo &getFromEntry(llvm::StringMapEntry<IdentifierInfo*> &Entry) {
+    IdentifierInfo *II = Entry.getValue();
+    if (II) return *II;
+
+    // No entry; if we have an external lookup, look there first.
+    if (ExternalLookup) {
+      II = ExternalLookup->get(Entry.getKey());
+      if (II) {
+        // Cache in the StringMap for subsequent lookups.
+        Entry.setValue(II);
+        return *II;
+      }
+    }
+
+    // Lookups failed, make a new IdentifierInfo.
+    void *Mem = getAllocator().Allocate<IdentifierInfo>();
+    II = new (Mem) IdentifierInfo();
+    Entry.setValue(II);
+
+    // Make sure getName() knows how to find the IdentifierInfo
+    // contents.
+    II->Entry = &Entry;
+
+    return *II;
+  }
+
 public:
   /// \brief Create the identifier table, populating it with info about the
   /// language keywords for the language specified by \p LangOpts.
@@ -447,32 +495,54 @@ public:
   /// \brief Return the identifier token info for the specified named
   /// identifier.
   IdentifierInfo &get(StringRef Name) {
-    llvm::StringMapEntry<IdentifierInfo*> &Entry =
-      HashTable.GetOrCreateValue(Name);
+    return getFromEntry(HashTable.GetOrCreateValue(Name));
+  }
 
-    IdentifierInfo *II = Entry.getValue();
-    if (II) return *II;
+  /// \brief The hash of the empty string, from which hashIdentifier() and
+  /// extendHash() start.
+  static const unsigned EmptyHash = 2166136261U;
 
-    // No entry; if we have an external lookup, look there first.
-    if (ExternalLookup) {
-      II = ExternalLookup->get(Name);
-      if (II) {
-        // Cache in the StringMap for subsequent lookups.
-        Entry.setValue(II);
-        return *II;
-      }
-    }
+  /// \brief Extend the hash \p Hash of an identifier by the character \p C.
+  ///
+  /// This is FNV-1a, which takes one xor and one multiply per character, so
+  /// the lexer can afford to compute it while it scans the identifier.
+  static unsigned extendHash(unsigned Hash, unsigned char C) {
+    return (Hash ^ C) * 16777619U;
+  }
 
-    // Lookups failed, make a new IdentifierInfo.
-    void *Mem = getAllocator().Allocate<IdentifierInfo>();
-    II = new (Mem) IdentifierInfo();
-    Entry.setValue(II);
+  /// \brief Compute the hash of \p Name that getWithHash() expects.
+  static unsigned hashIdentifier(StringRef Name) {
+    unsigned Hash = EmptyHash;
+    for (StringRef::iterator I = Name.begin(), E = Name.end(); I != E; ++I)
+      Hash = extendHash(Hash, *I);
+    return Hash;
+  }
 
-    // Make sure getName() knows how to find the IdentifierInfo
-    // contents.
-    II->Entry = &Entry;
+  /// \brief Return the identifier token info for \p Name, whose hash (as
+  /// computed by hashIdentifier()) is \p Hash.
+  ///
+  /// This is the same as get(Name), but answers repeated lookups of the same
+  /// identifier from a small cache, which is much faster for the lexer.
+  IdentifierInfo &getWithHash(StringRef Name, unsigned Hash) {
+    assert(Hash == hashIdentifier(Name) && "Wrong hash for identifier");
+    ++NumHashedLookups;
+
+    LookupCacheEntry &Cached = LookupCache[Hash & (LookupCacheSize - 1)];
+    if (Cached.Entry) {
+      if (Cached.Hash == Hash && Cached.Entry->getKeyLength() == Name.size() &&
+          memcmp(Cached.Entry->getKeyData(), Name.data(), Name.size()) == 0) {
+        ++NumLookupCacheHits;
+        return *Cached.Entry->getValue();
+      }
+      ++NumLookupCacheCollisions;
+    }
 
-    return *II;
+    llvm::StringMapEntry<IdentifierInfo*> &Entry =
+      HashTable.GetOrCreateValue(Name);
+    IdentifierInfo &II = getFromEntry(Entry);
+    Cached.Hash = Hash;
+    Cached.Entry = &Entry;
+    return II;
   }
 
   IdentifierInfo &get(StringRef Name, tok::TokenKind TokenCode) {
@@ -42,6 +42,9 @@ public:
 
   /// \brief The file to write GraphViz-formatted header dependencies to.
   std::string DOTOutputFile;
+
+  /// \brief The file to write the per-header cost report to.
+  std::string HeaderCostReportFile;
   
 public:
   DependencyOutputOptions() {
@@ -19,6 +19,11 @@
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallString.h"
+
+namespace llvm {
+class raw_svector_ostream;
+}
 
 namespace clang {
 class DiagnosticOptions;
@@ -37,6 +42,27 @@ class TextDiagnosticPrinter : public DiagnosticConsumer {
 
   unsigned OwnsOutputStream : 1;
 
+  /// \brief Diagnostics rendered but not yet written to \c OS, when
+  /// diagnostics are written in bulk.
+  SmallString<4096> Buffer;
+
+  /// \brief The stream writing into \c Buffer, or null if each diagnostic
+  /// is written to \c OS as soon as it is rendered.
+  OwningPtr<llvm::raw_svector_ostream> BufferOS;
+
+  /// \brief Retrieve the stream diagnostics are rendered into.
+  raw_ostream &getOutput();
+
+  /// \brief Write the buffered diagnostics out to \c OS.
+  void flushBuffer();
+
+  /// \brief Write out the diagnostic just rendered, unless it can wait for
+  /// the rest of the buffer.
+  void flushDiagnostic(DiagnosticsEngine::Level Level);
+
+  /// \brief Write out the buffers of all printers, when the process crashes.
+  static void flushBuffersOnCrash(void *);
+
 public:
   TextDiagnosticPrinter(raw_ostream &os, DiagnosticOptions *diags,
                         bool OwnsOutputStream = false);
@@ -49,6 +75,7 @@ public:
 
   void BeginSourceFile(const LangOptions &LO, const Preprocessor *PP);
   void EndSourceFile();
+  void finish();
   void HandleDiagnostic(DiagnosticsEngine::Level Level, const Diagnostic &Info);
 };
 
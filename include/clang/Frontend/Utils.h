@@ -82,6 +82,11 @@ void AttachDependencyFileGen(Preprocessor &PP,
   void AttachDependencyGraphGen(Preprocessor &PP, StringRef OutputFile,
                                 StringRef SysRoot);
 
+/// AttachHeaderCostReport - Create a generator for a report of the tokens,
+/// macros and time attributable to each file of the translation unit, written
+/// to \p OutputFile at the end of the main file.
+void AttachHeaderCostReport(Preprocessor &PP, StringRef OutputFile);
+
 /// AttachHeaderIncludeGen - Create a header include list generator, and attach
 /// it to the given preprocessor.
 ///
@@ -101,6 +106,10 @@ void AttachHeaderIncludeGen(Preprocessor &PP, bool ShowAllHeaders = false,
 /// a seekable stream.
 void CacheTokens(Preprocessor &PP, llvm::raw_fd_ostream* OS);
 
+/// CacheHeaderTokens - Write the entries of the preprocessor's header token
+/// cache that were missing when their headers were entered.
+void CacheHeaderTokens(Preprocessor &PP);
+
 /// createInvocationFromCommandLine - Construct a compiler invocation object for
 /// a command line argument vector.
 ///
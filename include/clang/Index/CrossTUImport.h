@@ -0,0 +1,112 @@
+//===--- CrossTUImport.h - Import definitions from other TUs ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the CrossTUImporter, which imports function definitions
+//  from the serialized ASTs of other translation units on demand.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_INDEX_CROSSTUIMPORT_H
+#define LLVM_CLANG_INDEX_CROSSTUIMPORT_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace clang {
+class ASTContext;
+class ASTImporter;
+class ASTUnit;
+class DiagnosticsEngine;
+class FileManager;
+class FunctionDecl;
+
+namespace index {
+
+/// \brief Finds the definitions of functions declared, but not defined, in
+/// one translation unit and imports them from the AST files of the
+/// translation units that define them.
+///
+/// Definitions are located through an index that maps the USR of each
+/// function to the AST file holding its definition.  Nothing is loaded or
+/// imported until a definition is asked for: each AST file is loaded at most
+/// once, and each is imported through a single ASTImporter so that the
+/// types and declarations it shares with other definitions, and the
+/// structural equivalence checks that matched them, are reused.
+class CrossTUImporter {
+  struct ASTFileInfo;
+
+  /// \brief The context we import into.
+  ASTContext &ToContext;
+
+  /// \brief The file manager we import into.
+  FileManager &ToFileManager;
+
+  /// \brief The diagnostics engine that the diagnostics of the loaded AST
+  /// files are forwarded to.
+  DiagnosticsEngine &Diags;
+
+  /// \brief Mapping from the USR of a function to the AST file defining it.
+  llvm::StringMap<std::string> DefinitionFiles;
+
+  /// \brief The AST files we tried to load, or null for those that could not
+  /// be loaded.
+  llvm::StringMap<ASTFileInfo *> LoadedFiles;
+
+  /// \brief Mapping from the USR of a function to its imported definition,
+  /// or null if it could not be imported.
+  llvm::StringMap<const FunctionDecl *> ImportedDefinitions;
+
+  unsigned NumLookups;
+  unsigned NumCachedLookups;
+  unsigned NumImportedDefinitions;
+
+  /// \brief Load the AST file \p Path, if we have not yet tried to.
+  ASTFileInfo *getASTFile(StringRef Path);
+
+  /// \brief Find the definition with the given USR and import it.
+  const FunctionDecl *importDefinition(StringRef USR);
+
+  CrossTUImporter(const CrossTUImporter &) LLVM_DELETED_FUNCTION;
+  void operator=(const CrossTUImporter &) LLVM_DELETED_FUNCTION;
+
+public:
+  /// \brief Create an importer bringing definitions into \p ToContext.
+  CrossTUImporter(ASTContext &ToContext, FileManager &ToFileManager,
+                  DiagnosticsEngine &Diags);
+  ~CrossTUImporter();
+
+  /// \brief Read an index from \p IndexFile.
+  ///
+  /// Each line of the index holds the USR of a function, a space, and the
+  /// path of the AST file defining that function.  Relative paths are
+  /// relative to the directory containing the index.
+  ///
+  /// \returns false and sets \p ErrorMessage if the index could not be read.
+  bool loadIndex(StringRef IndexFile, std::string &ErrorMessage);
+
+  /// \brief Note that the function with the given USR is defined in the
+  /// AST file \p ASTFile.
+  void addDefinitionFile(StringRef USR, StringRef ASTFile);
+
+  /// \brief Retrieve the definition of \p FD.
+  ///
+  /// \returns the definition of \p FD if this translation unit has one,
+  /// otherwise its definition imported from the AST file the index names for
+  /// it, or null if there is no such definition or it could not be imported.
+  const FunctionDecl *getCrossTUDefinition(const FunctionDecl *FD);
+
+  void PrintStats() const;
+};
+
+} // end namespace index
+} // end namespace clang
+
+#endif
@@ -73,6 +73,10 @@ struct HeaderFileInfo {
   /// provided via a header map. This bit indicates when this is one of
   /// those framework headers.
   unsigned IndexHeaderMapHeader : 1;
+
+  /// \brief If the last lexing of this file found no controlling macro, why
+  /// not.  This is an instance of MultipleIncludeOpt::GuardFailureKind.
+  unsigned GuardFailure : 3;
   
   /// \brief The number of times the file has been included already.
   unsigned short NumIncludes;
@@ -102,7 +106,7 @@ struct HeaderFileInfo {
     : isImport(false), isPragmaOnce(false), DirInfo(SrcMgr::C_User), 
       External(false), isModuleHeader(false), isCompilingModuleHeader(false),
       HeaderRole(ModuleMap::NormalHeader),
-      Resolved(false), IndexHeaderMapHeader(false),
+      Resolved(false), IndexHeaderMapHeader(false), GuardFailure(0),
       NumIncludes(0), ControllingMacroID(0), ControllingMacro(0)  {}
 
   /// \brief Retrieve the controlling macro for this header file, if
@@ -216,6 +220,36 @@ class HeaderSearch {
   
   /// \brief Describes whether a given directory has a module map in it.
   llvm::DenseMap<const DirectoryEntry *, bool> DirectoryHasModuleMap;
+
+  /// \brief A module map file recorded in the module map index.
+  struct IndexedModuleMap {
+    std::string FileName;
+    time_t ModTime;
+    off_t Size;
+    bool IsSystem;
+  };
+
+  /// \brief Whether the module map index has been read from the module cache.
+  bool ModuleMapIndexLoaded;
+
+  /// \brief Whether the module map index needs to be written back.
+  bool ModuleMapIndexOutOfDate;
+
+  /// \brief Maps top-level module names to the module map file that defined
+  /// them in an earlier compilation.
+  llvm::StringMap<IndexedModuleMap> IndexedModules;
+
+  /// \brief The modification time and size of each module map file recorded
+  /// in the module map index.
+  llvm::StringMap<std::pair<time_t, off_t> > IndexedModuleMapFiles;
+
+  /// \brief Directories that had no module map in an earlier compilation,
+  /// along with their modification times at that point.
+  llvm::StringMap<time_t> IndexedDirsWithoutModuleMap;
+
+  /// \brief The module map files parsed from header search directories, and
+  /// whether they were parsed as system module maps.
+  llvm::DenseMap<const FileEntry *, bool> LoadedModuleMaps;
   
   /// \brief Uniqued set of framework names, which is used to track which 
   /// headers were included as framework headers.
@@ -232,6 +266,7 @@ class HeaderSearch {
   unsigned NumIncluded;
   unsigned NumMultiIncludeFileOptzn;
   unsigned NumFrameworkLookups, NumSubFrameworkLookups;
+  unsigned NumModuleMapIndexHits;
 
   bool EnabledModules;
 
@@ -380,6 +415,14 @@ public:
                               ModuleMap::KnownHeader *SuggestedModule,
                               bool SkipCache = false);
 
+  /// \brief Ask the file manager's prefetcher to start reading the files
+  /// that \p File, whose contents are \p Buffer, \#includes.
+  ///
+  /// This is a quick textual scan: \#include directives in skipped
+  /// conditional blocks are prefetched too, while those whose file name comes
+  /// from a macro and files found in frameworks or header maps are not.
+  void prefetchIncludes(const FileEntry *File, StringRef Buffer);
+
   /// \brief Look up a subframework for the specified \#include file.
   ///
   /// For example, if \#include'ing <HIToolbox/HIToolbox.h> from
@@ -447,6 +490,12 @@ public:
     getFileInfo(File).ControllingMacro = ControllingMacro;
   }
 
+  /// \brief Record why the file, which has just been lexed, was not found to
+  /// have a controlling macro.  Only used for statistics.
+  void SetFileGuardFailure(const FileEntry *File, unsigned Reason) {
+    getFileInfo(File).GuardFailure = Reason;
+  }
+
   /// \brief Return true if this is the first time encountering this header.
   bool FirstTimeLexingFile(const FileEntry *File) {
     return getFileInfo(File).NumIncludes == 1;
@@ -532,7 +581,47 @@ public:
   /// \brief Load all known, top-level system modules.
   void loadTopLevelSystemModules();
 
+  /// \brief Record the module maps and module-map-less directories seen by
+  /// this compilation in the module map index, if it is enabled and anything
+  /// changed.
+  void writeModuleMapIndex();
+
 private:
+  /// \brief Return the path of the module map index in the module cache.
+  std::string getModuleMapIndexPath() const;
+
+  /// \brief Return the first line of a module map index that is valid for
+  /// the current compiler and search path.
+  std::string getModuleMapIndexSignature() const;
+
+  /// \brief Find the first search directory from which header search would
+  /// load the module maps in \p Dir, which is \p Dir itself or its parent.
+  bool findSearchDirectory(const DirectoryEntry *Dir, unsigned &Idx);
+
+  /// \brief Determine whether header search, looking for \p ModuleName,
+  /// would find nothing new in the search directories up to \p Idx before
+  /// reaching the module map in \p MapDir.
+  bool isSearchUnchangedBefore(StringRef ModuleName, unsigned Idx,
+                               const DirectoryEntry *MapDir);
+
+  /// \brief Determine whether loading the module maps in \p Dir could only
+  /// define modules that the module map index already knows about.
+  bool hasNoNewModuleMaps(const DirectoryEntry *Dir);
+
+  /// \brief Read the module map index, if enabled and not yet read.
+  void loadModuleMapIndex();
+
+  /// \brief Look for a module by loading the module map that defined it
+  /// according to the module map index.
+  Module *lookupModuleInIndex(StringRef ModuleName);
+
+  /// \brief Determine whether the module map index says that \p Dir has no
+  /// module map, and it hasn't changed since.
+  bool isKnownToHaveNoModuleMap(const DirectoryEntry *Dir);
+
+  /// \brief Note that \p Dir has no module map.
+  void noteDirectoryWithoutModuleMap(const DirectoryEntry *Dir);
+
   /// \brief Retrieve a module with the given name, which may be part of the
   /// given framework.
   ///
@@ -599,6 +688,12 @@ public:
                                               FileManager &FileMgr);
 
 private:
+  /// \brief Compute the paths that LookupFile() would try, in order, for an
+  /// \#include of \p Filename in \p Includer.
+  void getIncludeCandidates(StringRef Filename, bool isAngled,
+                            const FileEntry *Includer,
+                            SmallVectorImpl<std::string> &Candidates);
+
   /// \brief Describes what happened when we tried to load a module map file.
   enum LoadModuleMapResult {
     /// \brief The module map file had already been loaded.
@@ -98,6 +98,11 @@ public:
   /// \brief Interpret module maps.  This option is implied by full modules.
   unsigned ModuleMaps : 1;
 
+  /// \brief Remember in the module cache which module map defines each module
+  /// and which directories have no module map, so that later compilations
+  /// can skip the search.
+  unsigned ModuleMapIndex : 1;
+
   /// \brief The interval (in seconds) between pruning operations.
   ///
   /// This operation is expensive, because it requires Clang to walk through
@@ -141,6 +146,7 @@ public:
 public:
   HeaderSearchOptions(StringRef _Sysroot = "/")
     : Sysroot(_Sysroot), DisableModuleHash(0), ModuleMaps(0),
+      ModuleMapIndex(0),
       ModuleCachePruneInterval(7*24*60*60),
       ModuleCachePruneAfter(31*24*60*60),
       UseBuiltinIncludes(true),
@@ -0,0 +1,104 @@
+//===--- HeaderTokenCache.h - Per-header pretokenized cache -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the HeaderTokenCache interface.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_HEADERTOKENCACHE_H
+#define LLVM_CLANG_LEX_HEADERTOKENCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include <string>
+
+namespace clang {
+
+class FileEntry;
+class LangOptions;
+class PTHLexer;
+class PTHManager;
+class Preprocessor;
+
+/// \brief A directory of pretokenized headers, one PTH file per header.
+///
+/// Unlike a PTH file given with -include-pth, which caches the files seen by
+/// a single translation unit, each entry here caches the tokens of a single
+/// header and can be used by any translation unit that includes it.  Entries
+/// are keyed by the header's unique ID, modification time and size, and by
+/// the language options that influence lexing, so a changed header simply
+/// misses and gets a new entry.
+///
+/// The cache is consulted by Preprocessor::EnterSourceFile.  The headers that
+/// missed are remembered so that the entries can be written once the
+/// translation unit is done (see CacheHeaderTokens).
+class HeaderTokenCache {
+  /// \brief The directory holding the cache entries.
+  std::string Directory;
+
+  /// \brief Hash of everything besides the header itself that affects the
+  /// cached tokens.
+  size_t ConfigurationHash;
+
+  /// \brief The managers of the headers seen so far; null when the header
+  /// has no usable entry.
+  llvm::DenseMap<const FileEntry *, PTHManager *> Managers;
+
+  /// \brief The headers entered without a cache entry.
+  SmallVector<FileID, 16> Misses;
+
+  /// \brief The headers among the misses whose lexing reported diagnostics,
+  /// which the cache entries have no record of.
+  llvm::SmallPtrSet<const FileEntry *, 4> Uncacheable;
+
+  unsigned NumHits, NumMisses;
+
+  HeaderTokenCache(const HeaderTokenCache &) LLVM_DELETED_FUNCTION;
+  void operator=(const HeaderTokenCache &) LLVM_DELETED_FUNCTION;
+
+public:
+  HeaderTokenCache(StringRef Directory, const LangOptions &LangOpts);
+  ~HeaderTokenCache();
+
+  /// \brief Return the directory holding the cache entries.
+  StringRef getDirectory() const { return Directory; }
+
+  /// \brief Return the name of the cache entry for \p File.
+  std::string getCacheFileName(const FileEntry *File) const;
+
+  /// \brief Return a lexer over the cached tokens of the file \p FID, or null
+  /// if there is no entry for it yet.
+  PTHLexer *CreateLexer(Preprocessor &PP, FileID FID);
+
+  /// \brief Return the files that were entered without a cache entry.
+  ArrayRef<FileID> getMisses() const { return Misses; }
+
+  /// \brief Note that the lexer reported the diagnostic \p DiagID at \p Loc.
+  ///
+  /// A header whose lexing reports a diagnostic that may be visible is not
+  /// cached, since lexing it from the cache would lose the diagnostic.
+  void noteLexerDiagnostic(Preprocessor &PP, SourceLocation Loc,
+                           unsigned DiagID);
+
+  /// \brief Return true if an entry can be written for \p File.
+  bool isCacheable(const FileEntry *File) const {
+    return !Uncacheable.count(File);
+  }
+
+  void PrintStats() const;
+};
+
+}  // end namespace clang
+
+#endif
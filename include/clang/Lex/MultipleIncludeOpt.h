@@ -27,6 +27,22 @@ class IdentifierInfo;
 /// events that occur when a file is lexed, and after the entire file is lexed,
 /// information about which macro (if any) controls the header is returned.
 class MultipleIncludeOpt {
+public:
+  /// \brief The reasons a file can fail to be recognized as having a
+  /// controlling macro.  These are reported by -print-stats for headers that
+  /// had to be re-lexed.
+  enum GuardFailureKind {
+    GF_None,                 ///< A controlling macro was found.
+    GF_NoGuard,              ///< No top-level conditional at all.
+    GF_TokensBeforeGuard,    ///< Tokens or directives before the conditional.
+    GF_UnrecognizedCondition,///< The top-level condition isn't !defined(X).
+    GF_MacroInCondition,     ///< A macro was expanded in the guard condition.
+    GF_TopLevelElse,         ///< The guard has a top-level \#else or \#elif.
+    GF_MultipleConditionals, ///< More than one top-level conditional.
+    GF_TokensAfterEndif      ///< Tokens or directives after the \#endif.
+  };
+
+private:
   /// ReadAnyTokens - This is set to false when a file is first opened and true
   /// any time a token is returned to the client or a (non-multiple-include)
   /// directive is parsed.  When the final \#endif is parsed this is reset back
@@ -39,13 +55,13 @@ class MultipleIncludeOpt {
   /// the detection of header guards in a file.
   bool ImmediatelyAfterTopLevelIfndef;
 
-  /// ReadAnyTokens - This is set to false when a file is first opened and true
-  /// any time a token is returned to the client or a (non-multiple-include)
-  /// directive is parsed.  When the final #endif is parsed this is reset back
-  /// to false, that way any tokens before the first #ifdef or after the last
-  /// #endif can be easily detected.
+  /// DidMacroExpansion - This is set to true once a macro has been expanded
+  /// with this lexer as the current buffer.
   bool DidMacroExpansion;
 
+  /// Failure - The first reason this file was rejected, if any.
+  GuardFailureKind Failure;
+
   /// TheMacro - The controlling macro for a file, if valid.
   ///
   const IdentifierInfo *TheMacro;
@@ -60,6 +76,7 @@ public:
     ReadAnyTokens = false;
     ImmediatelyAfterTopLevelIfndef = false;
     DidMacroExpansion = false;
+    Failure = GF_None;
     TheMacro = 0;
     DefinedMacro = 0;
   }
@@ -83,7 +100,11 @@ public:
 
   /// Invalidate - Permanently mark this file as not being suitable for the
   /// include-file optimization.
-  void Invalidate() {
+  void Invalidate(GuardFailureKind Reason) {
+    // Only the first reason is interesting; everything after it is fallout.
+    if (Failure == GF_None)
+      Failure = Reason;
+
     // If we have read tokens but have no controlling macro, the state-machine
     // below can never "accept".
     ReadAnyTokens = true;
@@ -113,6 +134,10 @@ public:
   /// buffer, this method is called to disable the MIOpt if needed.
   void ExpandedMacro() { DidMacroExpansion = true; }
 
+  /// getDidMacroExpansion - Return true if any macro has been expanded with
+  /// this lexer as the current buffer.
+  bool getDidMacroExpansion() const { return DidMacroExpansion; }
+
   /// \brief Called when entering a top-level \#ifndef directive (or the
   /// "\#if !defined" equivalent) without any preceding tokens.
   ///
@@ -120,17 +145,23 @@ public:
   /// ensures that this is only called if there are no tokens read before the
   /// \#ifndef.  The caller is required to do this, because reading the \#if
   /// line obviously reads in in tokens.
-  void EnterTopLevelIfndef(const IdentifierInfo *M, SourceLocation Loc) {
+  ///
+  /// If \p IgnoreExpansions is true, the caller has already checked that the
+  /// part of the condition that tests \p M involved no macro expansion, and
+  /// that the rest of the condition cannot make it true once \p M is defined
+  /// (as in "\#if !defined(X) && ...").
+  void EnterTopLevelIfndef(const IdentifierInfo *M, SourceLocation Loc,
+                           bool IgnoreExpansions = false) {
     // If the macro is already set, this is after the top-level #endif.
     if (TheMacro)
-      return Invalidate();
+      return Invalidate(GF_MultipleConditionals);
 
     // If we have already expanded a macro by the end of the #ifndef line, then
     // there is a macro expansion *in* the #ifndef line.  This means that the
     // condition could evaluate differently when subsequently #included.  Reject
     // this.
-    if (DidMacroExpansion)
-      return Invalidate();
+    if (DidMacroExpansion && !IgnoreExpansions)
+      return Invalidate(GF_MacroInCondition);
 
     // Remember that we're in the #if and that we have the macro.
     ReadAnyTokens = true;
@@ -140,10 +171,24 @@ public:
   }
 
   /// \brief Invoked when a top level conditional (except \#ifndef) is found.
-  void EnterTopLevelConditional() {
+  ///
+  /// \p ReadAnyTokensBefore is the value of 'ReadAnyTokens' before the
+  /// directive was lexed.
+  void EnterTopLevelConditional(bool ReadAnyTokensBefore) {
     // If a conditional directive (except #ifndef) is found at the top level,
     // there is a chunk of the file not guarded by the controlling macro.
-    Invalidate();
+    if (TheMacro)
+      Invalidate(ReadAnyTokensBefore ? GF_TokensAfterEndif
+                                     : GF_MultipleConditionals);
+    else if (ReadAnyTokensBefore)
+      Invalidate(GF_TokensBeforeGuard);
+    else
+      Invalidate(GF_UnrecognizedCondition);
+  }
+
+  /// \brief Invoked when a top level \#else or \#elif is found.
+  void EnterTopLevelElse() {
+    Invalidate(GF_TopLevelElse);
   }
 
   /// \brief Called when the lexer exits the top-level conditional.
@@ -151,7 +196,7 @@ public:
     // If we have a macro, that means the top of the file was ok.  Set our state
     // back to "not having read any tokens" so we can detect anything after the
     // #endif.
-    if (!TheMacro) return Invalidate();
+    if (!TheMacro) return Invalidate(GF_NoGuard);
 
     // At this point, we haven't "read any tokens" but we do have a controlling
     // macro.
@@ -169,6 +214,18 @@ public:
     return 0;
   }
 
+  /// \brief Once the entire file has been lexed, return the reason it has no
+  /// controlling macro, or GF_None if it has one.
+  GuardFailureKind GetGuardFailureAtEndOfFile() const {
+    if (Failure != GF_None)
+      return Failure;
+    if (!TheMacro)
+      return GF_NoGuard;
+    if (ReadAnyTokens)
+      return GF_TokensAfterEndif;
+    return GF_None;
+  }
+
   /// \brief If the ControllingMacro is followed by a macro definition, return
   /// the macro that was defined.
   const IdentifierInfo *GetDefinedMacro() const {
@@ -63,6 +63,15 @@ public:
                            SrcMgr::CharacteristicKind FileType) {
   }
 
+  /// \brief Callback invoked whenever the contents of a file are embedded
+  /// into the program by \c __builtin_embed.
+  ///
+  /// \param Loc The location of the \c __builtin_embed.
+  ///
+  /// \param File The embedded file.
+  virtual void FileEmbedded(SourceLocation Loc, const FileEntry &File) {
+  }
+
   /// \brief Callback invoked whenever an inclusion directive results in a
   /// file-not-found error.
   ///
@@ -320,6 +329,23 @@ public:
   }
 };
 
+/// \brief Notified around every token the preprocessor returns to its client.
+///
+/// Unlike PPCallbacks, which describe preprocessing events, this is meant for
+/// tools that measure where time goes: the time between LexBegin() and
+/// LexEnd() is spent in the preprocessor, the time between LexEnd() and the
+/// next LexBegin() in its client.
+class PPTokenObserver {
+public:
+  virtual ~PPTokenObserver();
+
+  /// \brief Called when the client asks for the next token.
+  virtual void LexBegin() = 0;
+
+  /// \brief Called with the token about to be returned to the client.
+  virtual void LexEnd(const Token &Tok) = 0;
+};
+
 /// \brief Simple wrapper class for chaining callbacks.
 class PPChainedCallbacks : public PPCallbacks {
   virtual void anchor();
@@ -347,6 +373,11 @@ public:
     Second->FileSkipped(ParentFile, FilenameTok, FileType);
   }
 
+  virtual void FileEmbedded(SourceLocation Loc, const FileEntry &File) {
+    First->FileEmbedded(Loc, File);
+    Second->FileEmbedded(Loc, File);
+  }
+
   virtual bool FileNotFound(StringRef FileName,
                             SmallVectorImpl<char> &RecoveryPath) {
     return First->FileNotFound(FileName, RecoveryPath) ||
@@ -74,6 +74,11 @@ class PTHManager : public IdentifierInfoLookup {
   ///  if the file (if any) that was to used to generate the PTH cache.
   const char* OriginalSourceFile;
 
+  /// ResolveInIdentifierTable - Whether identifiers are resolved against the
+  ///  preprocessor's IdentifierTable instead of being owned by this manager.
+  ///  This is the case for the per-header caches of HeaderTokenCache.
+  bool ResolveInIdentifierTable;
+
   /// This constructor is intended to only be called by the static 'Create'
   /// method.
   PTHManager(const llvm::MemoryBuffer* buf, void* fileLookup,
@@ -98,10 +103,17 @@ class PTHManager : public IdentifierInfoLookup {
   }
   IdentifierInfo* LazilyCreateIdentifierInfo(unsigned PersistentID);
 
+  /// Load - Map and validate a PTH file, reporting problems to \p Diags if
+  ///  it is non-null.
+  static PTHManager *Load(const std::string &file, DiagnosticsEngine *Diags);
+
 public:
   // The current PTH version.
   enum { Version = 10 };
 
+  /// The name under which a per-header token cache records its single file.
+  static const char HeaderCacheFileName[];
+
   ~PTHManager();
 
   /// getOriginalSourceFile - Return the full path to the original header
@@ -120,6 +132,14 @@ public:
   ///  is the name of the PTH file.  This method returns NULL upon failure.
   static PTHManager *Create(const std::string& file, DiagnosticsEngine &Diags);
 
+  /// CreateHeaderCache - Load the per-header token cache \p file, as written
+  ///  by CacheHeaderTokens, for use by \p PP.  Identifiers are resolved
+  ///  against the IdentifierTable of \p PP, so any number of these managers
+  ///  can be used side by side.  Returns NULL, without diagnosing, if the
+  ///  file is missing or malformed.
+  static PTHManager *CreateHeaderCache(const std::string &file,
+                                       Preprocessor &PP);
+
   void setPreprocessor(Preprocessor *pp) { PP = pp; }
 
   /// CreateLexer - Return a PTHLexer that "lexes" the cached tokens for the
@@ -127,6 +147,10 @@ public:
   ///  It is the responsibility of the caller to 'delete' the returned object.
   PTHLexer *CreateLexer(FileID FID);
 
+  /// CreateHeaderLexer - Return a PTHLexer for \p FID over the tokens of a
+  ///  per-header token cache, or NULL if this manager holds none.
+  PTHLexer *CreateHeaderLexer(FileID FID);
+
   /// createStatCache - Returns a FileSystemStatCache object for use with
   ///  FileManager objects.  These objects use the PTH data to speed up
   ///  calls to stat by memoizing their results from when the PTH file
@@ -19,6 +19,8 @@
 #include "clang/Lex/PPCallbacks.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/PointerUnion.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Compiler.h"
@@ -293,9 +295,37 @@ namespace clang {
     /// \brief Allocator used to store preprocessing objects.
     llvm::BumpPtrAllocator BumpAlloc;
 
+    /// \brief A local preprocessed entity.
+    ///
+    /// Macro expansions far outnumber every other kind of entity, so they are
+    /// stored as just the macro definition they expand (or the name of the
+    /// builtin macro), and only turned into MacroExpansion objects when a
+    /// client asks for them.  Everything else is a PreprocessedEntity.
+    typedef llvm::PointerUnion3<PreprocessedEntity *, MacroDefinition *,
+                                IdentifierInfo *> LocalEntity;
+
+    /// \brief The source ranges of the preprocessed entities in this record,
+    /// in order they were seen.
+    ///
+    /// These are kept apart from the entities themselves so that searching
+    /// by location only touches this array.
+    std::vector<SourceRange> LocalEntityRanges;
+
     /// \brief The set of preprocessed entities in this record, in order they
-    /// were seen.
-    std::vector<PreprocessedEntity *> PreprocessedEntities;
+    /// were seen, parallel to LocalEntityRanges.
+    std::vector<LocalEntity> PreprocessedEntities;
+
+    /// \brief Whether macro expansions and inclusion directives are only
+    /// recorded in the main file and in RecordedFiles.
+    bool RestrictToRecordedFiles;
+
+    /// \brief The files, besides the main file, in which macro expansions and
+    /// inclusion directives are recorded when RestrictToRecordedFiles is set.
+    llvm::SmallPtrSet<const FileEntry *, 4> RecordedFiles;
+
+    /// \brief The file last checked by isRecordedLocation(), and the answer.
+    FileID LastCheckedFile;
+    bool LastCheckedFileIsRecorded;
     
     /// \brief The set of preprocessed entities in this record that have been
     /// loaded from external sources.
@@ -361,6 +391,17 @@ namespace clang {
 
     /// \brief Register a new macro definition.
     void RegisterMacroDefinition(MacroInfo *Macro, MacroDefinition *Def);
+
+    /// \brief Add a local entity covering \p Range, keeping the entities
+    /// sorted by location.
+    PPEntityID addLocalEntity(LocalEntity Entity, SourceRange Range);
+
+    /// \brief Retrieve the local preprocessed entity at the given index,
+    /// creating its object if needed.
+    PreprocessedEntity *getLocalPreprocessedEntity(unsigned Index);
+
+    /// \brief Determine whether entities at \p Loc should be recorded.
+    bool isRecordedLocation(SourceLocation Loc);
     
   public:
     /// \brief Construct a new preprocessing record.
@@ -560,6 +601,13 @@ namespace clang {
     /// \c MacroInfo.
     MacroDefinition *findMacroDefinition(const MacroInfo *MI);
 
+    /// \brief Only record macro expansions and inclusion directives that
+    /// occur in the main file or in one of \p Files.
+    ///
+    /// Macro definitions are still recorded everywhere, since the recorded
+    /// macro expansions refer to them.
+    void restrictToFiles(ArrayRef<const FileEntry *> Files);
+
     /// \brief Retrieve all ranges that got skipped while preprocessing.
     const std::vector<SourceRange> &getSkippedRanges() const {
       return SkippedRanges;
@@ -46,12 +46,14 @@ class ExternalPreprocessorSource;
 class FileManager;
 class FileEntry;
 class HeaderSearch;
+class HeaderTokenCache;
 class PragmaNamespace;
 class PragmaHandler;
 class CommentHandler;
 class ScratchBuffer;
 class TargetInfo;
 class PPCallbacks;
+class PPTokenObserver;
 class CodeCompletionHandler;
 class DirectoryLookup;
 class PreprocessingRecord;
@@ -104,6 +106,10 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   /// a token cache rather than lexing the original source file.
   OwningPtr<PTHManager> PTH;
 
+  /// \brief An optional cache of pretokenized system headers, used for the
+  /// headers entered with EnterSourceFile.
+  OwningPtr<HeaderTokenCache> HeaderTokCache;
+
   /// A BumpPtrAllocator object used to quickly allocate and release
   /// objects internal to the Preprocessor.
   llvm::BumpPtrAllocator BP;
@@ -313,6 +319,13 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   /// encountered (e.g. a file is \#included, etc).
   PPCallbacks *Callbacks;
 
+  /// \brief Notified around every token returned by Lex(), if set.
+  PPTokenObserver *TokenObserver;
+
+  /// \brief Whether the outermost Lex() call is being observed, so nested
+  /// calls are not reported.
+  bool InObservedLex;
+
   struct MacroExpandsInfo {
     Token Tok;
     MacroDirective *MD;
@@ -470,6 +483,11 @@ public:
 
   PTHManager *getPTHManager() { return PTH.get(); }
 
+  /// \brief Set the per-header token cache, taking ownership of it.
+  void setHeaderTokenCache(HeaderTokenCache *Cache);
+
+  HeaderTokenCache *getHeaderTokenCache() { return HeaderTokCache.get(); }
+
   void setExternalSource(ExternalPreprocessorSource *Source) {
     ExternalSource = Source;
   }
@@ -552,6 +570,13 @@ public:
   }
   /// \}
 
+  /// \brief Set the object notified around every token returned by Lex().
+  ///
+  /// The preprocessor does not take ownership of \p Observer.
+  void setTokenObserver(PPTokenObserver *Observer) {
+    TokenObserver = Observer;
+  }
+
   /// \brief Given an identifier, return its latest MacroDirective if it is
   /// \#defined or null if it isn't \#define'd.
   MacroDirective *getMacroDirective(IdentifierInfo *II) const {
@@ -1159,6 +1184,13 @@ public:
   /// updating the token kind accordingly.
   IdentifierInfo *LookUpIdentifierInfo(Token &Identifier) const;
 
+  /// \brief Like LookUpIdentifierInfo(Identifier), for a lexer that already
+  /// computed the hash of the identifier's spelling.
+  ///
+  /// \p Hash is only used if the token needs no cleaning, in which case it
+  /// must be IdentifierTable::hashIdentifier() of the raw spelling.
+  IdentifierInfo *LookUpIdentifierInfo(Token &Identifier, unsigned Hash) const;
+
 private:
   llvm::DenseMap<IdentifierInfo*,unsigned> PoisonReasons;
 
@@ -1386,7 +1418,10 @@ private:
   /// \#if or \#elif directive and return it as a bool.
   ///
   /// If the expression is equivalent to "!defined(X)" return X in IfNDefMacro.
-  bool EvaluateDirectiveExpression(IdentifierInfo *&IfNDefMacro);
+  /// If \p IfNDefConjunct is non-null, an expression of the form
+  /// "!defined(X) && ..." also returns X, and sets \p *IfNDefConjunct.
+  bool EvaluateDirectiveExpression(IdentifierInfo *&IfNDefMacro,
+                                   bool *IfNDefConjunct = 0);
 
   /// \brief Install the standard preprocessor pragmas:
   /// \#pragma GCC poison/system_header/dependency and \#pragma once.
@@ -1508,6 +1543,7 @@ private:
 
   // Macro handling.
   void HandleDefineDirective(Token &Tok, bool ImmediatelyAfterTopLevelIfndef);
+  bool HandlePredefinesDefineDirective();
   void HandleUndefDirective(Token &Tok);
 
   // Conditional Inclusion.
@@ -55,6 +55,16 @@ public:
   /// definitions and expansions.
   unsigned DetailedRecord : 1;
 
+  /// \brief Whether the detailed preprocessing record should only contain
+  /// macro expansions and inclusion directives from the main file and from
+  /// \c DetailedRecordFiles.
+  unsigned DetailedRecordMainFileOnly : 1;
+
+  /// \brief Headers whose macro expansions and inclusion directives are
+  /// recorded in addition to the main file's, when
+  /// \c DetailedRecordMainFileOnly is set.
+  std::vector<std::string> DetailedRecordFiles;
+
   /// The implicit PCH included at the start of the translation unit, or empty.
   std::string ImplicitPCHInclude;
 
@@ -89,6 +99,10 @@ public:
   /// If given, a PTH cache file to use for speeding up header parsing.
   std::string TokenCache;
 
+  /// If given, a directory of pretokenized system headers, which is read
+  /// and extended by every translation unit.
+  std::string HeaderTokenCache;
+
   /// \brief True if the SourceManager should report the original file name for
   /// contents of files that were remapped to other files. Defaults to true.
   bool RemappedFilesKeepOriginalName;
@@ -176,6 +190,7 @@ public:
   
 public:
   PreprocessorOptions() : UsePredefines(true), DetailedRecord(false),
+                          DetailedRecordMainFileOnly(false),
                           DisablePCHValidation(false),
                           AllowPCHWithCompilerErrors(false),
                           DumpDeserializedPCHDecls(false),
@@ -0,0 +1,45 @@
+//===--- LoopHint.h - Types for '#pragma clang loop' ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the LoopHint struct, which holds one option of a
+//  '#pragma clang loop' directive between the parser and Sema.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SEMA_LOOPHINT_H
+#define LLVM_CLANG_SEMA_LOOPHINT_H
+
+#include "clang/Basic/SourceLocation.h"
+
+namespace clang {
+
+class Expr;
+class IdentifierInfo;
+
+/// \brief Captures one option of a \#pragma clang loop directive, such as
+/// 'vectorize_width(4)'.
+struct LoopHint {
+  /// \brief The name of the option.
+  IdentifierInfo *Option;
+  SourceLocation OptionLoc;
+
+  /// \brief The identifier argument of the option, e.g. 'enable', if it
+  /// has one.
+  IdentifierInfo *State;
+
+  /// \brief The numeric argument of the option, if it has one.
+  Expr *ValueExpr;
+  SourceLocation ValueLoc;
+
+  LoopHint() : Option(0), State(0), ValueExpr(0) { }
+};
+
+} // end namespace clang
+
+#endif // LLVM_CLANG_SEMA_LOOPHINT_H
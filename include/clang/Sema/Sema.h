@@ -47,6 +47,7 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/MC/MCParser/MCAsmParser.h"
 #include <deque>
 #include <string>
@@ -121,6 +122,7 @@ namespace clang {
   class LambdaExpr;
   class LangOptions;
   class LocalInstantiationScope;
+  struct LoopHint;
   class LookupResult;
   class MacroInfo;
   class MultiLevelTemplateArgumentList;
@@ -181,6 +183,10 @@ namespace clang {
   struct DeductionFailureInfo;
   class TemplateSpecCandidateSet;
 
+namespace analyze_format_string {
+  class ParsedFormatString;
+}
+
 namespace sema {
   class AccessedEntity;
   class BlockScopeInfo;
@@ -2593,6 +2599,10 @@ public:
   StmtResult ProcessStmtAttributes(Stmt *Stmt, AttributeList *Attrs,
                                    SourceRange Range);
 
+  /// \brief Attach the options of the '#pragma clang loop' directives
+  /// preceding a loop to it.
+  StmtResult ActOnPragmaLoopHints(ArrayRef<LoopHint> Hints, Stmt *St);
+
   void WarnConflictingTypedMethods(ObjCMethodDecl *Method,
                                    ObjCMethodDecl *MethodDecl,
                                    bool IsProtocolMethodDecl);
@@ -3618,6 +3628,10 @@ public:
                                     SourceLocation BuiltinLoc,
                                     SourceLocation RParenLoc);
 
+  /// __builtin_embed("file")
+  ExprResult ActOnBuiltinEmbed(SourceLocation BuiltinLoc, Expr *Path,
+                               SourceLocation RParenLoc);
+
   //===---------------------------- OpenCL Features -----------------------===//
 
   /// __builtin_astype(...)
@@ -7878,6 +7892,12 @@ public:
                          llvm::SmallBitVector &CheckedVarArgs);
 
 private:
+  /// \brief Format strings that have already been parsed, keyed by their
+  /// kind and contents, so that a format string used at many call sites is
+  /// only parsed once.
+  llvm::StringMap<analyze_format_string::ParsedFormatString *>
+    ParsedFormatStrings;
+
   bool CheckFormatArguments(const FormatAttr *Format,
                             ArrayRef<const Expr *> Args,
                             bool IsCXXMember,
@@ -167,6 +167,16 @@ namespace clang {
 
     // Importing statements
     Stmt *VisitStmt(Stmt *S);
+    Stmt *VisitNullStmt(NullStmt *S);
+    Stmt *VisitCompoundStmt(CompoundStmt *S);
+    Stmt *VisitDeclStmt(DeclStmt *S);
+    Stmt *VisitIfStmt(IfStmt *S);
+    Stmt *VisitWhileStmt(WhileStmt *S);
+    Stmt *VisitDoStmt(DoStmt *S);
+    Stmt *VisitForStmt(ForStmt *S);
+    Stmt *VisitContinueStmt(ContinueStmt *S);
+    Stmt *VisitBreakStmt(BreakStmt *S);
+    Stmt *VisitReturnStmt(ReturnStmt *S);
 
     // Importing expressions
     Expr *VisitExpr(Expr *E);
@@ -180,6 +190,7 @@ namespace clang {
     Expr *VisitCompoundAssignOperator(CompoundAssignOperator *E);
     Expr *VisitImplicitCastExpr(ImplicitCastExpr *E);
     Expr *VisitCStyleCastExpr(CStyleCastExpr *E);
+    Expr *VisitCallExpr(CallExpr *E);
   };
 }
 using namespace clang;
@@ -205,6 +216,10 @@ namespace {
     /// \brief Declaration (from, to) pairs that are known not to be equivalent
     /// (which we have already complained about).
     llvm::DenseSet<std::pair<Decl *, Decl *> > &NonEquivalentDecls;
+
+    /// \brief Canonical declaration (from, to) pairs that earlier checks have
+    /// proven equivalent, or null if those results are not being cached.
+    llvm::DenseSet<std::pair<Decl *, Decl *> > *EquivalentDecls;
     
     /// \brief Whether we're being strict about the spelling of types when 
     /// unifying two types.
@@ -219,8 +234,10 @@ namespace {
     StructuralEquivalenceContext(ASTContext &C1, ASTContext &C2,
                llvm::DenseSet<std::pair<Decl *, Decl *> > &NonEquivalentDecls,
                                  bool StrictTypeSpelling = false,
-                                 bool Complain = true)
+                                 bool Complain = true,
+              llvm::DenseSet<std::pair<Decl *, Decl *> > *EquivalentDecls = 0)
       : C1(C1), C2(C2), NonEquivalentDecls(NonEquivalentDecls),
+        EquivalentDecls(EquivalentDecls),
         StrictTypeSpelling(StrictTypeSpelling), Complain(Complain),
         LastDiagFromC2(false) {}
 
@@ -1271,13 +1288,16 @@ static bool IsStructurallyEquivalent(StructuralEquivalenceContext &Context,
 /// \brief Determine structural equivalence of two declarations.
 static bool IsStructurallyEquivalent(StructuralEquivalenceContext &Context,
                                      Decl *D1, Decl *D2) {
-  // FIXME: Check for known structural equivalences via a callback of some sort.
-  
+  std::pair<Decl *, Decl *> P(D1->getCanonicalDecl(), D2->getCanonicalDecl());
+
   // Check whether we already know that these two declarations are not
   // structurally equivalent.
-  if (Context.NonEquivalentDecls.count(std::make_pair(D1->getCanonicalDecl(),
-                                                      D2->getCanonicalDecl())))
+  if (Context.NonEquivalentDecls.count(P))
     return false;
+
+  // Check whether an earlier check already proved them equivalent.
+  if (Context.EquivalentDecls && Context.EquivalentDecls->count(P))
+    return true;
   
   // Determine whether we've already produced a tentative equivalence for D1.
   Decl *&EquivToD1 = Context.TentativeEquivalences[D1->getCanonicalDecl()];
@@ -1306,6 +1326,13 @@ bool StructuralEquivalenceContext::IsStructurallyEquivalent(QualType T1,
   return !Finish();
 }
 
+/// \brief Determine whether \p D is a record or enum without a definition,
+/// which structural equivalence treats as matching anything of its name.
+static bool isIncompleteTag(Decl *D) {
+  TagDecl *Tag = dyn_cast<TagDecl>(D);
+  return Tag && !Tag->getDefinition();
+}
+
 bool StructuralEquivalenceContext::Finish() {
   while (!DeclsToCheck.empty()) {
     // Check the next declaration.
@@ -1413,6 +1440,24 @@ bool StructuralEquivalenceContext::Finish() {
     }
     // FIXME: Check other declaration kinds!
   }
+
+  // Every tentative equivalence has now been verified, so remember them for
+  // later checks.  Equivalence modulo type spelling says nothing about
+  // strict equivalence, so only the default mode is cached.  A record or enum
+  // without a definition is only assumed to match, and the pairs that relied
+  // on it may stop matching once it is defined, so then nothing is cached.
+  if (EquivalentDecls && !StrictTypeSpelling) {
+    bool Assumed = false;
+    for (llvm::DenseMap<Decl *, Decl *>::iterator
+           I = TentativeEquivalences.begin(), E = TentativeEquivalences.end();
+         I != E && !Assumed; ++I)
+      Assumed = isIncompleteTag(I->first) || isIncompleteTag(I->second);
+
+    for (llvm::DenseMap<Decl *, Decl *>::iterator
+           I = TentativeEquivalences.begin(), E = TentativeEquivalences.end();
+         I != E && !Assumed; ++I)
+      EquivalentDecls->insert(*I);
+  }
   
   return false;
 }
@@ -2187,7 +2232,8 @@ bool ASTNodeImporter::IsStructuralMatch(RecordDecl *FromRecord,
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    ToRecord->getASTContext(),
                                    Importer.getNonEquivalentDecls(),
-                                   false, Complain);
+                                   false, Complain,
+                                   &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(FromRecord, ToRecord);
 }
 
@@ -2195,14 +2241,17 @@ bool ASTNodeImporter::IsStructuralMatch(VarDecl *FromVar, VarDecl *ToVar,
                                         bool Complain) {
   StructuralEquivalenceContext Ctx(
       Importer.getFromContext(), Importer.getToContext(),
-      Importer.getNonEquivalentDecls(), false, Complain);
+      Importer.getNonEquivalentDecls(), false, Complain,
+      &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(FromVar, ToVar);
 }
 
 bool ASTNodeImporter::IsStructuralMatch(EnumDecl *FromEnum, EnumDecl *ToEnum) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   false, true,
+                                   &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(FromEnum, ToEnum);
 }
 
@@ -2221,7 +2270,9 @@ bool ASTNodeImporter::IsStructuralMatch(ClassTemplateDecl *From,
                                         ClassTemplateDecl *To) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   false, true,
+                                   &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(From, To);  
 }
 
@@ -2229,7 +2280,9 @@ bool ASTNodeImporter::IsStructuralMatch(VarTemplateDecl *From,
                                         VarTemplateDecl *To) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   false, true,
+                                   &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(From, To);
 }
 
@@ -4353,6 +4406,190 @@ Stmt *ASTNodeImporter::VisitStmt(Stmt *S) {
   return 0;
 }
 
+Stmt *ASTNodeImporter::VisitNullStmt(NullStmt *S) {
+  return new (Importer.getToContext())
+                                   NullStmt(Importer.Import(S->getSemiLoc()),
+                                            S->hasLeadingEmptyMacro());
+}
+
+Stmt *ASTNodeImporter::VisitCompoundStmt(CompoundStmt *S) {
+  SmallVector<Stmt *, 16> ToStmts;
+  for (CompoundStmt::body_iterator B = S->body_begin(), BEnd = S->body_end();
+       B != BEnd; ++B) {
+    Stmt *ToS = Importer.Import(*B);
+    if (!ToS)
+      return 0;
+
+    ToStmts.push_back(ToS);
+  }
+
+  return new (Importer.getToContext()) CompoundStmt(Importer.getToContext(),
+                                                    ToStmts,
+                                          Importer.Import(S->getLBracLoc()),
+                                          Importer.Import(S->getRBracLoc()));
+}
+
+Stmt *ASTNodeImporter::VisitDeclStmt(DeclStmt *S) {
+  SmallVector<Decl *, 4> ToDecls;
+  for (DeclStmt::decl_iterator D = S->decl_begin(), DEnd = S->decl_end();
+       D != DEnd; ++D) {
+    Decl *ToD = Importer.Import(*D);
+    if (!ToD)
+      return 0;
+
+    ToDecls.push_back(ToD);
+  }
+
+  DeclGroupRef ToDG;
+  if (ToDecls.size() == 1)
+    ToDG = DeclGroupRef(ToDecls[0]);
+  else
+    ToDG = DeclGroupRef::Create(Importer.getToContext(), ToDecls.data(),
+                                ToDecls.size());
+
+  return new (Importer.getToContext()) DeclStmt(ToDG,
+                                             Importer.Import(S->getStartLoc()),
+                                             Importer.Import(S->getEndLoc()));
+}
+
+Stmt *ASTNodeImporter::VisitIfStmt(IfStmt *S) {
+  VarDecl *ToCondVar = 0;
+  if (VarDecl *FromCondVar = S->getConditionVariable()) {
+    ToCondVar = cast_or_null<VarDecl>(Importer.Import(FromCondVar));
+    if (!ToCondVar)
+      return 0;
+  }
+
+  Expr *ToCond = Importer.Import(S->getCond());
+  if (!ToCond)
+    return 0;
+
+  Stmt *ToThen = Importer.Import(S->getThen());
+  if (!ToThen)
+    return 0;
+
+  Stmt *ToElse = 0;
+  if (S->getElse()) {
+    ToElse = Importer.Import(S->getElse());
+    if (!ToElse)
+      return 0;
+  }
+
+  return new (Importer.getToContext()) IfStmt(Importer.getToContext(),
+                                              Importer.Import(S->getIfLoc()),
+                                              ToCondVar, ToCond, ToThen,
+                                          Importer.Import(S->getElseLoc()),
+                                              ToElse);
+}
+
+Stmt *ASTNodeImporter::VisitWhileStmt(WhileStmt *S) {
+  VarDecl *ToCondVar = 0;
+  if (VarDecl *FromCondVar = S->getConditionVariable()) {
+    ToCondVar = cast_or_null<VarDecl>(Importer.Import(FromCondVar));
+    if (!ToCondVar)
+      return 0;
+  }
+
+  Expr *ToCond = Importer.Import(S->getCond());
+  if (!ToCond)
+    return 0;
+
+  Stmt *ToBody = Importer.Import(S->getBody());
+  if (!ToBody)
+    return 0;
+
+  return new (Importer.getToContext()) WhileStmt(Importer.getToContext(),
+                                                 ToCondVar, ToCond, ToBody,
+                                           Importer.Import(S->getWhileLoc()));
+}
+
+Stmt *ASTNodeImporter::VisitDoStmt(DoStmt *S) {
+  Stmt *ToBody = Importer.Import(S->getBody());
+  if (!ToBody)
+    return 0;
+
+  Expr *ToCond = Importer.Import(S->getCond());
+  if (!ToCond)
+    return 0;
+
+  return new (Importer.getToContext()) DoStmt(ToBody, ToCond,
+                                              Importer.Import(S->getDoLoc()),
+                                           Importer.Import(S->getWhileLoc()),
+                                          Importer.Import(S->getRParenLoc()));
+}
+
+Stmt *ASTNodeImporter::VisitForStmt(ForStmt *S) {
+  Stmt *ToInit = 0;
+  if (S->getInit()) {
+    ToInit = Importer.Import(S->getInit());
+    if (!ToInit)
+      return 0;
+  }
+
+  VarDecl *ToCondVar = 0;
+  if (VarDecl *FromCondVar = S->getConditionVariable()) {
+    ToCondVar = cast_or_null<VarDecl>(Importer.Import(FromCondVar));
+    if (!ToCondVar)
+      return 0;
+  }
+
+  Expr *ToCond = 0;
+  if (S->getCond()) {
+    ToCond = Importer.Import(S->getCond());
+    if (!ToCond)
+      return 0;
+  }
+
+  Expr *ToInc = 0;
+  if (S->getInc()) {
+    ToInc = Importer.Import(S->getInc());
+    if (!ToInc)
+      return 0;
+  }
+
+  Stmt *ToBody = Importer.Import(S->getBody());
+  if (!ToBody)
+    return 0;
+
+  return new (Importer.getToContext()) ForStmt(Importer.getToContext(),
+                                               ToInit, ToCond, ToCondVar,
+                                               ToInc, ToBody,
+                                           Importer.Import(S->getForLoc()),
+                                           Importer.Import(S->getLParenLoc()),
+                                          Importer.Import(S->getRParenLoc()));
+}
+
+Stmt *ASTNodeImporter::VisitContinueStmt(ContinueStmt *S) {
+  return new (Importer.getToContext()) 
+                          ContinueStmt(Importer.Import(S->getContinueLoc()));
+}
+
+Stmt *ASTNodeImporter::VisitBreakStmt(BreakStmt *S) {
+  return new (Importer.getToContext()) 
+                                BreakStmt(Importer.Import(S->getBreakLoc()));
+}
+
+Stmt *ASTNodeImporter::VisitReturnStmt(ReturnStmt *S) {
+  Expr *ToRetValue = 0;
+  if (S->getRetValue()) {
+    ToRetValue = Importer.Import(S->getRetValue());
+    if (!ToRetValue)
+      return 0;
+  }
+
+  const VarDecl *ToNRVOCandidate = 0;
+  if (const VarDecl *FromNRVOCandidate = S->getNRVOCandidate()) {
+    ToNRVOCandidate = cast_or_null<VarDecl>(
+                  Importer.Import(const_cast<VarDecl *>(FromNRVOCandidate)));
+    if (!ToNRVOCandidate)
+      return 0;
+  }
+
+  return new (Importer.getToContext()) 
+                            ReturnStmt(Importer.Import(S->getReturnLoc()),
+                                       ToRetValue, ToNRVOCandidate);
+}
+
 //----------------------------------------------------------------------------
 // Import Expressions
 //----------------------------------------------------------------------------
@@ -4561,6 +4798,35 @@ Expr *ASTNodeImporter::VisitCStyleCastExpr(CStyleCastExpr *E) {
                                 Importer.Import(E->getRParenLoc()));
 }
 
+Expr *ASTNodeImporter::VisitCallExpr(CallExpr *E) {
+  // The C++ call expressions carry more state than a plain call.
+  if (E->getStmtClass() != Stmt::CallExprClass)
+    return VisitExpr(E);
+
+  QualType T = Importer.Import(E->getType());
+  if (T.isNull())
+    return 0;
+
+  Expr *ToCallee = Importer.Import(E->getCallee());
+  if (!ToCallee)
+    return 0;
+
+  SmallVector<Expr *, 8> ToArgs;
+  for (CallExpr::arg_iterator A = E->arg_begin(), AEnd = E->arg_end();
+       A != AEnd; ++A) {
+    Expr *ToArg = Importer.Import(*A);
+    if (!ToArg)
+      return 0;
+
+    ToArgs.push_back(ToArg);
+  }
+
+  return new (Importer.getToContext()) CallExpr(Importer.getToContext(),
+                                                ToCallee, ToArgs, T,
+                                                E->getValueKind(),
+                                          Importer.Import(E->getRParenLoc()));
+}
+
 ASTImporter::ASTImporter(ASTContext &ToContext, FileManager &ToFileManager,
                          ASTContext &FromContext, FileManager &FromFileManager,
                          bool MinimalImport)
@@ -5117,6 +5383,6 @@ bool ASTImporter::IsStructurallyEquivalent(QualType From, QualType To,
     return true;
       
   StructuralEquivalenceContext Ctx(FromContext, ToContext, NonEquivalentDecls,
-                                   false, Complain);
+                                   false, Complain, &EquivalentDecls);
   return Ctx.IsStructurallyEquivalent(From, To);
 }
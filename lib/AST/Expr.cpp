@@ -953,6 +953,10 @@ getLocationOfByte(unsigned ByteNo, const SourceManager &SM,
   assert((Kind == StringLiteral::Ascii || Kind == StringLiteral::UTF8) &&
          "Only narrow string literals are currently supported");
 
+  // The bytes of an embedded file have no spelling to point into.
+  if (isEmbedded())
+    return getLocStart();
+
   // Loop over all of the tokens in this string until we find the one that
   // contains the byte we're looking for.
   unsigned TokNo = 0;
@@ -2621,6 +2625,41 @@ bool Expr::hasAnyTypeDependentArguments(ArrayRef<Expr *> Exprs) {
   return false;
 }
 
+bool Expr::getLiteralValue(APValue &Result, const ASTContext &Ctx) const {
+  const Expr *E = IgnoreParens();
+  bool Negate = false;
+  if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E)) {
+    if (UO->getOpcode() != UO_Minus)
+      return false;
+    E = UO->getSubExpr()->IgnoreParens();
+    Negate = true;
+  }
+
+  if (const FloatingLiteral *FL = dyn_cast<FloatingLiteral>(E)) {
+    llvm::APFloat Value = FL->getValue();
+    if (Negate)
+      Value.changeSign();
+    Result = APValue(Value);
+    return true;
+  }
+
+  llvm::APSInt Value;
+  if (const IntegerLiteral *IL = dyn_cast<IntegerLiteral>(E)) {
+    Value = llvm::APSInt(IL->getValue(),
+                         IL->getType()->isUnsignedIntegerType());
+  } else if (const CharacterLiteral *CL = dyn_cast<CharacterLiteral>(E)) {
+    Value = llvm::APSInt(Ctx.getIntWidth(CL->getType()),
+                         CL->getType()->isUnsignedIntegerType());
+    Value = CL->getValue();
+  } else {
+    return false;
+  }
+  if (Negate)
+    Value = -Value;
+  Result = APValue(Value);
+  return true;
+}
+
 bool Expr::isConstantInitializer(ASTContext &Ctx, bool IsForRef) const {
   // This function is attempting whether an expression is an initializer
   // which can be evaluated at compile-time. It very closely parallels
@@ -27,6 +27,7 @@
 #include "clang/Basic/ABI.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -109,11 +110,63 @@ class ItaniumMangleContextImpl : public ItaniumMangleContext {
   typedef std::pair<const DeclContext*, IdentifierInfo*> DiscriminatorKeyTy;
   llvm::DenseMap<DiscriminatorKeyTy, unsigned> Discriminator;
   llvm::DenseMap<const NamedDecl*, unsigned> Uniquifier;
-  
+
+public:
+  /// \brief The mangling of a <prefix> at the start of a name, and the
+  /// substitution candidates it introduced, in the order they were added.
+  struct CachedPrefix {
+    std::string Mangling;
+    SmallVector<uintptr_t, 4> Substitutions;
+  };
+
+private:
+  /// \brief The prefixes mangled so far, keyed by the context and whether
+  /// function contexts were skipped.
+  typedef std::pair<const DeclContext*, unsigned> PrefixKeyTy;
+  llvm::DenseMap<PrefixKeyTy, CachedPrefix *> PrefixCache;
+
+  // Statistics.
+  unsigned NumMangledNames;
+  uint64_t NumMangledBytes;
+  unsigned NumPrefixCacheHits;
+  uint64_t NumPrefixBytesReused;
+
 public:
   explicit ItaniumMangleContextImpl(ASTContext &Context,
                                     DiagnosticsEngine &Diags)
-      : ItaniumMangleContext(Context, Diags) {}
+      : ItaniumMangleContext(Context, Diags), NumMangledNames(0),
+        NumMangledBytes(0), NumPrefixCacheHits(0), NumPrefixBytesReused(0) {}
+
+  ~ItaniumMangleContextImpl() {
+    llvm::DeleteContainerSeconds(PrefixCache);
+  }
+
+  /// \brief Look up the cached mangling of the prefix \p DC.
+  const CachedPrefix *getCachedPrefix(const DeclContext *DC, bool NoFunction) {
+    llvm::DenseMap<PrefixKeyTy, CachedPrefix *>::const_iterator Pos
+      = PrefixCache.find(PrefixKeyTy(DC, NoFunction));
+    if (Pos == PrefixCache.end())
+      return 0;
+    ++NumPrefixCacheHits;
+    NumPrefixBytesReused += Pos->second->Mangling.size();
+    return Pos->second;
+  }
+
+  /// \brief Remember the mangling of the prefix \p DC, taking ownership
+  /// of \p Prefix.
+  void addCachedPrefix(const DeclContext *DC, bool NoFunction,
+                       CachedPrefix *Prefix) {
+    CachedPrefix *&Entry = PrefixCache[PrefixKeyTy(DC, NoFunction)];
+    assert(!Entry && "Prefix mangled twice");
+    Entry = Prefix;
+  }
+
+  void noteMangledName(uint64_t Bytes) {
+    ++NumMangledNames;
+    NumMangledBytes += Bytes;
+  }
+
+  virtual void PrintStats() const;
 
   uint64_t getAnonymousStructId(const TagDecl *TD) {
     std::pair<llvm::DenseMap<const TagDecl *,
@@ -205,6 +258,13 @@ class CXXNameMangler {
   /// SeqID - The next subsitution sequence number.
   unsigned SeqID;
 
+  /// IsPrefixMangler - Whether this mangler produces just a prefix of a
+  /// name, to be cached, rather than a whole name.
+  bool IsPrefixMangler;
+
+  /// StartPos - Where this mangler's output starts in Out.
+  uint64_t StartPos;
+
   class FunctionTypeDepthState {
     unsigned Bits;
 
@@ -248,11 +308,17 @@ class CXXNameMangler {
 
   ASTContext &getASTContext() const { return Context.getASTContext(); }
 
+  /// Create a mangler for the prefix of the name \p Outer is mangling.
+  CXXNameMangler(CXXNameMangler &Outer, raw_ostream &Out_)
+    : Context(Outer.Context), Out(Out_), Structor(Outer.Structor),
+      StructorType(Outer.StructorType), SeqID(0), IsPrefixMangler(true),
+      StartPos(0) { }
+
 public:
   CXXNameMangler(ItaniumMangleContextImpl &C, raw_ostream &Out_,
                  const NamedDecl *D = 0)
     : Context(C), Out(Out_), Structor(getStructor(D)), StructorType(0),
-      SeqID(0) {
+      SeqID(0), IsPrefixMangler(false), StartPos(Out_.tell()) {
     // These can't be mangled without a ctor type or dtor type.
     assert(!D || (!isa<CXXDestructorDecl>(D) &&
                   !isa<CXXConstructorDecl>(D)));
@@ -260,14 +326,19 @@ public:
   CXXNameMangler(ItaniumMangleContextImpl &C, raw_ostream &Out_,
                  const CXXConstructorDecl *D, CXXCtorType Type)
     : Context(C), Out(Out_), Structor(getStructor(D)), StructorType(Type),
-      SeqID(0) { }
+      SeqID(0), IsPrefixMangler(false), StartPos(Out_.tell()) { }
   CXXNameMangler(ItaniumMangleContextImpl &C, raw_ostream &Out_,
                  const CXXDestructorDecl *D, CXXDtorType Type)
     : Context(C), Out(Out_), Structor(getStructor(D)), StructorType(Type),
-      SeqID(0) { }
+      SeqID(0), IsPrefixMangler(false), StartPos(Out_.tell()) { }
 
-#if MANGLE_CHECKER
   ~CXXNameMangler() {
+    if (IsPrefixMangler)
+      return;
+
+    Context.noteMangledName(Out.tell() - StartPos);
+
+#if MANGLE_CHECKER
     if (Out.str()[0] == '\01')
       return;
 
@@ -275,8 +346,8 @@ public:
     char *result = abi::__cxa_demangle(Out.str().str().c_str(), 0, 0, &status);
     assert(status == 0 && "Could not demangle mangled name!");
     free(result);
-  }
 #endif
+  }
   raw_ostream &getStream() { return Out; }
 
   void mangle(const NamedDecl *D, StringRef Prefix = "_Z");
@@ -340,6 +411,8 @@ private:
                         unsigned NumTemplateArgs);
   void manglePrefix(NestedNameSpecifier *qualifier);
   void manglePrefix(const DeclContext *DC, bool NoFunction=false);
+  void mangleCachedPrefix(const DeclContext *DC, bool NoFunction);
+  void mangleUncachedPrefix(const DeclContext *DC, bool NoFunction);
   void manglePrefix(QualType type);
   void mangleTemplatePrefix(const TemplateDecl *ND, bool NoFunction=false);
   void mangleTemplatePrefix(TemplateName Template);
@@ -1486,7 +1559,51 @@ void CXXNameMangler::manglePrefix(const DeclContext *DC, bool NoFunction) {
 
   assert(!isLocalContainerContext(DC));
 
-  const NamedDecl *ND = cast<NamedDecl>(DC);  
+  // Until the first substitution candidate is seen, a prefix mangles the
+  // same way in every name it starts, which it does for every member of a
+  // class; the mangling of the same prefix elsewhere depends on what came
+  // before it.
+  if (Substitutions.empty() && FunctionTypeDepth.getDepth() == 0)
+    mangleCachedPrefix(DC, NoFunction);
+  else
+    mangleUncachedPrefix(DC, NoFunction);
+}
+
+/// \brief Mangle the prefix \p DC at the start of a name, reusing its
+/// mangling from an earlier name if there was one.
+void CXXNameMangler::mangleCachedPrefix(const DeclContext *DC,
+                                        bool NoFunction) {
+  assert(Substitutions.empty() && SeqID == 0 && "Not at the start of a name");
+
+  const ItaniumMangleContextImpl::CachedPrefix *Prefix =
+    Context.getCachedPrefix(DC, NoFunction);
+  if (!Prefix) {
+    ItaniumMangleContextImpl::CachedPrefix *NewPrefix =
+      new ItaniumMangleContextImpl::CachedPrefix;
+    {
+      llvm::raw_string_ostream PrefixOut(NewPrefix->Mangling);
+      CXXNameMangler PrefixMangler(*this, PrefixOut);
+      PrefixMangler.mangleUncachedPrefix(DC, NoFunction);
+
+      // Record the substitution candidates in order of their sequence IDs.
+      NewPrefix->Substitutions.resize(PrefixMangler.SeqID);
+      for (llvm::DenseMap<uintptr_t, unsigned>::iterator
+             I = PrefixMangler.Substitutions.begin(),
+             E = PrefixMangler.Substitutions.end(); I != E; ++I)
+        NewPrefix->Substitutions[I->second] = I->first;
+    }
+    Context.addCachedPrefix(DC, NoFunction, NewPrefix);
+    Prefix = NewPrefix;
+  }
+
+  Out << Prefix->Mangling;
+  for (unsigned I = 0, N = Prefix->Substitutions.size(); I != N; ++I)
+    addSubstitution(Prefix->Substitutions[I]);
+}
+
+void CXXNameMangler::mangleUncachedPrefix(const DeclContext *DC,
+                                          bool NoFunction) {
+  const NamedDecl *ND = cast<NamedDecl>(DC);
   if (mangleSubstitution(ND))
     return;
   
@@ -3788,6 +3905,19 @@ void ItaniumMangleContextImpl::mangleTypeName(QualType Ty, raw_ostream &Out) {
   mangleCXXRTTIName(Ty, Out);
 }
 
+void ItaniumMangleContextImpl::PrintStats() const {
+  llvm::errs() << "\n*** Itanium Name Mangling Stats:\n";
+  llvm::errs() << "  " << NumMangledNames << " names mangled, "
+               << NumMangledBytes << " bytes produced";
+  if (NumMangledNames)
+    llvm::errs() << " (" << NumMangledBytes / NumMangledNames
+                 << " bytes/name on average)";
+  llvm::errs() << "\n";
+  llvm::errs() << "  " << PrefixCache.size() << " prefixes cached, "
+               << NumPrefixCacheHits << " prefix cache hits, "
+               << NumPrefixBytesReused << " bytes reused\n";
+}
+
 ItaniumMangleContext *
 ItaniumMangleContext::create(ASTContext &Context, DiagnosticsEngine &Diags) {
   return new ItaniumMangleContextImpl(Context, Diags);
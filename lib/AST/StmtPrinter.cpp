@@ -172,19 +172,33 @@ void StmtPrinter::VisitLabelStmt(LabelStmt *Node) {
 }
 
 void StmtPrinter::VisitAttributedStmt(AttributedStmt *Node) {
-  OS << "[[";
-  bool first = true;
+  // Loop hints are written as pragmas on lines of their own.
+  SmallVector<const Attr*, 4> OtherAttrs;
   for (ArrayRef<const Attr*>::iterator it = Node->getAttrs().begin(),
                                        end = Node->getAttrs().end();
                                        it != end; ++it) {
-    if (!first) {
-      OS << ", ";
-      first = false;
+    if (const LoopHintAttr *LH = dyn_cast<LoopHintAttr>(*it)) {
+      Indent() << "#pragma clang loop ";
+      LH->printPragma(OS);
+      OS << "\n";
+    } else {
+      OtherAttrs.push_back(*it);
+    }
+  }
+
+  if (!OtherAttrs.empty()) {
+    OS << "[[";
+    bool first = true;
+    for (unsigned i = 0, e = OtherAttrs.size(); i != e; ++i) {
+      if (!first) {
+        OS << ", ";
+        first = false;
+      }
+      // TODO: check this
+      OtherAttrs[i]->printPretty(OS, Policy);
     }
-    // TODO: check this
-    (*it)->printPretty(OS, Policy);
+    OS << "]] ";
   }
-  OS << "]] ";
   PrintStmt(Node->getSubStmt(), 0);
 }
 
@@ -18,6 +18,7 @@
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/TimeValue.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstdio>
@@ -127,7 +128,8 @@ private:
 public:
   FinalOverriders(const CXXRecordDecl *MostDerivedClass,
                   CharUnits MostDerivedClassOffset,
-                  const CXXRecordDecl *LayoutClass);
+                  const CXXRecordDecl *LayoutClass,
+                  const CXXFinalOverriderMap &FinalOverriders);
 
   /// getOverrider - Get the final overrider for the given method declaration in
   /// the subobject with the given base offset. 
@@ -150,7 +152,8 @@ public:
 
 FinalOverriders::FinalOverriders(const CXXRecordDecl *MostDerivedClass,
                                  CharUnits MostDerivedClassOffset,
-                                 const CXXRecordDecl *LayoutClass)
+                                 const CXXRecordDecl *LayoutClass,
+                                 const CXXFinalOverriderMap &FinalOverriders)
   : MostDerivedClass(MostDerivedClass), 
   MostDerivedClassOffset(MostDerivedClassOffset), LayoutClass(LayoutClass),
   Context(MostDerivedClass->getASTContext()),
@@ -166,10 +169,7 @@ FinalOverriders::FinalOverriders(const CXXRecordDecl *MostDerivedClass,
                      SubobjectOffsets, SubobjectLayoutClassOffsets, 
                      SubobjectCounts);
 
-  // Get the final overriders.
-  CXXFinalOverriderMap FinalOverriders;
-  MostDerivedClass->getFinalOverriders(FinalOverriders);
-
+  // Map the final overriders to their subobjects.
   for (CXXFinalOverriderMap::const_iterator I = FinalOverriders.begin(),
        E = FinalOverriders.end(); I != E; ++I) {
     const CXXMethodDecl *MD = I->first;
@@ -998,7 +998,8 @@ public:
         MostDerivedClassOffset(MostDerivedClassOffset),
         MostDerivedClassIsVirtual(MostDerivedClassIsVirtual),
         LayoutClass(LayoutClass), Context(MostDerivedClass->getASTContext()),
-        Overriders(MostDerivedClass, MostDerivedClassOffset, LayoutClass) {
+        Overriders(MostDerivedClass, MostDerivedClassOffset, LayoutClass,
+                   VTables.getFinalOverriders(MostDerivedClass)) {
     assert(!Context.getTargetInfo().getCXXABI().isMicrosoft());
 
     LayoutVTable();
@@ -2292,6 +2293,43 @@ VTableLayout::VTableLayout(uint64_t NumVTableComponents,
 
 VTableLayout::~VTableLayout() { }
 
+VTableContextBase::~VTableContextBase() {
+  llvm::DeleteContainerSeconds(FinalOverriderMaps);
+}
+
+const CXXFinalOverriderMap &
+VTableContextBase::getFinalOverriders(const CXXRecordDecl *RD) {
+  CXXFinalOverriderMap *&Entry = FinalOverriderMaps[RD];
+  if (Entry) {
+    ++NumFinalOverriderMapHits;
+    return *Entry;
+  }
+
+  ++NumFinalOverriderMaps;
+  Entry = new CXXFinalOverriderMap;
+  RD->getFinalOverriders(*Entry);
+  return *Entry;
+}
+
+VTableContextBase::LayoutTimer::LayoutTimer(VTableContextBase &VTables)
+  : VTables(VTables), Start(llvm::sys::TimeValue::now().usec()) {
+  ++VTables.NumVTableLayouts;
+}
+
+VTableContextBase::LayoutTimer::~LayoutTimer() {
+  VTables.LayoutTime += llvm::sys::TimeValue::now().usec() - Start;
+}
+
+void VTableContextBase::PrintStats() const {
+  llvm::errs() << "\n*** VTable Layout Stats:\n";
+  llvm::errs() << "  " << NumVTableLayouts << " vtable layouts computed in "
+               << llvm::format("%.3f", LayoutTime / 1000.0) << " ms\n";
+  llvm::errs() << "  " << NumFinalOverriderMaps
+               << " final overrider maps computed, "
+               << NumFinalOverriderMapHits << " reused\n";
+  llvm::errs() << "  " << NumThunkQueries << " thunk queries\n";
+}
+
 ItaniumVTableContext::ItaniumVTableContext(ASTContext &Context)
     : VTableContextBase(/*MS=*/false) {}
 
@@ -2364,6 +2402,7 @@ ItaniumVTableContext::computeVTableRelatedInformation(const CXXRecordDecl *RD) {
   if (Entry)
     return;
 
+  LayoutTimer Timer(*this);
   ItaniumVTableBuilder Builder(*this, RD, CharUnits::Zero(),
                                /*MostDerivedClassIsVirtual=*/0, RD);
   Entry = CreateVTableLayout(Builder);
@@ -2400,6 +2439,7 @@ ItaniumVTableContext::computeVTableRelatedInformation(const CXXRecordDecl *RD) {
 VTableLayout *ItaniumVTableContext::createConstructionVTableLayout(
     const CXXRecordDecl *MostDerivedClass, CharUnits MostDerivedClassOffset,
     bool MostDerivedClassIsVirtual, const CXXRecordDecl *LayoutClass) {
+  LayoutTimer Timer(*this);
   ItaniumVTableBuilder Builder(*this, MostDerivedClass, MostDerivedClassOffset,
                                MostDerivedClassIsVirtual, LayoutClass);
   return CreateVTableLayout(Builder);
@@ -2602,7 +2642,8 @@ public:
         MostDerivedClass(MostDerivedClass),
         MostDerivedClassLayout(Context.getASTRecordLayout(MostDerivedClass)),
         WhichVFPtr(Which),
-        Overriders(MostDerivedClass, CharUnits(), MostDerivedClass) {
+        Overriders(MostDerivedClass, CharUnits(), MostDerivedClass,
+                   VTables.getFinalOverriders(MostDerivedClass)) {
     LayoutVFTable();
 
     if (Context.getLangOpts().DumpVTableLayouts)
@@ -3452,6 +3493,7 @@ void MicrosoftVTableContext::computeVTableRelatedInformation(
   if (VFPtrLocations.count(RD))
     return;
 
+  LayoutTimer Timer(*this);
   const VTableLayout::AddressPointsMapTy EmptyAddressPointsMap;
 
   VFPtrListTy &VFPtrs = VFPtrLocations[RD];
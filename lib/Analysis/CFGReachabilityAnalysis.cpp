@@ -16,16 +16,119 @@
 #include "llvm/ADT/SmallVector.h"
 #include "clang/Analysis/Analyses/CFGReachabilityAnalysis.h"
 #include "clang/Analysis/CFG.h"
+#include <algorithm>
 
 using namespace clang;
 
 CFGReverseBlockReachabilityAnalysis::CFGReverseBlockReachabilityAnalysis(const CFG &cfg)
-  : analyzed(cfg.getNumBlockIDs(), false) {}
+  : analyzed(cfg.getNumBlockIDs(), false) {
+  buildIndex(cfg);
+}
+
+// Builds the reachability labels with a single iterative run of Tarjan's
+// strongly connected components algorithm over the successor edges.
+void CFGReverseBlockReachabilityAnalysis::buildIndex(const CFG &cfg) {
+  const unsigned NumBlocks = cfg.getNumBlockIDs();
+  const unsigned Unvisited = ~0U;
+  SCCOf.resize(NumBlocks, 0);
+  TreeIn.resize(NumBlocks, Unvisited);
+  TreeOut.resize(NumBlocks, 0);
+
+  SmallVector<unsigned, 16> LowLink(NumBlocks, 0);
+  llvm::BitVector OnStack(NumBlocks);
+  SmallVector<const CFGBlock *, 16> SCCStack;
+  typedef std::pair<const CFGBlock *, CFGBlock::const_succ_iterator> Frame;
+  SmallVector<Frame, 16> CallStack;
+  unsigned NextNum = 0;
+
+  for (CFG::const_iterator I = cfg.begin(), E = cfg.end(); I != E; ++I) {
+    const CFGBlock *Start = *I;
+    if (TreeIn[Start->getBlockID()] != Unvisited)
+      continue;
+
+    TreeIn[Start->getBlockID()] = LowLink[Start->getBlockID()] = NextNum++;
+    SCCStack.push_back(Start);
+    OnStack.set(Start->getBlockID());
+    CallStack.push_back(Frame(Start, Start->succ_begin()));
+
+    while (!CallStack.empty()) {
+      const CFGBlock *B = CallStack.back().first;
+      const unsigned BID = B->getBlockID();
+      CFGBlock::const_succ_iterator &It = CallStack.back().second;
+
+      if (It != B->succ_end()) {
+        const CFGBlock *Succ = *It++;
+        // Skip edges that were pruned as trivially false.
+        if (!Succ)
+          continue;
+        const unsigned SuccID = Succ->getBlockID();
+        if (TreeIn[SuccID] == Unvisited) {
+          TreeIn[SuccID] = LowLink[SuccID] = NextNum++;
+          SCCStack.push_back(Succ);
+          OnStack.set(SuccID);
+          CallStack.push_back(Frame(Succ, Succ->succ_begin()));
+        } else if (OnStack.test(SuccID)) {
+          LowLink[BID] = std::min(LowLink[BID], TreeIn[SuccID]);
+        }
+        continue;
+      }
+
+      // All successors of B have been visited.
+      TreeOut[BID] = NextNum - 1;
+      CallStack.pop_back();
+      if (!CallStack.empty()) {
+        unsigned &ParentLow = LowLink[CallStack.back().first->getBlockID()];
+        ParentLow = std::min(ParentLow, LowLink[BID]);
+      }
+      if (LowLink[BID] != TreeIn[BID])
+        continue;
+
+      // B is the root of a component.  Every component reachable from it has
+      // already been numbered, so its reachable interval is final as well.
+      const unsigned SCC = SCCLow.size();
+      SCCLow.push_back(SCC);
+      unsigned RootPos = SCCStack.size();
+      do {
+        --RootPos;
+        OnStack.reset(SCCStack[RootPos]->getBlockID());
+        SCCOf[SCCStack[RootPos]->getBlockID()] = SCC;
+      } while (SCCStack[RootPos] != B);
+
+      unsigned &Low = SCCLow.back();
+      for (unsigned M = RootPos, ME = SCCStack.size(); M != ME; ++M) {
+        const CFGBlock *Member = SCCStack[M];
+        for (CFGBlock::const_succ_iterator SI = Member->succ_begin(),
+             SE = Member->succ_end(); SI != SE; ++SI)
+          if (*SI && SCCOf[(*SI)->getBlockID()] != SCC)
+            Low = std::min(Low, SCCLow[SCCOf[(*SI)->getBlockID()]]);
+      }
+      SCCStack.resize(RootPos);
+    }
+  }
+}
 
 bool CFGReverseBlockReachabilityAnalysis::isReachable(const CFGBlock *Src,
                                           const CFGBlock *Dst) {
 
   const unsigned DstBlockID = Dst->getBlockID();
+
+  // Try to answer the query from the index first.  A block is only reachable
+  // from itself through a cycle, which the labels don't distinguish, so
+  // leave that case to the search below.
+  if (Src != Dst) {
+    const unsigned SrcBlockID = Src->getBlockID();
+    const unsigned SrcSCC = SCCOf[SrcBlockID], DstSCC = SCCOf[DstBlockID];
+    if (SrcSCC == DstSCC)
+      return true;
+    // Every component reachable from Src has a smaller number than Src's and
+    // a reachable interval nested within Src's.
+    if (DstSCC > SrcSCC || SCCLow[DstSCC] < SCCLow[SrcSCC])
+      return false;
+    // Descendants in the spanning forest are reachable along tree edges.
+    if (TreeIn[SrcBlockID] < TreeIn[DstBlockID] &&
+        TreeIn[DstBlockID] <= TreeOut[SrcBlockID])
+      return true;
+  }
   
   // If we haven't analyzed the destination node, run the analysis now
   if (!analyzed[DstBlockID]) {
@@ -8,7 +8,198 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Analysis/Analyses/Dominators.h"
+#include "llvm/ADT/BitVector.h"
 
 using namespace clang;
 
 void DominatorTree::anchor() { }
+
+//===----------------------------------------------------------------------===//
+// CFGDomTree
+//===----------------------------------------------------------------------===//
+
+void CFGDomTree::anchor() { }
+
+namespace {
+/// Iterates the "forward" edges of a block for the kind of tree being built:
+/// successors for dominators and predecessors for post-dominators.  Pruned
+/// edges show up as null blocks and are handed out as-is.
+struct DomEdges {
+  CFGBlock::const_succ_iterator Begin, End;
+
+  DomEdges(const CFGBlock *B, bool IsPostDom)
+    : Begin(IsPostDom ? B->pred_begin() : B->succ_begin()),
+      End(IsPostDom ? B->pred_end() : B->succ_end()) {}
+};
+
+/// The reverse of DomEdges: predecessors for dominators and successors for
+/// post-dominators.
+struct ReverseDomEdges : DomEdges {
+  ReverseDomEdges(const CFGBlock *B, bool IsPostDom)
+    : DomEdges(B, !IsPostDom) {}
+};
+}
+
+CFGDomTree::CFGDomTree(const CFG &cfg, bool IsPostDom)
+  : IsPostDom(IsPostDom),
+    Root(IsPostDom ? &cfg.getExit() : &cfg.getEntry()) {
+  const unsigned NumBlocks = cfg.getNumBlockIDs();
+  Blocks.resize(NumBlocks, 0);
+  IDom.resize(NumBlocks, Unnumbered);
+  DFSIn.resize(NumBlocks, Unnumbered);
+  DFSOut.resize(NumBlocks, Unnumbered);
+
+  for (CFG::const_iterator I = cfg.begin(), E = cfg.end(); I != E; ++I)
+    Blocks[(*I)->getBlockID()] = *I;
+
+  // Compute a post-order of the blocks reachable from the root with an
+  // explicit stack.  PONumber doubles as the visited set.
+  SmallVector<unsigned, 16> PONumber(NumBlocks, Unnumbered);
+  SmallVector<const CFGBlock *, 16> PostOrder;
+  PostOrder.reserve(NumBlocks);
+  {
+    llvm::BitVector Visited(NumBlocks);
+    SmallVector<std::pair<const CFGBlock *, DomEdges>, 16> Stack;
+    Visited.set(Root->getBlockID());
+    Stack.push_back(std::make_pair(Root, DomEdges(Root, IsPostDom)));
+    while (!Stack.empty()) {
+      DomEdges &Edges = Stack.back().second;
+      if (Edges.Begin == Edges.End) {
+        const CFGBlock *B = Stack.pop_back_val().first;
+        PONumber[B->getBlockID()] = PostOrder.size();
+        PostOrder.push_back(B);
+        continue;
+      }
+      const CFGBlock *Next = *Edges.Begin++;
+      if (Next && !Visited.test(Next->getBlockID())) {
+        Visited.set(Next->getBlockID());
+        Stack.push_back(std::make_pair(Next, DomEdges(Next, IsPostDom)));
+      }
+    }
+  }
+
+  // Iterate to a fixed point over the blocks in reverse post-order.  The
+  // immediate dominators form a tree that is walked upwards in post-order
+  // numbers to find the nearest common dominator of two blocks.
+  const unsigned RootID = Root->getBlockID();
+  IDom[RootID] = RootID;
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (unsigned I = PostOrder.size() - 1; I-- > 0; ) {
+      const CFGBlock *B = PostOrder[I];
+      unsigned NewIDom = Unnumbered;
+      for (ReverseDomEdges Edges(B, IsPostDom); Edges.Begin != Edges.End;
+           ++Edges.Begin) {
+        const CFGBlock *Pred = *Edges.Begin;
+        if (!Pred)
+          continue;
+        unsigned PredID = Pred->getBlockID();
+        if (IDom[PredID] == Unnumbered)
+          continue;
+        if (NewIDom == Unnumbered) {
+          NewIDom = PredID;
+          continue;
+        }
+        unsigned Finger1 = PredID, Finger2 = NewIDom;
+        while (Finger1 != Finger2) {
+          while (PONumber[Finger1] < PONumber[Finger2])
+            Finger1 = IDom[Finger1];
+          while (PONumber[Finger2] < PONumber[Finger1])
+            Finger2 = IDom[Finger2];
+        }
+        NewIDom = Finger1;
+      }
+      unsigned BID = B->getBlockID();
+      if (IDom[BID] != NewIDom) {
+        IDom[BID] = NewIDom;
+        Changed = true;
+      }
+    }
+  }
+
+  // Number the tree in depth-first order.  Children are laid out contiguously
+  // by parent so the walk needs no per-node allocation.
+  SmallVector<unsigned, 16> ChildStart(NumBlocks + 1, 0);
+  for (unsigned ID = 0; ID != NumBlocks; ++ID)
+    if (ID != RootID && IDom[ID] != Unnumbered)
+      ++ChildStart[IDom[ID] + 1];
+  for (unsigned ID = 0; ID != NumBlocks; ++ID)
+    ChildStart[ID + 1] += ChildStart[ID];
+  SmallVector<unsigned, 16> Children(ChildStart[NumBlocks]);
+  {
+    SmallVector<unsigned, 16> Fill(ChildStart.begin(), ChildStart.end() - 1);
+    for (unsigned ID = 0; ID != NumBlocks; ++ID)
+      if (ID != RootID && IDom[ID] != Unnumbered)
+        Children[Fill[IDom[ID]]++] = ID;
+  }
+
+  unsigned Counter = 0;
+  SmallVector<std::pair<unsigned, unsigned>, 16> Stack;
+  DFSIn[RootID] = Counter++;
+  Stack.push_back(std::make_pair(RootID, ChildStart[RootID]));
+  while (!Stack.empty()) {
+    unsigned ID = Stack.back().first;
+    unsigned &NextChild = Stack.back().second;
+    if (NextChild == ChildStart[ID + 1]) {
+      DFSOut[ID] = Counter++;
+      Stack.pop_back();
+      continue;
+    }
+    unsigned Child = Children[NextChild++];
+    DFSIn[Child] = Counter++;
+    Stack.push_back(std::make_pair(Child, ChildStart[Child]));
+  }
+}
+
+const CFGBlock *CFGDomTree::getIDom(const CFGBlock *B) const {
+  if (!isReachableFromRoot(B) || B == Root)
+    return 0;
+  return Blocks[IDom[B->getBlockID()]];
+}
+
+const CFGBlock *
+CFGDomTree::findNearestCommonDominator(const CFGBlock *A,
+                                       const CFGBlock *B) const {
+  if (!isReachableFromRoot(A) || !isReachableFromRoot(B))
+    return 0;
+  // Walk up from A until we find a block whose subtree contains B.
+  unsigned ID = A->getBlockID();
+  const unsigned BID = B->getBlockID();
+  while (!(DFSIn[ID] <= DFSIn[BID] && DFSOut[BID] <= DFSOut[ID]))
+    ID = IDom[ID];
+  return Blocks[ID];
+}
+
+void CFGDomTree::print(raw_ostream &OS) const {
+  OS << (IsPostDom ? "Immediate post dominance tree (Node#,IDom#):\n"
+                   : "Immediate dominance tree (Node#,IDom#):\n");
+  for (unsigned ID = 0, E = Blocks.size(); ID != E; ++ID) {
+    if (!Blocks[ID])
+      continue;
+    const CFGBlock *Dom = getIDom(Blocks[ID]);
+    OS << "(" << ID << "," << (Dom ? Dom->getBlockID() : ID) << ")\n";
+  }
+}
+
+void CFGDomTree::dump() const {
+  print(llvm::errs());
+}
+
+CFGDominatorTree *CFGDominatorTree::create(AnalysisDeclContext &Ctx) {
+  const CFG *cfg = Ctx.getCFG();
+  if (!cfg)
+    return 0;
+  return new CFGDominatorTree(*cfg);
+}
+
+const void *CFGDominatorTree::getTag() { static int x; return &x; }
+
+CFGPostDominatorTree *CFGPostDominatorTree::create(AnalysisDeclContext &Ctx) {
+  const CFG *cfg = Ctx.getCFG();
+  if (!cfg)
+    return 0;
+  return new CFGPostDominatorTree(*cfg);
+}
+
+const void *CFGPostDominatorTree::getTag() { static int x; return &x; }
@@ -846,3 +846,148 @@ bool FormatSpecifier::namedTypeToLengthModifier(QualType QT,
   }
   return false;
 }
+
+//===----------------------------------------------------------------------===//
+// Methods on ParsedFormatString.
+//===----------------------------------------------------------------------===//
+
+using clang::analyze_format_string::ParsedFormatString;
+
+/// Records every callback into the owning ParsedFormatString.  The recorder
+/// never asks the parser to stop, so the recording covers everything the
+/// parser produces; a handler that wants to stop is honored during replay.
+class ParsedFormatString::Recorder : public FormatStringHandler {
+  ParsedFormatString &P;
+
+  void record(EventKind Kind, const char *Start, unsigned Length,
+              unsigned Extra = 0) {
+    Event E = { Kind, Start, Length, Extra };
+    P.Events.push_back(E);
+  }
+
+public:
+  Recorder(ParsedFormatString &P) : P(P) {}
+
+  virtual void HandleNullChar(const char *nullCharacter) {
+    record(EK_NullChar, nullCharacter, 0);
+  }
+
+  virtual void HandlePosition(const char *startPos, unsigned posLen) {
+    record(EK_Position, startPos, posLen);
+  }
+
+  virtual void HandleInvalidPosition(const char *startPos, unsigned posLen,
+                                     PositionContext p) {
+    record(EK_InvalidPosition, startPos, posLen, p);
+  }
+
+  virtual void HandleZeroPosition(const char *startPos, unsigned posLen) {
+    record(EK_ZeroPosition, startPos, posLen);
+  }
+
+  virtual void HandleIncompleteSpecifier(const char *startSpecifier,
+                                         unsigned specifierLen) {
+    record(EK_IncompleteSpecifier, startSpecifier, specifierLen);
+  }
+
+  virtual bool HandleInvalidPrintfConversionSpecifier(
+                                      const analyze_printf::PrintfSpecifier &FS,
+                                      const char *startSpecifier,
+                                      unsigned specifierLen) {
+    record(EK_InvalidPrintfConversionSpecifier, startSpecifier, specifierLen,
+           P.PrintfSpecifiers.size());
+    P.PrintfSpecifiers.push_back(FS);
+    return true;
+  }
+
+  virtual bool HandlePrintfSpecifier(const analyze_printf::PrintfSpecifier &FS,
+                                     const char *startSpecifier,
+                                     unsigned specifierLen) {
+    record(EK_PrintfSpecifier, startSpecifier, specifierLen,
+           P.PrintfSpecifiers.size());
+    P.PrintfSpecifiers.push_back(FS);
+    return true;
+  }
+
+  virtual bool HandleInvalidScanfConversionSpecifier(
+                                        const analyze_scanf::ScanfSpecifier &FS,
+                                        const char *startSpecifier,
+                                        unsigned specifierLen) {
+    record(EK_InvalidScanfConversionSpecifier, startSpecifier, specifierLen,
+           P.ScanfSpecifiers.size());
+    P.ScanfSpecifiers.push_back(FS);
+    return true;
+  }
+
+  virtual bool HandleScanfSpecifier(const analyze_scanf::ScanfSpecifier &FS,
+                                    const char *startSpecifier,
+                                    unsigned specifierLen) {
+    record(EK_ScanfSpecifier, startSpecifier, specifierLen,
+           P.ScanfSpecifiers.size());
+    P.ScanfSpecifiers.push_back(FS);
+    return true;
+  }
+
+  virtual void HandleIncompleteScanList(const char *start, const char *end) {
+    record(EK_IncompleteScanList, start, end - start);
+  }
+};
+
+ParsedFormatString::ParsedFormatString(Kind K, const char *beg,
+                                       const char *end, const LangOptions &LO,
+                                       const TargetInfo &Target)
+  : K(K), Beg(beg), End(end) {
+  Recorder R(*this);
+  if (K == Printf)
+    ParseStopped = ParsePrintfString(R, beg, end, LO, Target);
+  else
+    ParseStopped = ParseScanfString(R, beg, end, LO, Target);
+}
+
+bool ParsedFormatString::Replay(FormatStringHandler &H) const {
+  for (std::vector<Event>::const_iterator I = Events.begin(),
+       E = Events.end(); I != E; ++I) {
+    switch (I->Kind) {
+    case EK_NullChar:
+      H.HandleNullChar(I->Start);
+      break;
+    case EK_Position:
+      H.HandlePosition(I->Start, I->Length);
+      break;
+    case EK_InvalidPosition:
+      H.HandleInvalidPosition(I->Start, I->Length,
+                              static_cast<PositionContext>(I->Extra));
+      break;
+    case EK_ZeroPosition:
+      H.HandleZeroPosition(I->Start, I->Length);
+      break;
+    case EK_IncompleteSpecifier:
+      H.HandleIncompleteSpecifier(I->Start, I->Length);
+      break;
+    case EK_InvalidPrintfConversionSpecifier:
+      if (!H.HandleInvalidPrintfConversionSpecifier(
+              PrintfSpecifiers[I->Extra], I->Start, I->Length))
+        return true;
+      break;
+    case EK_PrintfSpecifier:
+      if (!H.HandlePrintfSpecifier(PrintfSpecifiers[I->Extra], I->Start,
+                                   I->Length))
+        return true;
+      break;
+    case EK_InvalidScanfConversionSpecifier:
+      if (!H.HandleInvalidScanfConversionSpecifier(
+              ScanfSpecifiers[I->Extra], I->Start, I->Length))
+        return true;
+      break;
+    case EK_ScanfSpecifier:
+      if (!H.HandleScanfSpecifier(ScanfSpecifiers[I->Extra], I->Start,
+                                  I->Length))
+        return true;
+      break;
+    case EK_IncompleteScanList:
+      H.HandleIncompleteScanList(I->Start, I->Start + I->Length);
+      break;
+    }
+  }
+  return ParseStopped;
+}
@@ -120,6 +120,8 @@ void DiagnosticsEngine::Reset() {
   // through command-line.
   DiagStates.push_back(DiagState());
   DiagStatePoints.push_back(DiagStatePoint(&DiagStates.back(), FullSourceLoc()));
+  LastDiagStatePointPos = 0;
+  LastDiagStatePointCount = 0;
 }
 
 void DiagnosticsEngine::SetDelayedDiagnostic(unsigned DiagID, StringRef Arg1,
@@ -155,9 +157,26 @@ DiagnosticsEngine::GetDiagStatePointForLoc(SourceLocation L) const {
   DiagStatePointsTy::iterator Pos = DiagStatePoints.end();
   FullSourceLoc LastStateChangePos = DiagStatePoints.back().Loc;
   if (LastStateChangePos.isValid() &&
-      Loc.isBeforeInTranslationUnitThan(LastStateChangePos))
+      Loc.isBeforeInTranslationUnitThan(LastStateChangePos)) {
+    // Loc is before the last point, so the point after the cached one is
+    // valid.  Check whether Loc falls in the cached point's region, which is
+    // two comparisons instead of a binary search over every pragma.
+    if (LastDiagStatePointCount == DiagStatePoints.size()) {
+      DiagStatePointsTy::iterator Last =
+          DiagStatePoints.begin() + LastDiagStatePointPos;
+      if ((Last->Loc.isInvalid() || !Loc.isBeforeInTranslationUnitThan(
+                                        Last->Loc)) &&
+          Loc.isBeforeInTranslationUnitThan((Last + 1)->Loc))
+        return Last;
+    }
+
     Pos = std::upper_bound(DiagStatePoints.begin(), DiagStatePoints.end(),
                            DiagStatePoint(0, Loc));
+    --Pos;
+    LastDiagStatePointPos = Pos - DiagStatePoints.begin();
+    LastDiagStatePointCount = DiagStatePoints.size();
+    return Pos;
+  }
   --Pos;
   return Pos;
 }
@@ -196,7 +215,7 @@ void DiagnosticsEngine::setDiagnosticMapping(diag::kind Diag, diag::Mapping Map,
     // A diagnostic pragma occurred, create a new DiagState initialized with
     // the current one and a new DiagStatePoint to record at which location
     // the new state became active.
-    DiagStates.push_back(*GetCurDiagState());
+    DiagStates.push_back(GetCurDiagState()->cloneForNewPoint());
     PushDiagStatePoint(&DiagStates.back(), Loc);
     GetCurDiagState()->setMappingInfo(Diag, MappingInfo);
     return;
@@ -223,7 +242,7 @@ void DiagnosticsEngine::setDiagnosticMapping(diag::kind Diag, diag::Mapping Map,
   // Create a new state/point and fit it into the vector of DiagStatePoints
   // so that the vector is always ordered according to location.
   assert(Pos->Loc.isBeforeInTranslationUnitThan(Loc));
-  DiagStates.push_back(*Pos->State);
+  DiagStates.push_back(Pos->State->cloneForNewPoint());
   DiagState *NewState = &DiagStates.back();
   GetCurDiagState()->setMappingInfo(Diag, MappingInfo);
   DiagStatePoints.insert(Pos+1, DiagStatePoint(NewState,
@@ -210,6 +210,16 @@ DiagnosticMappingInfo &DiagnosticsEngine::DiagState::getOrAddMappingInfo(
   return Result.first->second;
 }
 
+DiagnosticsEngine::DiagState
+DiagnosticsEngine::DiagState::cloneForNewPoint() const {
+  DiagState Result;
+  for (const_iterator I = begin(), E = end(); I != E; ++I)
+    if (I->second.isUser() ||
+        I->second != GetDefaultDiagMappingInfo(I->first))
+      Result.DiagMap.insert(*I);
+  return Result;
+}
+
 static const StaticDiagCategoryRec CategoryNameTable[] = {
 #define GET_CATEGORY_TABLE
 #define CATEGORY(X, ENUM) { X, STR_SIZE(X, uint8_t) },
@@ -18,6 +18,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileOverlay.h"
+#include "clang/Basic/FilePrefetcher.h"
 #include "clang/Basic/FileSystemStatCache.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/llvm-config.h"
@@ -76,6 +78,16 @@ public:
   }
 
   size_t size() const { return UniqueDirs.size(); }
+
+  /// \brief Drop every directory not in \p Kept.
+  void retain(const llvm::SmallPtrSet<const DirectoryEntry *, 64> &Kept) {
+    for (std::map<llvm::sys::fs::UniqueID, DirectoryEntry>::iterator
+           I = UniqueDirs.begin(), E = UniqueDirs.end(); I != E; ) {
+      std::map<llvm::sys::fs::UniqueID, DirectoryEntry>::iterator Cur = I++;
+      if (!Kept.count(&Cur->second))
+        UniqueDirs.erase(Cur);
+    }
+  }
 };
 
 class FileManager::UniqueFileContainer {
@@ -95,7 +107,49 @@ public:
   size_t size() const { return UniqueFiles.size(); }
 
   void erase(const FileEntry *Entry) { UniqueFiles.erase(*Entry); }
+
+  /// \brief Drop every file not in \p Kept.
+  void retain(const llvm::SmallPtrSet<const FileEntry *, 64> &Kept) {
+    for (std::set<FileEntry>::iterator I = UniqueFiles.begin(),
+                                       E = UniqueFiles.end(); I != E; ) {
+      std::set<FileEntry>::iterator Cur = I++;
+      if (!Kept.count(&*Cur))
+        UniqueFiles.erase(Cur);
+    }
+  }
+};
+
+namespace {
+/// \brief The stat cache layer that puts FileSystemOptions::Overlay on top
+/// of the file system.
+///
+/// The FileManager keeps it above the stat caches that stand in for the file
+/// system, such as the PTH and prefetcher caches, and below the ones that
+/// record stat calls, so that those see the overlaid files too.
+class OverlayStatCache : public FileSystemStatCache {
+  IntrusiveRefCntPtr<FileOverlay> Overlay;
+
+public:
+  explicit OverlayStatCache(FileOverlay *Overlay) : Overlay(Overlay) {}
+
+  virtual LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                               int *FileDescriptor) {
+    // Files in the overlay hide files on disk.
+    if (isFile && Overlay->getStat(Path, Data) && !Data.IsDirectory)
+      return CacheExists;
+
+    LookupResult Result = statChained(Path, Data, isFile, FileDescriptor);
+
+    // Directories in the overlay are only used if there is no real one, so
+    // that the files in a real directory stay visible.
+    if (Result == CacheMissing && !isFile && Overlay->getStat(Path, Data) &&
+        Data.IsDirectory)
+      return CacheExists;
+
+    return Result;
+  }
 };
+}
 
 //===----------------------------------------------------------------------===//
 // Common logic.
@@ -105,9 +159,11 @@ FileManager::FileManager(const FileSystemOptions &FSO)
   : FileSystemOpts(FSO),
     UniqueRealDirs(*new UniqueDirContainer()),
     UniqueRealFiles(*new UniqueFileContainer()),
-    SeenDirEntries(64), SeenFileEntries(64), NextFileUID(0) {
+    SeenDirEntries(64), SeenFileEntries(64), NextFileUID(0),
+    TrackUsedEntries(false) {
   NumDirLookups = NumFileLookups = 0;
   NumDirCacheMisses = NumFileCacheMisses = 0;
+  installOverlayStatCache();
 }
 
 FileManager::~FileManager() {
@@ -119,6 +175,18 @@ FileManager::~FileManager() {
     delete VirtualDirectoryEntries[i];
 }
 
+FilePrefetcher *FileManager::getPrefetcher() {
+  if (!Prefetcher && FileSystemOpts.PrefetchThreads &&
+      FilePrefetcher::isSupported()) {
+    Prefetcher.reset(new FilePrefetcher(FileSystemOpts.PrefetchThreads));
+
+    // The prefetched results stand in for the file system, so they go at the
+    // end of the chain, where the caches that record stat calls see them.
+    addStatCache(Prefetcher->createStatCache());
+  }
+  return Prefetcher.get();
+}
+
 void FileManager::addStatCache(FileSystemStatCache *statCache,
                                bool AtBeginning) {
   assert(statCache && "No stat cache provided?");
@@ -156,6 +224,12 @@ void FileManager::removeStatCache(FileSystemStatCache *statCache) {
 
 void FileManager::clearStatCaches() {
   StatCache.reset(0);
+  installOverlayStatCache();
+}
+
+void FileManager::installOverlayStatCache() {
+  if (FileSystemOpts.Overlay)
+    addStatCache(new OverlayStatCache(FileSystemOpts.Overlay.getPtr()));
 }
 
 /// \brief Retrieve the directory that the given file name resides in.
@@ -227,6 +301,8 @@ const DirectoryEntry *FileManager::getDirectory(StringRef DirName,
   ++NumDirLookups;
   llvm::StringMapEntry<DirectoryEntry *> &NamedDirEnt =
     SeenDirEntries.GetOrCreateValue(DirName);
+  if (TrackUsedEntries)
+    UsedDirEntries.insert(&NamedDirEnt);
 
   // See if there was already an entry in the map.  Note that the map
   // contains both virtual and real directories.
@@ -264,6 +340,7 @@ const DirectoryEntry *FileManager::getDirectory(StringRef DirName,
     // We don't have this directory yet, add it.  We use the string
     // key from the SeenDirEntries map as the string.
     UDE.Name  = InterndDirName;
+    UDE.ModTime = Data.ModTime;
   }
 
   return &UDE;
@@ -276,6 +353,8 @@ const FileEntry *FileManager::getFile(StringRef Filename, bool openFile,
   // See if there is already an entry in the map.
   llvm::StringMapEntry<FileEntry *> &NamedFileEnt =
     SeenFileEntries.GetOrCreateValue(Filename);
+  if (TrackUsedEntries)
+    UsedFileEntries.insert(&NamedFileEnt);
 
   // See if there is already an entry in the map.
   if (NamedFileEnt.getValue())
@@ -443,6 +522,28 @@ getBufferForFile(const FileEntry *Entry, std::string *ErrorStr,
     FileSize = -1;
 
   const char *Filename = Entry->getName();
+
+  // Files in the overlay, and files that were read ahead of time, are
+  // already in memory.
+  if (FileSystemOpts.Overlay || (Prefetcher && !isVolatile)) {
+    SmallString<128> FilePath(Filename);
+    FixupRelativePath(FilePath);
+
+    llvm::MemoryBuffer *Buffer = 0;
+    if (FileSystemOpts.Overlay)
+      Buffer = FileSystemOpts.Overlay->getBuffer(FilePath);
+    if (!Buffer && Prefetcher && !isVolatile)
+      Buffer = Prefetcher->takeBuffer(FilePath, Entry->getSize(),
+                                      Entry->getModificationTime());
+    if (Buffer) {
+      if (Entry->FD != -1) {
+        close(Entry->FD);
+        Entry->FD = -1;
+      }
+      return Buffer;
+    }
+  }
+
   // If the file is already open, use the open file descriptor.
   if (Entry->FD != -1) {
     ec = llvm::MemoryBuffer::getOpenFile(Entry->FD, Filename, Result, FileSize);
@@ -475,6 +576,14 @@ llvm::MemoryBuffer *FileManager::
 getBufferForFile(StringRef Filename, std::string *ErrorStr) {
   OwningPtr<llvm::MemoryBuffer> Result;
   llvm::error_code ec;
+  if (FileSystemOpts.Overlay) {
+    SmallString<128> FilePath(Filename);
+    FixupRelativePath(FilePath);
+    if (llvm::MemoryBuffer *Buffer =
+            FileSystemOpts.Overlay->getBuffer(FilePath))
+      return Buffer;
+  }
+
   if (FileSystemOpts.WorkingDir.empty()) {
     ec = llvm::MemoryBuffer::getFile(Filename, Result);
     if (ec && ErrorStr)
@@ -499,10 +608,6 @@ bool FileManager::getStatValue(const char *Path, FileData &Data, bool isFile,
                                int *FileDescriptor) {
   // FIXME: FileSystemOpts shouldn't be passed in here, all paths should be
   // absolute!
-  if (FileSystemOpts.WorkingDir.empty())
-    return FileSystemStatCache::get(Path, Data, isFile, FileDescriptor,
-                                    StatCache.get());
-
   SmallString<128> FilePath(Path);
   FixupRelativePath(FilePath);
 
@@ -510,12 +615,18 @@ bool FileManager::getStatValue(const char *Path, FileData &Data, bool isFile,
                                   FileDescriptor, StatCache.get());
 }
 
-bool FileManager::getNoncachedStatValue(StringRef Path,
-                                        llvm::sys::fs::file_status &Result) {
+bool FileManager::getNoncachedStatValue(StringRef Path, FileData &Result,
+                                        bool isFile) {
   SmallString<128> FilePath(Path);
   FixupRelativePath(FilePath);
 
-  return llvm::sys::fs::status(FilePath.c_str(), Result);
+  // Skip the stat caches, but not the overlay: it is part of the file system
+  // this FileManager sees.
+  if (!FileSystemOpts.Overlay)
+    return FileSystemStatCache::get(FilePath.c_str(), Result, isFile, 0, 0);
+  OverlayStatCache Overlay(FileSystemOpts.Overlay.getPtr());
+  return FileSystemStatCache::get(FilePath.c_str(), Result, isFile, 0,
+                                  &Overlay);
 }
 
 void FileManager::invalidateCache(const FileEntry *Entry) {
@@ -530,6 +641,115 @@ void FileManager::invalidateCache(const FileEntry *Entry) {
 }
 
 
+bool FileManager::hasFileSystemChanged() {
+  if (!VirtualFileEntries.empty() || !VirtualDirectoryEntries.empty())
+    return true;
+
+  FileData Data;
+  for (llvm::StringMap<DirectoryEntry*, llvm::BumpPtrAllocator>::iterator
+         I = SeenDirEntries.begin(), E = SeenDirEntries.end(); I != E; ++I) {
+    const DirectoryEntry *Dir = I->getValue();
+    bool Exists = !getNoncachedStatValue(I->getKey(), Data, /*isFile=*/false);
+    if (Dir == NON_EXISTENT_DIR) {
+      if (Exists)
+        return true;
+      continue;
+    }
+    if (!Exists || Data.ModTime != Dir->ModTime)
+      return true;
+  }
+
+  // Failed file lookups are covered by the modification time of their
+  // directory, so only the files that were found need to be checked.
+  for (llvm::StringMap<FileEntry*, llvm::BumpPtrAllocator>::iterator
+         I = SeenFileEntries.begin(), E = SeenFileEntries.end(); I != E; ++I) {
+    const FileEntry *File = I->getValue();
+    if (File == NON_EXISTENT_FILE)
+      continue;
+    if (getNoncachedStatValue(I->getKey(), Data, /*isFile=*/true) ||
+        !(Data.UniqueID == File->getUniqueID()) ||
+        off_t(Data.Size) != File->getSize() ||
+        Data.ModTime != File->ModTime)
+      return true;
+  }
+
+  return false;
+}
+
+void FileManager::discardUnusedEntries() {
+  // Collect the files and directories to keep.  Entries point into the names
+  // they were first found under, files into their directories, and failed
+  // file lookups are validated through their directories, so all of those
+  // stay as well.
+  llvm::SmallPtrSet<const FileEntry *, 64> KeptFiles;
+  llvm::SmallPtrSet<const DirectoryEntry *, 64> KeptDirs;
+  for (llvm::StringMap<FileEntry*, llvm::BumpPtrAllocator>::iterator
+         I = SeenFileEntries.begin(), E = SeenFileEntries.end(); I != E; ++I) {
+    if (!UsedFileEntries.count(&*I))
+      continue;
+
+    const FileEntry *File = I->getValue();
+    if (File == NON_EXISTENT_FILE) {
+      StringRef DirName = llvm::sys::path::parent_path(I->getKey());
+      if (DirName.empty())
+        DirName = ".";
+      llvm::StringMap<DirectoryEntry*, llvm::BumpPtrAllocator>::iterator Dir
+        = SeenDirEntries.find(DirName);
+      if (Dir == SeenDirEntries.end())
+        UsedFileEntries.erase(&*I);
+      else
+        UsedDirEntries.insert(&*Dir);
+      continue;
+    }
+
+    KeptFiles.insert(File);
+    KeptDirs.insert(File->getDir());
+    llvm::StringMap<FileEntry*, llvm::BumpPtrAllocator>::iterator Name
+      = SeenFileEntries.find(File->getName());
+    if (Name != SeenFileEntries.end())
+      UsedFileEntries.insert(&*Name);
+  }
+
+  for (llvm::StringMap<DirectoryEntry*, llvm::BumpPtrAllocator>::iterator
+         I = SeenDirEntries.begin(), E = SeenDirEntries.end(); I != E; ++I)
+    if (UsedDirEntries.count(&*I) && I->getValue() != NON_EXISTENT_DIR)
+      KeptDirs.insert(I->getValue());
+  for (llvm::SmallPtrSet<const DirectoryEntry *, 64>::iterator
+         I = KeptDirs.begin(), E = KeptDirs.end(); I != E; ++I) {
+    llvm::StringMap<DirectoryEntry*, llvm::BumpPtrAllocator>::iterator Name
+      = SeenDirEntries.find((*I)->getName());
+    if (Name != SeenDirEntries.end())
+      UsedDirEntries.insert(&*Name);
+  }
+
+  // Drop everything else.
+  for (llvm::StringMap<FileEntry*, llvm::BumpPtrAllocator>::iterator
+         I = SeenFileEntries.begin(), E = SeenFileEntries.end(); I != E; ) {
+    llvm::StringMap<FileEntry*, llvm::BumpPtrAllocator>::iterator Cur = I++;
+    if (!UsedFileEntries.count(&*Cur))
+      SeenFileEntries.erase(Cur);
+  }
+  for (llvm::StringMap<DirectoryEntry*, llvm::BumpPtrAllocator>::iterator
+         I = SeenDirEntries.begin(), E = SeenDirEntries.end(); I != E; ) {
+    llvm::StringMap<DirectoryEntry*, llvm::BumpPtrAllocator>::iterator Cur
+      = I++;
+    if (!UsedDirEntries.count(&*Cur))
+      SeenDirEntries.erase(Cur);
+  }
+  UniqueRealFiles.retain(KeptFiles);
+  UniqueRealDirs.retain(KeptDirs);
+  for (llvm::DenseMap<const DirectoryEntry *, llvm::StringRef>::iterator
+         I = CanonicalDirNames.begin(), E = CanonicalDirNames.end(); I != E; ) {
+    llvm::DenseMap<const DirectoryEntry *, llvm::StringRef>::iterator Cur
+      = I++;
+    if (!KeptDirs.count(Cur->first))
+      CanonicalDirNames.erase(Cur);
+  }
+
+  UsedFileEntries.clear();
+  UsedDirEntries.clear();
+}
+
 void FileManager::GetUniqueIDMapping(
                    SmallVectorImpl<const FileEntry *> &UIDToFiles) const {
   UIDToFiles.clear();
@@ -590,6 +810,8 @@ void FileManager::PrintStats() const {
                << NumDirCacheMisses << " dir cache misses.\n";
   llvm::errs() << NumFileLookups << " file lookups, "
                << NumFileCacheMisses << " file cache misses.\n";
+  if (Prefetcher)
+    Prefetcher->PrintStats();
 
   //llvm::errs() << PagesMapped << BytesOfPagesMapped << FSLookups;
 }
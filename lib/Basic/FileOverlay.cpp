@@ -0,0 +1,98 @@
+//===--- FileOverlay.cpp - Files layered over the file system -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the FileOverlay interface and the InMemoryFileOverlay.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/FileOverlay.h"
+#include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+
+using namespace clang;
+
+void FileOverlay::anchor() { }
+
+FileOverlay::~FileOverlay() { }
+
+InMemoryFileOverlay::InMemoryFileOverlay(FileOverlay *Parent)
+  : Parent(Parent) {
+}
+
+InMemoryFileOverlay::~InMemoryFileOverlay() {
+  for (llvm::StringMap<OverlayFile>::iterator I = Files.begin(),
+                                              E = Files.end();
+       I != E; ++I)
+    delete I->second.Buffer;
+}
+
+void InMemoryFileOverlay::addFile(StringRef Path, llvm::MemoryBuffer *Buffer,
+                                  time_t ModTime) {
+  assert(Buffer && "No buffer for overlay file");
+  OverlayFile &File = Files.GetOrCreateValue(Path).getValue();
+  if (File.Buffer != Buffer)
+    delete File.Buffer;
+  File.Buffer = Buffer;
+  File.ModTime = ModTime;
+
+  // Make the directories containing the file visible, and let their
+  // modification times reflect the newest file, just as adding a file to a
+  // real directory would.
+  for (StringRef Dir = llvm::sys::path::parent_path(Path); !Dir.empty();
+       Dir = llvm::sys::path::parent_path(Dir)) {
+    time_t &DirModTime = Directories.GetOrCreateValue(Dir, 0).getValue();
+    if (DirModTime < ModTime)
+      DirModTime = ModTime;
+  }
+}
+
+/// \brief Make up a unique ID for an overlay file or directory.
+///
+/// The address of the map entry identifies it uniquely within the process;
+/// the device number keeps it apart from anything on disk.
+static llvm::sys::fs::UniqueID getOverlayID(const void *Entry) {
+  return llvm::sys::fs::UniqueID(~0ULL, uint64_t(uintptr_t(Entry)));
+}
+
+bool InMemoryFileOverlay::getStat(StringRef Path, FileData &Data) const {
+  llvm::StringMap<OverlayFile>::const_iterator File = Files.find(Path);
+  if (File != Files.end()) {
+    Data.Size = File->second.Buffer->getBufferSize();
+    Data.ModTime = File->second.ModTime;
+    Data.UniqueID = getOverlayID(&*File);
+    Data.IsDirectory = false;
+    Data.IsNamedPipe = false;
+    Data.InPCH = false;
+    return true;
+  }
+
+  llvm::StringMap<time_t>::const_iterator Dir = Directories.find(Path);
+  if (Dir != Directories.end()) {
+    Data.Size = 0;
+    Data.ModTime = Dir->second;
+    Data.UniqueID = getOverlayID(&*Dir);
+    Data.IsDirectory = true;
+    Data.IsNamedPipe = false;
+    Data.InPCH = false;
+    return true;
+  }
+
+  return Parent && Parent->getStat(Path, Data);
+}
+
+llvm::MemoryBuffer *InMemoryFileOverlay::getBuffer(StringRef Path) const {
+  llvm::StringMap<OverlayFile>::const_iterator File = Files.find(Path);
+  if (File == Files.end())
+    return Parent ? Parent->getBuffer(Path) : 0;
+
+  // Hand out a buffer that refers to our copy of the contents.
+  const llvm::MemoryBuffer *Buffer = File->second.Buffer;
+  return llvm::MemoryBuffer::getMemBuffer(Buffer->getBuffer(), Path);
+}
@@ -0,0 +1,430 @@
+//===--- FilePrefetcher.cpp - Background reading of files -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the FilePrefetcher, which stats and reads files on
+//  background threads before the FileManager asks for them.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/FilePrefetcher.h"
+#include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Config/config.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <deque>
+#include <vector>
+
+#if defined(LLVM_ENABLE_THREADS) && LLVM_ENABLE_THREADS != 0 && \
+    defined(HAVE_PTHREAD_H)
+#define CLANG_FILE_PREFETCH_THREADS 1
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+using namespace clang;
+
+namespace {
+
+/// \brief What is known about one path.
+struct PrefetchEntry {
+  enum EntryState {
+    Queued,  ///< Some request will stat this path.
+    Running, ///< A worker is reading this path right now.
+    Done,    ///< The results are in.
+    Claimed  ///< The FileManager handles (or has handled) this path itself.
+  };
+
+  EntryState State;
+  bool Exists;
+  FileData Data;
+  llvm::MemoryBuffer *Buffer;
+
+  PrefetchEntry() : State(Queued), Exists(false), Buffer(0) { }
+};
+
+}
+
+#ifdef CLANG_FILE_PREFETCH_THREADS
+/// \brief Stat the file at \p Path and, if it is a regular file, read it.
+///
+/// \returns true if there is a file (and not a directory) at \p Path.
+static bool statAndReadFile(StringRef Path, FileData &Data,
+                            llvm::MemoryBuffer *&Buffer) {
+  Buffer = 0;
+
+  int FD;
+  if (llvm::sys::fs::openFileForRead(Path, FD))
+    return false;
+
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(FD, Status) || is_directory(Status)) {
+    ::close(FD);
+    return false;
+  }
+
+  Data.Size = Status.getSize();
+  Data.ModTime = Status.getLastModificationTime().toEpochTime();
+  Data.UniqueID = Status.getUniqueID();
+  Data.IsDirectory = false;
+  Data.IsNamedPipe = Status.type() == llvm::sys::fs::file_type::fifo_file;
+  Data.InPCH = false;
+
+  // Named pipes and the like are left to the FileManager.
+  if (!is_regular_file(Status)) {
+    ::close(FD);
+    return true;
+  }
+
+  Buffer = llvm::MemoryBuffer::getNewUninitMemBuffer(Data.Size, Path);
+  if (Buffer) {
+    char *Pos = const_cast<char *>(Buffer->getBufferStart());
+    size_t Left = Data.Size;
+    while (Left) {
+      ssize_t NumRead = ::read(FD, Pos, Left);
+      if (NumRead <= 0) {
+        // Leave the error to the FileManager, which will read the file
+        // itself and diagnose it.
+        delete Buffer;
+        Buffer = 0;
+        break;
+      }
+      Pos += NumRead;
+      Left -= NumRead;
+    }
+  }
+
+  ::close(FD);
+  return true;
+}
+#endif
+
+class FilePrefetcher::Implementation {
+public:
+  typedef std::vector<std::string> Request;
+
+  llvm::StringMap<PrefetchEntry> Entries;
+  std::deque<Request> Queue;
+
+  // Statistics.
+  unsigned NumRequests, NumRequestsOnDemand, NumFilesRead, NumStatHits;
+  unsigned NumBufferHits, NumStaleBuffers, NumWaits;
+
+#ifdef CLANG_FILE_PREFETCH_THREADS
+  pthread_mutex_t Lock;
+  /// \brief Signalled when a request is queued or the workers must stop.
+  pthread_cond_t WorkAvailable;
+  /// \brief Signalled when a worker finishes with a path.
+  pthread_cond_t WorkDone;
+  std::vector<pthread_t> Threads;
+  bool ShuttingDown;
+
+  static void *WorkerMain(void *Arg) {
+    static_cast<Implementation *>(Arg)->runWorker();
+    return 0;
+  }
+
+  void runWorker();
+  void processRequest(const Request &R);
+  bool runQueuedRequest(StringRef Path);
+
+  /// \brief Wait until no worker is reading \p E.
+  void waitForEntry(PrefetchEntry &E) {
+    while (E.State == PrefetchEntry::Running)
+      pthread_cond_wait(&WorkDone, &Lock);
+  }
+#endif
+
+  explicit Implementation(unsigned NumThreads);
+  ~Implementation();
+
+  void lock() {
+#ifdef CLANG_FILE_PREFETCH_THREADS
+    pthread_mutex_lock(&Lock);
+#endif
+  }
+  void unlock() {
+#ifdef CLANG_FILE_PREFETCH_THREADS
+    pthread_mutex_unlock(&Lock);
+#endif
+  }
+};
+
+FilePrefetcher::Implementation::Implementation(unsigned NumThreads)
+  : NumRequests(0), NumRequestsOnDemand(0), NumFilesRead(0), NumStatHits(0),
+    NumBufferHits(0), NumStaleBuffers(0), NumWaits(0) {
+#ifdef CLANG_FILE_PREFETCH_THREADS
+  ShuttingDown = false;
+  pthread_mutex_init(&Lock, 0);
+  pthread_cond_init(&WorkAvailable, 0);
+  pthread_cond_init(&WorkDone, 0);
+  for (unsigned I = 0; I != NumThreads; ++I) {
+    pthread_t Thread;
+    if (pthread_create(&Thread, 0, WorkerMain, this))
+      break;
+    Threads.push_back(Thread);
+  }
+#endif
+}
+
+FilePrefetcher::Implementation::~Implementation() {
+#ifdef CLANG_FILE_PREFETCH_THREADS
+  lock();
+  ShuttingDown = true;
+  Queue.clear();
+  pthread_cond_broadcast(&WorkAvailable);
+  unlock();
+  for (unsigned I = 0, N = Threads.size(); I != N; ++I)
+    pthread_join(Threads[I], 0);
+  pthread_cond_destroy(&WorkDone);
+  pthread_cond_destroy(&WorkAvailable);
+  pthread_mutex_destroy(&Lock);
+#endif
+
+  for (llvm::StringMap<PrefetchEntry>::iterator I = Entries.begin(),
+                                                E = Entries.end();
+       I != E; ++I)
+    delete I->second.Buffer;
+}
+
+#ifdef CLANG_FILE_PREFETCH_THREADS
+void FilePrefetcher::Implementation::runWorker() {
+  lock();
+  while (true) {
+    while (Queue.empty() && !ShuttingDown)
+      pthread_cond_wait(&WorkAvailable, &Lock);
+    if (ShuttingDown)
+      break;
+
+    Request R;
+    R.swap(Queue.front());
+    Queue.pop_front();
+    processRequest(R);
+  }
+  unlock();
+}
+
+/// \brief Work through the candidates of \p R until one of them exists.
+///
+/// Called, and returns, with the lock held.
+void FilePrefetcher::Implementation::processRequest(const Request &R) {
+  for (unsigned I = 0, N = R.size(); I != N && !ShuttingDown; ++I) {
+    PrefetchEntry &E = Entries.GetOrCreateValue(R[I]).getValue();
+    waitForEntry(E);
+
+    switch (E.State) {
+    case PrefetchEntry::Running:
+      llvm_unreachable("waited for the entry");
+
+    case PrefetchEntry::Claimed:
+      // The FileManager got here first, and is resolving this #include on
+      // its own.
+      return;
+
+    case PrefetchEntry::Done:
+      if (E.Exists)
+        return;
+      continue;
+
+    case PrefetchEntry::Queued:
+      break;
+    }
+
+    E.State = PrefetchEntry::Running;
+    unlock();
+    FileData Data;
+    llvm::MemoryBuffer *Buffer;
+    bool Exists = statAndReadFile(R[I], Data, Buffer);
+    lock();
+
+    E.State = PrefetchEntry::Done;
+    E.Exists = Exists;
+    if (Exists)
+      E.Data = Data;
+    E.Buffer = Buffer;
+    if (Buffer)
+      ++NumFilesRead;
+    pthread_cond_broadcast(&WorkDone);
+
+    if (Exists)
+      return;
+  }
+}
+
+/// \brief Take the queued request whose first candidate is \p Path off the
+/// queue and process it on the calling thread.
+///
+/// Called, and returns, with the lock held.
+bool FilePrefetcher::Implementation::runQueuedRequest(StringRef Path) {
+  for (std::deque<Request>::iterator I = Queue.begin(), E = Queue.end();
+       I != E; ++I) {
+    if (I->front() != Path)
+      continue;
+
+    Request R;
+    R.swap(*I);
+    Queue.erase(I);
+    ++NumRequestsOnDemand;
+    processRequest(R);
+    return true;
+  }
+  return false;
+}
+#endif
+
+namespace {
+/// \brief A stat cache answering from what the prefetcher found out.
+class PrefetchStatCache : public FileSystemStatCache {
+  FilePrefetcher &Prefetcher;
+
+public:
+  explicit PrefetchStatCache(FilePrefetcher &Prefetcher)
+    : Prefetcher(Prefetcher) { }
+
+  LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                       int *FileDescriptor) {
+    // Only files are prefetched.
+    if (isFile) {
+      switch (Prefetcher.getStat(Path, Data)) {
+      case FilePrefetcher::StatMissing:
+        return CacheMissing;
+      case FilePrefetcher::StatExists:
+        return CacheExists;
+      case FilePrefetcher::StatUnknown:
+        break;
+      }
+    }
+
+    return statChained(Path, Data, isFile, FileDescriptor);
+  }
+};
+} // end anonymous namespace
+
+FilePrefetcher::FilePrefetcher(unsigned NumThreads)
+  : Impl(*new Implementation(NumThreads)) {
+}
+
+FilePrefetcher::~FilePrefetcher() {
+  delete &Impl;
+}
+
+bool FilePrefetcher::isSupported() {
+#ifdef CLANG_FILE_PREFETCH_THREADS
+  return true;
+#else
+  return false;
+#endif
+}
+
+void FilePrefetcher::prefetch(ArrayRef<std::string> Candidates) {
+#ifdef CLANG_FILE_PREFETCH_THREADS
+  if (Candidates.empty() || Impl.Threads.empty())
+    return;
+
+  Impl.lock();
+  // Every lookup of the same file from the same place starts with the same
+  // candidate, so if we know about that one, the file was already requested
+  // or looked up.  Recording it as queued keeps later #includes of the file
+  // from requesting it again before a worker gets to it.
+  if (!Impl.Entries.count(Candidates[0])) {
+    Impl.Entries.GetOrCreateValue(Candidates[0]).getValue().State =
+        PrefetchEntry::Queued;
+    ++Impl.NumRequests;
+    Impl.Queue.push_back(Implementation::Request(Candidates.begin(),
+                                                 Candidates.end()));
+    pthread_cond_signal(&Impl.WorkAvailable);
+  }
+  Impl.unlock();
+#endif
+}
+
+FilePrefetcher::StatResult FilePrefetcher::getStat(StringRef Path,
+                                                   FileData &Data) {
+  StatResult Result = StatUnknown;
+
+  Impl.lock();
+  llvm::StringMap<PrefetchEntry>::iterator Pos = Impl.Entries.find(Path);
+  if (Pos != Impl.Entries.end()) {
+    PrefetchEntry &E = Pos->second;
+#ifdef CLANG_FILE_PREFETCH_THREADS
+    // No worker got to this request yet, so rather than leave the request to
+    // redo what we are about to do, work through it here.
+    if (E.State == PrefetchEntry::Queued)
+      Impl.runQueuedRequest(Path);
+    if (E.State == PrefetchEntry::Running) {
+      ++Impl.NumWaits;
+      Impl.waitForEntry(E);
+    }
+#endif
+    if (E.State == PrefetchEntry::Done) {
+      ++Impl.NumStatHits;
+      Result = E.Exists ? StatExists : StatMissing;
+      if (E.Exists)
+        Data = E.Data;
+    }
+    E.State = PrefetchEntry::Claimed;
+  } else {
+    // Make sure no worker repeats what the caller is about to do.
+    Impl.Entries.GetOrCreateValue(Path).getValue().State =
+        PrefetchEntry::Claimed;
+  }
+  Impl.unlock();
+
+  return Result;
+}
+
+FileSystemStatCache *FilePrefetcher::createStatCache() {
+  return new PrefetchStatCache(*this);
+}
+
+llvm::MemoryBuffer *FilePrefetcher::takeBuffer(StringRef Path, off_t Size,
+                                               time_t ModTime) {
+  llvm::MemoryBuffer *Buffer = 0;
+
+  Impl.lock();
+  llvm::StringMap<PrefetchEntry>::iterator Pos = Impl.Entries.find(Path);
+  if (Pos != Impl.Entries.end()) {
+    PrefetchEntry &E = Pos->second;
+#ifdef CLANG_FILE_PREFETCH_THREADS
+    if (E.State == PrefetchEntry::Running) {
+      ++Impl.NumWaits;
+      Impl.waitForEntry(E);
+    }
+#endif
+    Buffer = E.Buffer;
+    E.Buffer = 0;
+    if (Buffer) {
+      if (off_t(E.Data.Size) == Size && E.Data.ModTime == ModTime) {
+        ++Impl.NumBufferHits;
+      } else {
+        ++Impl.NumStaleBuffers;
+        delete Buffer;
+        Buffer = 0;
+      }
+    }
+  }
+  Impl.unlock();
+
+  return Buffer;
+}
+
+void FilePrefetcher::PrintStats() const {
+  Impl.lock();
+  llvm::errs() << Impl.NumRequests << " prefetch requests, "
+               << Impl.NumRequestsOnDemand << " run on demand, "
+               << Impl.NumFilesRead << " files read ahead.\n";
+  llvm::errs() << Impl.NumStatHits << " prefetched stats used, "
+               << Impl.NumBufferHits << " prefetched buffers used, "
+               << Impl.NumStaleBuffers << " stale buffers dropped.\n";
+  llvm::errs() << Impl.NumWaits << " waits for a background read.\n";
+  Impl.unlock();
+}
@@ -20,6 +20,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
+#include <vector>
 
 using namespace clang;
 
@@ -73,7 +74,9 @@ ExternalIdentifierLookup::~ExternalIdentifierLookup() {}
 IdentifierTable::IdentifierTable(const LangOptions &LangOpts,
                                  IdentifierInfoLookup* externalLookup)
   : HashTable(8192), // Start with space for 8K identifiers.
-    ExternalLookup(externalLookup) {
+    ExternalLookup(externalLookup), NumHashedLookups(0),
+    NumLookupCacheHits(0), NumLookupCacheCollisions(0) {
+  memset(LookupCache, 0, sizeof(LookupCache));
 
   // Populate the identifier table with info about keywords for the current
   // language.
@@ -277,6 +280,27 @@ void IdentifierTable::PrintStats() const {
           (AverageIdentifierSize/(double)NumIdentifiers));
   fprintf(stderr, "Max identifier length: %d\n", MaxIdentifierLength);
 
+  // Show how evenly the identifier hash spreads the identifiers over the
+  // lookup cache, and how often the lexer found its identifier there.
+  std::vector<unsigned> IdentifiersPerSlot(LookupCacheSize);
+  unsigned MaxIdentifiersPerSlot = 0, NumUsedSlots = 0;
+  for (HashTableTy::const_iterator I = HashTable.begin(), E = HashTable.end();
+       I != E; ++I) {
+    unsigned Slot = hashIdentifier(I->getKey()) & (LookupCacheSize - 1);
+    unsigned Count = ++IdentifiersPerSlot[Slot];
+    if (Count == 1)
+      ++NumUsedSlots;
+    if (MaxIdentifiersPerSlot < Count)
+      MaxIdentifiersPerSlot = Count;
+  }
+  fprintf(stderr, "# Lookup cache slots used: %d of %d\n", NumUsedSlots,
+          (int)LookupCacheSize);
+  fprintf(stderr, "Identifiers per used slot: %f (max %d)\n",
+          NumIdentifiers/(double)(NumUsedSlots ? NumUsedSlots : 1),
+          MaxIdentifiersPerSlot);
+  fprintf(stderr, "# Hashed lookups: %d, %d cache hits, %d collisions\n",
+          NumHashedLookups, NumLookupCacheHits, NumLookupCacheCollisions);
+
   // Compute statistics about the memory allocated for identifiers.
   HashTable.getAllocator().PrintStats();
 }
@@ -564,6 +564,7 @@ void CodeGenFunction::PopCleanupBlock(bool FallthroughIsBranchThrough) {
   assert(isa<EHCleanupScope>(*EHStack.begin()) && "top not a cleanup!");
   EHCleanupScope &Scope = cast<EHCleanupScope>(*EHStack.begin());
   assert(Scope.getFixupDepth() <= EHStack.getNumBranchFixups());
+  ++EHStats.NumCleanups;
 
   // Remember activation information.
   bool IsActive = Scope.isActive();
@@ -859,7 +860,15 @@ void CodeGenFunction::PopCleanupBlock(bool FallthroughIsBranchThrough) {
   assert(EHStack.hasNormalCleanups() || EHStack.getNumBranchFixups() == 0);
 
   // Emit the EH cleanup if required.
-  if (RequiresEHCleanup) {
+  // If the cleanup was never active on the EH path, unwinding through it
+  // does nothing, so send its users straight to the enclosing EH scope
+  // instead of emitting a block that only forwards to it.
+  if (RequiresEHCleanup && !EHActiveFlag && !IsActive) {
+    EHEntry->replaceAllUsesWith(getEHDispatchBlock(EHParent));
+    delete EHEntry;
+    ++EHStats.NumEHCleanupsSkipped;
+  } else if (RequiresEHCleanup) {
+    ++EHStats.NumEHCleanups;
     CGDebugInfo *DI = getDebugInfo();
     SaveAndRestoreLocation AutoRestoreLocation(*this, Builder);
     if (DI)
@@ -869,13 +878,10 @@ void CodeGenFunction::PopCleanupBlock(bool FallthroughIsBranchThrough) {
 
     EmitBlock(EHEntry);
 
-    // We only actually emit the cleanup code if the cleanup is either
-    // active or was used before it was deactivated.
-    if (EHActiveFlag || IsActive) {
-
-      cleanupFlags.setIsForEHCleanup();
-      EmitCleanup(*this, Fn, cleanupFlags, EHActiveFlag);
-    }
+    // We only get here if the cleanup is either active or was used before
+    // it was deactivated.
+    cleanupFlags.setIsForEHCleanup();
+    EmitCleanup(*this, Fn, cleanupFlags, EHActiveFlag);
 
     Builder.CreateBr(getEHDispatchBlock(EHParent));
 
@@ -683,7 +683,10 @@ llvm::BasicBlock *CodeGenFunction::getInvokeDestImpl() {
   // Check the innermost scope for a cached landing pad.  If this is
   // a non-EH cleanup, we'll check enclosing scopes in EmitLandingPad.
   llvm::BasicBlock *LP = EHStack.begin()->getCachedLandingPad();
-  if (LP) return LP;
+  if (LP) {
+    ++EHStats.NumLandingPadsShared;
+    return LP;
+  }
 
   // Build the landing pad for this scope.
   LP = EmitLandingPad();
@@ -755,13 +758,17 @@ llvm::BasicBlock *CodeGenFunction::EmitLandingPad() {
   EHScope &innermostEHScope = *EHStack.find(EHStack.getInnermostEHScope());
   switch (innermostEHScope.getKind()) {
   case EHScope::Terminate:
+    if (TerminateLandingPad)
+      ++EHStats.NumLandingPadsShared;
     return getTerminateLandingPad();
 
   case EHScope::Catch:
   case EHScope::Cleanup:
   case EHScope::Filter:
-    if (llvm::BasicBlock *lpad = innermostEHScope.getCachedLandingPad())
+    if (llvm::BasicBlock *lpad = innermostEHScope.getCachedLandingPad()) {
+      ++EHStats.NumLandingPadsShared;
       return lpad;
+    }
   }
 
   // Save the current IR generation state.
@@ -775,6 +782,7 @@ llvm::BasicBlock *CodeGenFunction::EmitLandingPad() {
   // Create and configure the landing pad.
   llvm::BasicBlock *lpad = createBasicBlock("lpad");
   EmitBlock(lpad);
+  ++EHStats.NumLandingPads;
 
   llvm::LandingPadInst *LPadInst =
     Builder.CreateLandingPad(llvm::StructType::get(Int8PtrTy, Int32Ty, NULL),
@@ -1588,6 +1596,7 @@ llvm::BasicBlock *CodeGenFunction::getTerminateLandingPad() {
   // This will get inserted at the end of the function.
   TerminateLandingPad = createBasicBlock("terminate.lpad");
   Builder.SetInsertPoint(TerminateLandingPad);
+  ++EHStats.NumLandingPads;
 
   // Tell the backend that this is a landing pad.
   const EHPersonality &Personality = EHPersonality::get(CGM.getLangOpts());
@@ -1768,8 +1768,10 @@ LValue CodeGenFunction::EmitDeclRefLValue(const DeclRefExpr *E) {
   }
 
   if (const VarDecl *VD = dyn_cast<VarDecl>(ND)) {
-    // Check if this is a global variable.
-    if (VD->hasLinkage() || VD->isStaticDataMember()) {
+    // Check if this is a global variable, unless it was made private to the
+    // captured region being emitted.
+    if ((VD->hasLinkage() || VD->isStaticDataMember()) &&
+        !(CapturedStmtInfo && LocalDeclMap.count(VD))) {
       // If it's thread_local, emit a call to its wrapper function instead.
       if (VD->getTLSKind() == VarDecl::TLS_Dynamic)
         return CGM.getCXXABI().EmitThreadLocalDeclRefExpr(*this, E);
@@ -2428,6 +2430,37 @@ EmitExtVectorElementExpr(const ExtVectorElementExpr *E) {
                                   Base.getAlignment());
 }
 
+/// Given an lvalue for the base class subobject reached by the
+/// derived-to-base conversion \p Cast, make its TBAA access path start at the
+/// derived class instead, at \p DerivedOffset into \p DerivedTBAABaseType.
+/// Paths through virtual bases are left alone, since their offset is not
+/// fixed.
+static void setTBAAPathThroughBase(CodeGenFunction &CGF, LValue &LV,
+                                   const CastExpr *Cast,
+                                   QualType DerivedTBAABaseType,
+                                   uint64_t DerivedOffset) {
+  if (!CGF.CGM.getCodeGenOpts().StructPathTBAA)
+    return;
+  if (Cast->path_empty() || (*Cast->path_begin())->isVirtual())
+    return;
+
+  QualType DerivedTy = Cast->getSubExpr()->getType();
+  if (const PointerType *PT = DerivedTy->getAs<PointerType>())
+    DerivedTy = PT->getPointeeType();
+  const CXXRecordDecl *RD = DerivedTy->getAsCXXRecordDecl();
+
+  CharUnits Offset = CharUnits::Zero();
+  for (CastExpr::path_const_iterator I = Cast->path_begin(),
+       E = Cast->path_end(); I != E; ++I) {
+    const CXXRecordDecl *Base = (*I)->getType()->getAsCXXRecordDecl();
+    Offset += CGF.getContext().getASTRecordLayout(RD).getBaseClassOffset(Base);
+    RD = Base;
+  }
+
+  LV.setTBAABaseType(DerivedTBAABaseType);
+  LV.setTBAAOffset(DerivedOffset + Offset.getQuantity());
+}
+
 LValue CodeGenFunction::EmitMemberExpr(const MemberExpr *E) {
   Expr *BaseExpr = E->getBase();
 
@@ -2438,6 +2471,16 @@ LValue CodeGenFunction::EmitMemberExpr(const MemberExpr *E) {
     QualType PtrTy = BaseExpr->getType()->getPointeeType();
     EmitTypeCheck(TCK_MemberAccess, E->getExprLoc(), Ptr, PtrTy);
     BaseLV = MakeNaturalAlignAddrLValue(Ptr, PtrTy);
+
+    // For d->x with x a member of a base class, the pointer to the base
+    // still points into a complete derived object.
+    if (const ImplicitCastExpr *Cast =
+          dyn_cast<ImplicitCastExpr>(BaseExpr->IgnoreParens()))
+      if (Cast->getCastKind() == CK_DerivedToBase ||
+          Cast->getCastKind() == CK_UncheckedDerivedToBase)
+        setTBAAPathThroughBase(*this, BaseLV, Cast,
+                               Cast->getSubExpr()->getType()->getPointeeType(),
+                               0);
   } else
     BaseLV = EmitCheckedLValue(BaseExpr, TCK_MemberAccess);
 
@@ -2799,7 +2842,10 @@ LValue CodeGenFunction::EmitCastLValue(const CastExpr *E) {
                             E->path_begin(), E->path_end(),
                             /*NullCheckValue=*/false);
 
-    return MakeAddrLValue(Base, E->getType());
+    LValue BaseLV = MakeAddrLValue(Base, E->getType());
+    setTBAAPathThroughBase(*this, BaseLV, E, LV.getTBAABaseType(),
+                           LV.getTBAAOffset());
+    return BaseLV;
   }
   case CK_ToUnion:
     return EmitAggExprToLValue(E);
@@ -25,6 +25,7 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalVariable.h"
+#include "llvm/Support/MathExtras.h"
 using namespace clang;
 using namespace CodeGen;
 
@@ -549,6 +550,196 @@ llvm::Constant *ConstStructBuilder::BuildStruct(CodeGenModule &CGM,
 }
 
 
+//===----------------------------------------------------------------------===//
+//                          Literal Array Initializers
+//===----------------------------------------------------------------------===//
+
+/// Determine whether an array of \p EltTy can be emitted as a
+/// ConstantDataArray holding the bit patterns of its elements.
+static bool isDataArrayElementType(const ASTContext &Context, QualType EltTy,
+                                   llvm::Type *LLVMEltTy) {
+  if (EltTy->isBooleanType())
+    return false;
+  if (!EltTy->isIntegralOrEnumerationType() && !EltTy->isRealFloatingType())
+    return false;
+  if (LLVMEltTy->isFloatTy() || LLVMEltTy->isDoubleTy())
+    return true;
+  if (!LLVMEltTy->isIntegerTy(8) && !LLVMEltTy->isIntegerTy(16) &&
+      !LLVMEltTy->isIntegerTy(32) && !LLVMEltTy->isIntegerTy(64))
+    return false;
+  return Context.getTypeSize(EltTy) ==
+         LLVMEltTy->getPrimitiveSizeInBits();
+}
+
+template <typename T>
+static llvm::Constant *getIntDataArray(llvm::LLVMContext &VMContext,
+                                       ArrayRef<uint64_t> Bits,
+                                       uint64_t FillerBits,
+                                       unsigned NumElements) {
+  SmallVector<T, 64> Elts(NumElements, T(FillerBits));
+  for (unsigned I = 0, N = Bits.size(); I != N; ++I)
+    Elts[I] = T(Bits[I]);
+  return llvm::ConstantDataArray::get(VMContext, Elts);
+}
+
+/// Build an array of \p NumElements elements of type \p LLVMEltTy, the first
+/// of which have the bit patterns \p Bits and the rest \p FillerBits.
+static llvm::Constant *getDataArray(llvm::LLVMContext &VMContext,
+                                    llvm::Type *LLVMEltTy,
+                                    ArrayRef<uint64_t> Bits,
+                                    uint64_t FillerBits,
+                                    unsigned NumElements) {
+  if (LLVMEltTy->isFloatTy()) {
+    SmallVector<float, 64> Elts(NumElements,
+                                llvm::BitsToFloat(uint32_t(FillerBits)));
+    for (unsigned I = 0, N = Bits.size(); I != N; ++I)
+      Elts[I] = llvm::BitsToFloat(uint32_t(Bits[I]));
+    return llvm::ConstantDataArray::get(VMContext, Elts);
+  }
+  if (LLVMEltTy->isDoubleTy()) {
+    SmallVector<double, 64> Elts(NumElements, llvm::BitsToDouble(FillerBits));
+    for (unsigned I = 0, N = Bits.size(); I != N; ++I)
+      Elts[I] = llvm::BitsToDouble(Bits[I]);
+    return llvm::ConstantDataArray::get(VMContext, Elts);
+  }
+
+  switch (LLVMEltTy->getIntegerBitWidth()) {
+  case 8:
+    return getIntDataArray<uint8_t>(VMContext, Bits, FillerBits, NumElements);
+  case 16:
+    return getIntDataArray<uint16_t>(VMContext, Bits, FillerBits, NumElements);
+  case 32:
+    return getIntDataArray<uint32_t>(VMContext, Bits, FillerBits, NumElements);
+  case 64:
+    return getIntDataArray<uint64_t>(VMContext, Bits, FillerBits, NumElements);
+  }
+  llvm_unreachable("not a data array element type");
+}
+
+/// Compute the bit pattern of the array element initializer \p E, converted
+/// to \p DestTy, if it is a literal.
+///
+/// The literal may be negated and implicitly converted, which covers the
+/// elements of the tables that are typically initialized this way.
+static bool getLiteralInitBits(const ASTContext &Context, const Expr *E,
+                               QualType DestTy, uint64_t &Bits) {
+  if (isa<ImplicitValueInitExpr>(E)) {
+    Bits = 0;
+    return true;
+  }
+
+  E = E->IgnoreParens();
+  if (const ImplicitCastExpr *ICE = dyn_cast<ImplicitCastExpr>(E)) {
+    switch (ICE->getCastKind()) {
+    case CK_NoOp:
+    case CK_IntegralCast:
+    case CK_IntegralToFloating:
+    case CK_FloatingCast:
+      break;
+    default:
+      return false;
+    }
+    E = ICE->getSubExpr()->IgnoreParens();
+  }
+
+  APValue Literal;
+  if (!E->getLiteralValue(Literal, Context))
+    return false;
+
+  if (Literal.isFloat()) {
+    if (!DestTy->isRealFloatingType())
+      return false;
+    llvm::APFloat Value = Literal.getFloat();
+    bool LosesInfo;
+    Value.convert(Context.getFloatTypeSemantics(DestTy),
+                  llvm::APFloat::rmNearestTiesToEven, &LosesInfo);
+    Bits = Value.bitcastToAPInt().getZExtValue();
+    return true;
+  }
+
+  const llvm::APSInt &Value = Literal.getInt();
+  if (DestTy->isRealFloatingType()) {
+    llvm::APFloat Result(Context.getFloatTypeSemantics(DestTy));
+    Result.convertFromAPInt(Value, Value.isSigned(),
+                            llvm::APFloat::rmNearestTiesToEven);
+    Bits = Result.bitcastToAPInt().getZExtValue();
+    return true;
+  }
+
+  // Truncation to the element type happens when the array is built.
+  Bits = Value.extOrTrunc(64).getZExtValue();
+  return true;
+}
+
+/// Emit \p ILE, which initializes an array of integer or floating-point
+/// values, directly as a ConstantDataArray if its elements are all literals.
+///
+/// Large tables and embedded resources are written this way.  Emitting them
+/// through the constant evaluator or ConstExprEmitter would create an APValue
+/// or an llvm::Constant per element, which dominates the compile time and
+/// memory use for such tables.
+static llvm::Constant *EmitLiteralArrayInit(CodeGenModule &CGM,
+                                            const InitListExpr *ILE) {
+  ASTContext &Context = CGM.getContext();
+  const ConstantArrayType *CAT =
+    Context.getAsConstantArrayType(ILE->getType());
+  if (!CAT || ILE->isStringLiteralInit())
+    return 0;
+
+  QualType EltTy = CAT->getElementType();
+  llvm::Type *LLVMEltTy = CGM.getTypes().ConvertTypeForMem(EltTy);
+  if (!isDataArrayElementType(Context, EltTy, LLVMEltTy))
+    return 0;
+
+  unsigned NumElements = CAT->getSize().getZExtValue();
+  unsigned NumInits = std::min(ILE->getNumInits(), NumElements);
+  if (NumInits < NumElements)
+    if (const Expr *Filler = ILE->getArrayFiller())
+      if (!isa<ImplicitValueInitExpr>(Filler))
+        return 0;
+
+  SmallVector<uint64_t, 64> Bits(NumInits);
+  for (unsigned I = 0; I != NumInits; ++I)
+    if (!getLiteralInitBits(Context, ILE->getInit(I), EltTy, Bits[I]))
+      return 0;
+
+  return getDataArray(CGM.getLLVMContext(), LLVMEltTy, Bits, 0, NumElements);
+}
+
+/// Emit the array value \p Value of type \p DestType directly as a
+/// ConstantDataArray if its elements are integers.
+static llvm::Constant *EmitIntegerArrayValue(CodeGenModule &CGM,
+                                             const APValue &Value,
+                                             QualType DestType) {
+  ASTContext &Context = CGM.getContext();
+  QualType EltTy = Context.getAsArrayType(DestType)->getElementType();
+  if (!EltTy->isIntegralOrEnumerationType())
+    return 0;
+  llvm::Type *LLVMEltTy = CGM.getTypes().ConvertTypeForMem(EltTy);
+  if (!isDataArrayElementType(Context, EltTy, LLVMEltTy))
+    return 0;
+
+  uint64_t FillerBits = 0;
+  if (Value.hasArrayFiller()) {
+    const APValue &Filler = Value.getArrayFiller();
+    if (!Filler.isInt())
+      return 0;
+    FillerBits = Filler.getInt().extOrTrunc(64).getZExtValue();
+  }
+
+  unsigned NumInitElts = Value.getArrayInitializedElts();
+  SmallVector<uint64_t, 64> Bits(NumInitElts);
+  for (unsigned I = 0; I != NumInitElts; ++I) {
+    const APValue &Elt = Value.getArrayInitializedElt(I);
+    if (!Elt.isInt())
+      return 0;
+    Bits[I] = Elt.getInt().extOrTrunc(64).getZExtValue();
+  }
+
+  return getDataArray(CGM.getLLVMContext(), LLVMEltTy, Bits, FillerBits,
+                      Value.getArraySize());
+}
+
 //===----------------------------------------------------------------------===//
 //                             ConstExprEmitter
 //===----------------------------------------------------------------------===//
@@ -724,6 +915,9 @@ public:
     if (ILE->isStringLiteralInit())
       return Visit(ILE->getInit(0));
 
+    if (llvm::Constant *C = EmitLiteralArrayInit(CGM, ILE))
+      return C;
+
     llvm::ArrayType *AType =
         cast<llvm::ArrayType>(ConvertType(ILE->getType()));
     llvm::Type *ElemTy = AType->getElementType();
@@ -991,6 +1185,12 @@ llvm::Constant *CodeGenModule::EmitConstantInit(const VarDecl &D,
       }
   }
   
+  // Tables of literals are emitted without evaluating them first, which would
+  // build an APValue for every element.
+  if (const InitListExpr *ILE = dyn_cast_or_null<InitListExpr>(D.getInit()))
+    if (llvm::Constant *C = EmitLiteralArrayInit(*this, ILE))
+      return C;
+
   if (const APValue *Value = D.evaluateValue())
     return EmitConstantValueForMemory(*Value, D.getType(), CGF);
 
@@ -1161,6 +1361,9 @@ llvm::Constant *CodeGenModule::EmitConstantValue(const APValue &Value,
   case APValue::Union:
     return ConstStructBuilder::BuildStruct(*this, CGF, Value, DestType);
   case APValue::Array: {
+    if (llvm::Constant *C = EmitIntegerArrayValue(*this, Value, DestType))
+      return C;
+
     const ArrayType *CAT = Context.getAsArrayType(DestType);
     unsigned NumElements = Value.getArraySize();
     unsigned NumInitElts = Value.getArrayInitializedElts();
@@ -291,6 +291,56 @@ shouldExtendReceiverForInnerPointerMessage(const ObjCMessageExpr *message) {
   llvm_unreachable("invalid receiver kind");
 }
 
+/// Find the method definition that an instance message is known to reach,
+/// so that it can be called directly instead of sent, or return null.
+///
+/// This is only the case when the receiver's class cannot be subclassed,
+/// its implementation is in this translation unit, and no category in
+/// this translation unit declares or implements the method too.  Categories
+/// that come after the message are only known at the end of the translation
+/// unit, so the runtime checks for them again then.
+static const ObjCMethodDecl *
+findDirectDispatchTarget(ASTContext &Ctx, const ObjCMessageExpr *message,
+                         const ObjCMethodDecl *method) {
+  if (!method || !method->isInstanceMethod())
+    return 0;
+
+  const ObjCObjectPointerType *receiverType =
+    message->getInstanceReceiver()->getType()->getAsObjCInterfacePointerType();
+  if (!receiverType)
+    return 0;
+  const ObjCInterfaceDecl *iface = receiverType->getInterfaceDecl();
+  if (!iface || !iface->hasDefinition())
+    return 0;
+  iface = iface->getDefinition();
+  if (!iface->hasAttr<ObjCSubclassingRestrictedAttr>())
+    return 0;
+
+  Selector sel = message->getSelector();
+  if (CGObjCRuntime::hasCategoryInstanceMethod(iface, sel))
+    return 0;
+
+  const ObjCImplementationDecl *impl = iface->getImplementation();
+  if (!impl)
+    return 0;
+  const ObjCMethodDecl *definition = impl->getInstanceMethod(sel);
+  if (!definition || !definition->hasBody())
+    return 0;
+
+  // The call is made through the signature the message was checked
+  // against, so the definition has to agree with it.
+  if (definition->isVariadic() != method->isVariadic() ||
+      definition->param_size() != method->param_size() ||
+      !Ctx.hasSameType(definition->getReturnType(), method->getReturnType()))
+    return 0;
+  for (unsigned i = 0, e = method->param_size(); i != e; ++i)
+    if (!Ctx.hasSameType(definition->param_begin()[i]->getType(),
+                         method->param_begin()[i]->getType()))
+      return 0;
+
+  return definition;
+}
+
 RValue CodeGenFunction::EmitObjCMessageExpr(const ObjCMessageExpr *E,
                                             ReturnValueSlot Return) {
   // Only the lookup mechanism and first two arguments of the method
@@ -390,6 +440,13 @@ RValue CodeGenFunction::EmitObjCMessageExpr(const ObjCMessageExpr *E,
     Builder.CreateStore(getNullForVariable(selfAddr), selfAddr);
   }
 
+  // Under -fobjc-direct-dispatch, call the method directly if we know
+  // which implementation the message reaches.
+  const ObjCMethodDecl *directTarget = 0;
+  if (CGM.getCodeGenOpts().ObjCDirectDispatch &&
+      E->getReceiverKind() == ObjCMessageExpr::Instance)
+    directTarget = findDirectDispatchTarget(getContext(), E, method);
+
   RValue result;
   if (isSuperMessage) {
     // super is only valid in an Objective-C method
@@ -403,6 +460,10 @@ RValue CodeGenFunction::EmitObjCMessageExpr(const ObjCMessageExpr *E,
                                               isClassMessage,
                                               Args,
                                               method);
+  } else if (directTarget) {
+    result = Runtime.GenerateDirectMethodCall(*this, Return, ResultType,
+                                              Receiver, Args, method,
+                                              directTarget);
   } else {
     result = Runtime.GenerateMessageSend(*this, Return, ResultType,
                                          E->getSelector(),
@@ -865,6 +865,19 @@ protected:
   /// this translation unit.
   llvm::DenseMap<const ObjCMethodDecl*, llvm::Function*> MethodDefinitions;
 
+  /// DirectDispatchCall - A direct method call, made through a placeholder
+  /// until the end of the translation unit shows whether a category
+  /// replaces the method.
+  struct DirectDispatchCall {
+    llvm::Function *Placeholder;
+    const ObjCMethodDecl *Definition;
+    /// The messenger to send the message through if it is replaced.
+    llvm::Constant *Messenger;
+  };
+
+  /// DirectDispatchCalls - the direct method calls not yet resolved.
+  SmallVector<DirectDispatchCall, 8> DirectDispatchCalls;
+
   /// PropertyNames - uniqued method variable names.
   llvm::DenseMap<IdentifierInfo*, llvm::GlobalVariable*> PropertyNames;
 
@@ -928,6 +941,12 @@ protected:
 
   llvm::Function *GetMethodDefinition(const ObjCMethodDecl *MD);
 
+  /// GetMethodFunction - Return the function implementing the method \p OMD
+  /// of the implementation \p CD, creating it if it has not been emitted
+  /// yet.
+  llvm::Function *GetMethodFunction(const ObjCMethodDecl *OMD,
+                                    const ObjCContainerDecl *CD);
+
   /// BuildIvarLayout - Builds ivar layout bitmap for the class
   /// implementation for the __strong or __weak case.
   ///
@@ -1030,6 +1049,27 @@ protected:
                                   const ObjCMethodDecl *OMD,
                                   const ObjCCommonTypesHelper &ObjCTypes);
 
+  CodeGen::RValue EmitDirectMethodCall(CodeGen::CodeGenFunction &CGF,
+                                       ReturnValueSlot Return,
+                                       QualType ResultType,
+                                       llvm::Value *Sel,
+                                       llvm::Value *Receiver,
+                                       const CallArgList &CallArgs,
+                                       const ObjCMethodDecl *Method,
+                                       const ObjCMethodDecl *Definition,
+                                       const ObjCCommonTypesHelper &ObjCTypes);
+
+  /// GetMessengerFn - Return the runtime function that sends a message with
+  /// the given signature and result type.
+  llvm::Constant *GetMessengerFn(const MessageSendInfo &MSI,
+                                 QualType ResultType, bool IsSuper,
+                                 const ObjCCommonTypesHelper &ObjCTypes);
+
+  /// ResolveDirectDispatchCalls - Now that the whole translation unit has
+  /// been seen, point each direct method call at the method, or back at the
+  /// messenger if a category replaces the method.
+  void ResolveDirectDispatchCalls();
+
   /// EmitImageInfo - Emit the image info marker used to encode some module
   /// level information.
   void EmitImageInfo();
@@ -1200,6 +1240,15 @@ public:
                            const CallArgList &CallArgs,
                            const ObjCMethodDecl *Method);
 
+  virtual CodeGen::RValue
+  GenerateDirectMethodCall(CodeGen::CodeGenFunction &CGF,
+                           ReturnValueSlot Return,
+                           QualType ResultType,
+                           llvm::Value *Receiver,
+                           const CallArgList &CallArgs,
+                           const ObjCMethodDecl *Method,
+                           const ObjCMethodDecl *Definition);
+
   virtual llvm::Value *GetClass(CodeGenFunction &CGF,
                                 const ObjCInterfaceDecl *ID);
 
@@ -1478,6 +1527,15 @@ public:
                            const CallArgList &CallArgs,
                            const ObjCMethodDecl *Method);
 
+  virtual CodeGen::RValue
+  GenerateDirectMethodCall(CodeGen::CodeGenFunction &CGF,
+                           ReturnValueSlot Return,
+                           QualType ResultType,
+                           llvm::Value *Receiver,
+                           const CallArgList &CallArgs,
+                           const ObjCMethodDecl *Method,
+                           const ObjCMethodDecl *Definition);
+
   virtual llvm::Value *GetClass(CodeGenFunction &CGF,
                                 const ObjCInterfaceDecl *ID);
 
@@ -1856,6 +1914,20 @@ CodeGen::RValue CGObjCMac::GenerateMessageSend(CodeGen::CodeGenFunction &CGF,
                          false, CallArgs, Method, ObjCTypes);
 }
 
+CodeGen::RValue
+CGObjCMac::GenerateDirectMethodCall(CodeGen::CodeGenFunction &CGF,
+                                    ReturnValueSlot Return,
+                                    QualType ResultType,
+                                    llvm::Value *Receiver,
+                                    const CallArgList &CallArgs,
+                                    const ObjCMethodDecl *Method,
+                                    const ObjCMethodDecl *Definition) {
+  return EmitDirectMethodCall(CGF, Return, ResultType,
+                              EmitSelector(CGF, Method->getSelector()),
+                              Receiver, CallArgs, Method, Definition,
+                              ObjCTypes);
+}
+
 CodeGen::RValue
 CGObjCCommonMac::EmitMessageSend(CodeGen::CodeGenFunction &CGF,
                                  ReturnValueSlot Return,
@@ -1884,21 +1956,9 @@ CGObjCCommonMac::EmitMessageSend(CodeGen::CodeGenFunction &CGF,
 
   NullReturnState nullReturn;
 
-  llvm::Constant *Fn = NULL;
-  if (CGM.ReturnTypeUsesSRet(MSI.CallInfo)) {
-    if (!IsSuper) nullReturn.init(CGF, Arg0);
-    Fn = (ObjCABI == 2) ?  ObjCTypes.getSendStretFn2(IsSuper)
-      : ObjCTypes.getSendStretFn(IsSuper);
-  } else if (CGM.ReturnTypeUsesFPRet(ResultType)) {
-    Fn = (ObjCABI == 2) ? ObjCTypes.getSendFpretFn2(IsSuper)
-      : ObjCTypes.getSendFpretFn(IsSuper);
-  } else if (CGM.ReturnTypeUsesFP2Ret(ResultType)) {
-    Fn = (ObjCABI == 2) ? ObjCTypes.getSendFp2RetFn2(IsSuper)
-      : ObjCTypes.getSendFp2retFn(IsSuper);
-  } else {
-    Fn = (ObjCABI == 2) ? ObjCTypes.getSendFn2(IsSuper)
-      : ObjCTypes.getSendFn(IsSuper);
-  }
+  llvm::Constant *Fn = GetMessengerFn(MSI, ResultType, IsSuper, ObjCTypes);
+  if (CGM.ReturnTypeUsesSRet(MSI.CallInfo) && !IsSuper)
+    nullReturn.init(CGF, Arg0);
   
   bool requiresnullCheck = false;
   if (CGM.getLangOpts().ObjCAutoRefCount && Method)
@@ -1915,10 +1975,101 @@ CGObjCCommonMac::EmitMessageSend(CodeGen::CodeGenFunction &CGF,
   
   Fn = llvm::ConstantExpr::getBitCast(Fn, MSI.MessengerType);
   RValue rvalue = CGF.EmitCall(MSI.CallInfo, Fn, Return, ActualArgs);
+  ++CGF.ObjCStats.NumMessageSends;
   return nullReturn.complete(CGF, rvalue, ResultType, CallArgs,
                              requiresnullCheck ? Method : 0);
 }
 
+/// EmitDirectMethodCall - Call the implementation \p Definition of a
+/// message with the arguments the message send would have passed to
+/// objc_msgSend.
+CodeGen::RValue
+CGObjCCommonMac::EmitDirectMethodCall(CodeGen::CodeGenFunction &CGF,
+                                      ReturnValueSlot Return,
+                                      QualType ResultType,
+                                      llvm::Value *Sel,
+                                      llvm::Value *Receiver,
+                                      const CallArgList &CallArgs,
+                                      const ObjCMethodDecl *Method,
+                                      const ObjCMethodDecl *Definition,
+                                      const ObjCCommonTypesHelper &ObjCTypes) {
+  CallArgList ActualArgs;
+  llvm::Value *Arg0 = CGF.Builder.CreateBitCast(Receiver, ObjCTypes.ObjectPtrTy);
+  ActualArgs.add(RValue::get(Arg0), CGF.getContext().getObjCIdType());
+  ActualArgs.add(RValue::get(Sel), CGF.getContext().getObjCSelType());
+  ActualArgs.addFrom(CallArgs);
+
+  // The implementation takes the same arguments as the messenger would.
+  MessageSendInfo MSI = getMessageSendInfo(Method, ResultType, ActualArgs);
+
+  // A message to nil does nothing, but the method itself would run with a
+  // null self, so it has to be skipped for a null receiver.
+  NullReturnState nullReturn;
+  nullReturn.init(CGF, Arg0);
+
+  // A category later in the translation unit may still replace the method,
+  // so call through a placeholder that is resolved at the end of it.
+  llvm::FunctionType *CalleeTy =
+    cast<llvm::FunctionType>(MSI.MessengerType->getElementType());
+  DirectDispatchCall Call;
+  Call.Placeholder = llvm::Function::Create(CalleeTy,
+                                            llvm::GlobalValue::ExternalLinkage,
+                                            "", &CGM.getModule());
+  Call.Definition = Definition;
+  Call.Messenger = GetMessengerFn(MSI, ResultType, /*IsSuper=*/false,
+                                  ObjCTypes);
+  DirectDispatchCalls.push_back(Call);
+
+  RValue rvalue = CGF.EmitCall(MSI.CallInfo, Call.Placeholder, Return,
+                               ActualArgs);
+  ++CGF.ObjCStats.NumDirectCalls;
+  return nullReturn.complete(CGF, rvalue, ResultType, CallArgs,
+                             CGM.getLangOpts().ObjCAutoRefCount ? Method : 0);
+}
+
+llvm::Constant *
+CGObjCCommonMac::GetMessengerFn(const MessageSendInfo &MSI,
+                                QualType ResultType, bool IsSuper,
+                                const ObjCCommonTypesHelper &ObjCTypes) {
+  if (CGM.ReturnTypeUsesSRet(MSI.CallInfo))
+    return (ObjCABI == 2) ?  ObjCTypes.getSendStretFn2(IsSuper)
+      : ObjCTypes.getSendStretFn(IsSuper);
+  if (CGM.ReturnTypeUsesFPRet(ResultType))
+    return (ObjCABI == 2) ? ObjCTypes.getSendFpretFn2(IsSuper)
+      : ObjCTypes.getSendFpretFn(IsSuper);
+  if (CGM.ReturnTypeUsesFP2Ret(ResultType))
+    return (ObjCABI == 2) ? ObjCTypes.getSendFp2RetFn2(IsSuper)
+      : ObjCTypes.getSendFp2retFn(IsSuper);
+  return (ObjCABI == 2) ? ObjCTypes.getSendFn2(IsSuper)
+    : ObjCTypes.getSendFn(IsSuper);
+}
+
+void CGObjCCommonMac::ResolveDirectDispatchCalls() {
+  for (unsigned i = 0, e = DirectDispatchCalls.size(); i != e; ++i) {
+    const DirectDispatchCall &Call = DirectDispatchCalls[i];
+    const ObjCMethodDecl *Definition = Call.Definition;
+    const ObjCContainerDecl *CD =
+      cast<ObjCContainerDecl>(Definition->getDeclContext());
+
+    llvm::Constant *Target;
+    if (hasCategoryInstanceMethod(
+            cast<ObjCImplementationDecl>(CD)->getClassInterface(),
+            Definition->getSelector())) {
+      // The method is replaced at runtime, so send the message after all.
+      // The receiver was already checked for null, which does no harm.
+      Target = Call.Messenger;
+      CGM.revertObjCDirectCalls(Call.Placeholder->getNumUses());
+    } else {
+      Target = GetMethodFunction(Definition, CD);
+    }
+
+    Call.Placeholder->replaceAllUsesWith(
+        llvm::ConstantExpr::getBitCast(Target, Call.Placeholder->getType()));
+    Call.Placeholder->eraseFromParent();
+  }
+  DirectDispatchCalls.clear();
+}
+
 static Qualifiers::GC GetGCAttrTypeForType(ASTContext &Ctx, QualType FQT) {
   if (FQT.isObjCGCStrong())
     return Qualifiers::Strong;
@@ -3405,20 +3556,28 @@ llvm::Constant *CGObjCMac::EmitMethodList(Twine Name,
 
 llvm::Function *CGObjCCommonMac::GenerateMethod(const ObjCMethodDecl *OMD,
                                                 const ObjCContainerDecl *CD) {
+  llvm::Function *Method = GetMethodFunction(OMD, CD);
+  MethodDefinitions.insert(std::make_pair(OMD, Method));
+
+  return Method;
+}
+
+llvm::Function *CGObjCCommonMac::GetMethodFunction(const ObjCMethodDecl *OMD,
+                                                   const ObjCContainerDecl *CD) {
   SmallString<256> Name;
   GetNameForMethod(OMD, CD, Name);
 
+  // A direct call may have declared the method before its body is emitted.
+  if (llvm::Function *Method = CGM.getModule().getFunction(Name.str()))
+    return Method;
+
   CodeGenTypes &Types = CGM.getTypes();
   llvm::FunctionType *MethodTy =
     Types.GetFunctionType(Types.arrangeObjCMethodDeclaration(OMD));
-  llvm::Function *Method =
-    llvm::Function::Create(MethodTy,
-                           llvm::GlobalValue::InternalLinkage,
-                           Name.str(),
-                           &CGM.getModule());
-  MethodDefinitions.insert(std::make_pair(OMD, Method));
-
-  return Method;
+  return llvm::Function::Create(MethodTy,
+                                llvm::GlobalValue::InternalLinkage,
+                                Name.str(),
+                                &CGM.getModule());
 }
 
 llvm::GlobalVariable *
@@ -3442,6 +3601,7 @@ CGObjCCommonMac::CreateMetadataVar(Twine Name,
 
 llvm::Function *CGObjCMac::ModuleInitFunction() {
   // Abuse this interface function as a place to finalize.
+  ResolveDirectDispatchCalls();
   FinishModule();
   return NULL;
 }
@@ -5496,6 +5656,7 @@ ObjCNonFragileABITypesHelper::ObjCNonFragileABITypesHelper(CodeGen::CodeGenModul
 }
 
 llvm::Function *CGObjCNonFragileABIMac::ModuleInitFunction() {
+  ResolveDirectDispatchCalls();
   FinishNonFragileABIModule();
 
   return NULL;
@@ -6627,6 +6788,7 @@ CGObjCNonFragileABIMac::EmitVTableMessageSend(CodeGenFunction &CGF,
   callee = CGF.Builder.CreateBitCast(callee, MSI.MessengerType);
 
   RValue result = CGF.EmitCall(MSI.CallInfo, callee, returnSlot, args);
+  ++CGF.ObjCStats.NumMessageSends;
   return nullReturn.complete(CGF, result, resultType, formalArgs, 
                              requiresnullCheck ? method : 0);
 }
@@ -6651,6 +6813,20 @@ CGObjCNonFragileABIMac::GenerateMessageSend(CodeGen::CodeGenFunction &CGF,
                       false, CallArgs, Method, ObjCTypes);
 }
 
+CodeGen::RValue
+CGObjCNonFragileABIMac::GenerateDirectMethodCall(CodeGen::CodeGenFunction &CGF,
+                                                 ReturnValueSlot Return,
+                                                 QualType ResultType,
+                                                 llvm::Value *Receiver,
+                                                 const CallArgList &CallArgs,
+                                                 const ObjCMethodDecl *Method,
+                                                 const ObjCMethodDecl *Definition) {
+  return EmitDirectMethodCall(CGF, Return, ResultType,
+                              EmitSelector(CGF, Method->getSelector()),
+                              Receiver, CallArgs, Method, Definition,
+                              ObjCTypes);
+}
+
 llvm::GlobalVariable *
 CGObjCNonFragileABIMac::GetClassGlobal(const std::string &Name) {
   llvm::GlobalVariable *GV = CGM.getModule().getGlobalVariable(Name);
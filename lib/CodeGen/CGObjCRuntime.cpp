@@ -381,3 +381,33 @@ CGObjCRuntime::getMessageSendInfo(const ObjCMethodDecl *method,
     CGM.getTypes().GetFunctionType(argsInfo)->getPointerTo();
   return MessageSendInfo(argsInfo, signatureType);
 }
+
+bool CGObjCRuntime::hasCategoryInstanceMethod(const ObjCInterfaceDecl *Class,
+                                              Selector Sel) {
+  for (ObjCInterfaceDecl::visible_categories_iterator
+         Cat = Class->visible_categories_begin(),
+         CatEnd = Class->visible_categories_end();
+       Cat != CatEnd; ++Cat) {
+    // Methods of class extensions are implemented by the class itself.
+    if (Cat->IsClassExtension())
+      continue;
+    if (Cat->getInstanceMethod(Sel))
+      return true;
+    if (const ObjCCategoryImplDecl *CatImpl = Cat->getImplementation())
+      if (CatImpl->getInstanceMethod(Sel))
+        return true;
+  }
+  return false;
+}
+
+CodeGen::RValue
+CGObjCRuntime::GenerateDirectMethodCall(CodeGen::CodeGenFunction &CGF,
+                                        ReturnValueSlot ReturnSlot,
+                                        QualType ResultType,
+                                        llvm::Value *Receiver,
+                                        const CallArgList &CallArgs,
+                                        const ObjCMethodDecl *Method,
+                                        const ObjCMethodDecl *Definition) {
+  return GenerateMessageSend(CGF, ReturnSlot, ResultType, Method->getSelector(),
+                             Receiver, CallArgs, 0, Method);
+}
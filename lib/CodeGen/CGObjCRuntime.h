@@ -177,6 +177,27 @@ public:
                            const CallArgList &CallArgs,
                            const ObjCMethodDecl *Method = 0) = 0;
 
+  /// Determine whether a category of \p Class in this translation unit
+  /// declares or implements the instance method \p Sel, and so may replace
+  /// the class's own implementation at runtime.
+  static bool hasCategoryInstanceMethod(const ObjCInterfaceDecl *Class,
+                                        Selector Sel);
+
+  /// Generate a call straight to \p Definition, the implementation that a
+  /// message to \p Receiver is known to reach, instead of a message send.
+  ///
+  /// \param Method - The method the message send was type-checked against.
+  /// The default implementation ignores \p Definition and sends the
+  /// message.
+  virtual CodeGen::RValue
+  GenerateDirectMethodCall(CodeGen::CodeGenFunction &CGF,
+                           ReturnValueSlot ReturnSlot,
+                           QualType ResultType,
+                           llvm::Value *Receiver,
+                           const CallArgList &CallArgs,
+                           const ObjCMethodDecl *Method,
+                           const ObjCMethodDecl *Definition);
+
   /// Emit the code to return the named protocol as an object, as in a
   /// \@protocol expression.
   virtual llvm::Value *GenerateProtocolRef(CodeGenFunction &CGF,
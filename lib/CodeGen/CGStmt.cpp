@@ -75,7 +75,6 @@ void CodeGenFunction::EmitStmt(const Stmt *S) {
   case Stmt::SEHExceptStmtClass:
   case Stmt::SEHFinallyStmtClass:
   case Stmt::MSDependentExistsStmtClass:
-  case Stmt::OMPParallelDirectiveClass:
     llvm_unreachable("invalid statement class to emit generically");
   case Stmt::NullStmtClass:
   case Stmt::CompoundStmtClass:
@@ -141,6 +140,9 @@ void CodeGenFunction::EmitStmt(const Stmt *S) {
     EmitCapturedStmt(*CS, CS->getCapturedRegionKind());
     }
     break;
+  case Stmt::OMPParallelDirectiveClass:
+    EmitOMPParallelDirective(cast<OMPParallelDirective>(*S));
+    break;
   case Stmt::ObjCAtTryStmtClass:
     EmitObjCAtTryStmt(cast<ObjCAtTryStmt>(*S));
     break;
@@ -393,7 +395,25 @@ void CodeGenFunction::EmitLabelStmt(const LabelStmt &S) {
 }
 
 void CodeGenFunction::EmitAttributedStmt(const AttributedStmt &S) {
-  EmitStmt(S.getSubStmt());
+  // Loops get to see their attributes, which carry any '#pragma clang loop'
+  // options.
+  const Stmt *SubStmt = S.getSubStmt();
+  switch (SubStmt->getStmtClass()) {
+  case Stmt::WhileStmtClass:
+    EmitWhileStmt(cast<WhileStmt>(*SubStmt), S.getAttrs());
+    break;
+  case Stmt::DoStmtClass:
+    EmitDoStmt(cast<DoStmt>(*SubStmt), S.getAttrs());
+    break;
+  case Stmt::ForStmtClass:
+    EmitForStmt(cast<ForStmt>(*SubStmt), S.getAttrs());
+    break;
+  case Stmt::CXXForRangeStmtClass:
+    EmitCXXForRangeStmt(cast<CXXForRangeStmt>(*SubStmt), S.getAttrs());
+    break;
+  default:
+    EmitStmt(SubStmt);
+  }
 }
 
 void CodeGenFunction::EmitGotoStmt(const GotoStmt &S) {
@@ -506,7 +526,91 @@ void CodeGenFunction::EmitIfStmt(const IfStmt &S) {
   Cnt.applyAdjustmentsToRegion();
 }
 
-void CodeGenFunction::EmitWhileStmt(const WhileStmt &S) {
+/// \brief Build the loop ID for a loop with the given attributes: a
+/// distinct, self-referential node whose other operands are the
+/// '#pragma clang loop' options in the form the loop passes read them.
+///
+/// \returns null if there are no loop hints among \p Attrs.
+static llvm::MDNode *createLoopID(CodeGenFunction &CGF,
+                                  ArrayRef<const Attr *> Attrs) {
+  llvm::LLVMContext &Context = CGF.getLLVMContext();
+
+  // The first operand is filled in with the node itself below.
+  SmallVector<llvm::Value *, 4> Operands(1);
+  for (unsigned I = 0, N = Attrs.size(); I != N; ++I) {
+    const LoopHintAttr *LH = dyn_cast<LoopHintAttr>(Attrs[I]);
+    if (!LH)
+      continue;
+
+    const char *Name = 0;
+    llvm::Value *Value = 0;
+    switch (LH->getOption()) {
+    case LoopHintAttr::Vectorize:
+      // The vectorizer is disabled by asking for a width of one.
+      if (LH->getValue()) {
+        Name = "llvm.vectorizer.enable";
+        Value = CGF.Builder.getTrue();
+      } else {
+        Name = "llvm.vectorizer.width";
+        Value = llvm::ConstantInt::get(CGF.Int32Ty, 1);
+      }
+      break;
+    case LoopHintAttr::VectorizeWidth:
+      Name = "llvm.vectorizer.width";
+      Value = llvm::ConstantInt::get(CGF.Int32Ty, LH->getValue());
+      break;
+    case LoopHintAttr::InterleaveCount:
+      Name = "llvm.vectorizer.unroll";
+      Value = llvm::ConstantInt::get(CGF.Int32Ty, LH->getValue());
+      break;
+    case LoopHintAttr::Unroll:
+      Name = "llvm.loop.unroll.enable";
+      Value = CGF.Builder.getInt1(LH->getValue() != 0);
+      break;
+    case LoopHintAttr::UnrollCount:
+      Name = "llvm.loop.unroll.count";
+      Value = llvm::ConstantInt::get(CGF.Int32Ty, LH->getValue());
+      break;
+    }
+
+    llvm::Value *Option[] = { llvm::MDString::get(Context, Name), Value };
+    Operands.push_back(llvm::MDNode::get(Context, Option));
+  }
+
+  if (Operands.size() == 1)
+    return 0;
+
+  // A temporary node stands in for the self-reference, which also keeps the
+  // IDs of loops with identical options apart.
+  llvm::MDNode *Temp = llvm::MDNode::getTemporary(Context, None);
+  Operands[0] = Temp;
+  llvm::MDNode *LoopID = llvm::MDNode::get(Context, Operands);
+  LoopID->replaceOperandWith(0, LoopID);
+  llvm::MDNode::deleteTemporary(Temp);
+  return LoopID;
+}
+
+/// \brief Tag \p BackEdge, the branch from the latch of a loop to its
+/// header, with the loop ID built from the loop's attributes.
+static void attachLoopID(CodeGenFunction &CGF, llvm::BranchInst *BackEdge,
+                         ArrayRef<const Attr *> Attrs) {
+  if (Attrs.empty())
+    return;
+  if (llvm::MDNode *LoopID = createLoopID(CGF, Attrs))
+    BackEdge->setMetadata("llvm.loop", LoopID);
+}
+
+void CodeGenFunction::EmitLoopBackEdge(llvm::BasicBlock *Header,
+                                       ArrayRef<const Attr *> Attrs) {
+  llvm::BasicBlock *CurBB = Builder.GetInsertBlock();
+  if (CurBB && !CurBB->getTerminator())
+    attachLoopID(*this, Builder.CreateBr(Header), Attrs);
+
+  Builder.ClearInsertionPoint();
+}
+
+void CodeGenFunction::EmitWhileStmt(const WhileStmt &S,
+                                    ArrayRef<const Attr *> WhileAttrs) {
   RegionCounter Cnt = getPGORegionCounter(&S);
 
   // Emit the header for the loop, which will also become
@@ -583,7 +687,7 @@ void CodeGenFunction::EmitWhileStmt(const WhileStmt &S) {
   ConditionScope.ForceCleanup();
 
   // Branch to the loop header again.
-  EmitBranch(LoopHeader.getBlock());
+  EmitLoopBackEdge(LoopHeader.getBlock(), WhileAttrs);
 
   // Emit the exit block.
   EmitBlock(LoopExit.getBlock(), true);
@@ -595,7 +699,8 @@ void CodeGenFunction::EmitWhileStmt(const WhileStmt &S) {
     SimplifyForwardingBlocks(LoopHeader.getBlock());
 }
 
-void CodeGenFunction::EmitDoStmt(const DoStmt &S) {
+void CodeGenFunction::EmitDoStmt(const DoStmt &S,
+                                 ArrayRef<const Attr *> DoAttrs) {
   JumpDest LoopExit = getJumpDestInCurrentScope("do.end");
   JumpDest LoopCond = getJumpDestInCurrentScope("do.cond");
 
@@ -637,9 +742,12 @@ void CodeGenFunction::EmitDoStmt(const DoStmt &S) {
   uint64_t ExitCount = Cnt.getLoopExitCount();
 
   // As long as the condition is true, iterate the loop.
-  if (EmitBoolCondBranch)
-    Builder.CreateCondBr(BoolCondVal, LoopBody, LoopExit.getBlock(),
-                         PGO.createBranchWeights(LoopCount, ExitCount));
+  if (EmitBoolCondBranch) {
+    llvm::BranchInst *BackEdge =
+      Builder.CreateCondBr(BoolCondVal, LoopBody, LoopExit.getBlock(),
+                           PGO.createBranchWeights(LoopCount, ExitCount));
+    attachLoopID(*this, BackEdge, DoAttrs);
+  }
 
   // Emit the exit block.
   EmitBlock(LoopExit.getBlock());
@@ -651,7 +759,8 @@ void CodeGenFunction::EmitDoStmt(const DoStmt &S) {
     SimplifyForwardingBlocks(LoopCond.getBlock());
 }
 
-void CodeGenFunction::EmitForStmt(const ForStmt &S) {
+void CodeGenFunction::EmitForStmt(const ForStmt &S,
+                                  ArrayRef<const Attr *> ForAttrs) {
   RegionCounter Cnt = getPGORegionCounter(&S);
 
   JumpDest LoopExit = getJumpDestInCurrentScope("for.end");
@@ -743,7 +852,7 @@ void CodeGenFunction::EmitForStmt(const ForStmt &S) {
                         PGO.createBranchWeights(LoopCount, ExitCount));
 
   ConditionScope.ForceCleanup();
-  EmitBranch(CondBlock);
+  EmitLoopBackEdge(CondBlock, ForAttrs);
 
   ForScope.ForceCleanup();
 
@@ -755,7 +864,9 @@ void CodeGenFunction::EmitForStmt(const ForStmt &S) {
   PGO.setCurrentRegionCount(ExitCount + Cnt.getBreakCounter().getCount());
 }
 
-void CodeGenFunction::EmitCXXForRangeStmt(const CXXForRangeStmt &S) {
+void
+CodeGenFunction::EmitCXXForRangeStmt(const CXXForRangeStmt &S,
+                                     ArrayRef<const Attr *> ForAttrs) {
   RegionCounter Cnt = getPGORegionCounter(&S);
 
   JumpDest LoopExit = getJumpDestInCurrentScope("for.end");
@@ -824,7 +935,7 @@ void CodeGenFunction::EmitCXXForRangeStmt(const CXXForRangeStmt &S) {
   CondBr->setMetadata(llvm::LLVMContext::MD_prof,
                       PGO.createBranchWeights(LoopCount, ExitCount));
 
-  EmitBranch(CondBlock);
+  EmitLoopBackEdge(CondBlock, ForAttrs);
 
   ForScope.ForceCleanup();
 
@@ -1945,20 +2056,20 @@ void CodeGenFunction::EmitAsmStmt(const AsmStmt &S) {
   }
 }
 
-static LValue InitCapturedStruct(CodeGenFunction &CGF, const CapturedStmt &S) {
+LValue CodeGenFunction::InitCapturedStruct(const CapturedStmt &S) {
   const RecordDecl *RD = S.getCapturedRecordDecl();
-  QualType RecordTy = CGF.getContext().getRecordType(RD);
+  QualType RecordTy = getContext().getRecordType(RD);
 
   // Initialize the captured struct.
-  LValue SlotLV = CGF.MakeNaturalAlignAddrLValue(
-                    CGF.CreateMemTemp(RecordTy, "agg.captured"), RecordTy);
+  LValue SlotLV = MakeNaturalAlignAddrLValue(
+                    CreateMemTemp(RecordTy, "agg.captured"), RecordTy);
 
   RecordDecl::field_iterator CurField = RD->field_begin();
   for (CapturedStmt::capture_init_iterator I = S.capture_init_begin(),
                                            E = S.capture_init_end();
        I != E; ++I, ++CurField) {
-    LValue LV = CGF.EmitLValueForFieldInitialization(SlotLV, *CurField);
-    CGF.EmitInitializerForField(*CurField, LV, *I, ArrayRef<VarDecl *>());
+    LValue LV = EmitLValueForFieldInitialization(SlotLV, *CurField);
+    EmitInitializerForField(*CurField, LV, *I, ArrayRef<VarDecl *>());
   }
 
   return SlotLV;
@@ -1972,7 +2083,7 @@ CodeGenFunction::EmitCapturedStmt(const CapturedStmt &S, CapturedRegionKind K) {
   const RecordDecl *RD = S.getCapturedRecordDecl();
   assert(CD->hasBody() && "missing CapturedDecl body");
 
-  LValue CapStruct = InitCapturedStruct(*this, S);
+  LValue CapStruct = InitCapturedStruct(S);
 
   // Emit the CapturedDecl
   CodeGenFunction CGF(CGM, true);
@@ -0,0 +1,159 @@
+//===--- CGStmtOpenMP.cpp - Emit LLVM Code from OpenMP Statements ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This contains code to emit OpenMP directives as LLVM code.
+//
+// Parallel regions are outlined into a function taking the captured
+// variables, which is run on a team of threads through the GOMP_* entry
+// points of the OpenMP runtime (provided by libgomp, and by libiomp for
+// compatibility).
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeGenFunction.h"
+#include "CodeGenModule.h"
+#include "clang/AST/StmtOpenMP.h"
+
+using namespace clang;
+using namespace CodeGen;
+
+namespace {
+/// \brief Emits the body of an OpenMP region, after making the private
+/// copies of the variables listed in its data-sharing clauses.
+class CGOpenMPRegionInfo : public CodeGenFunction::CGCapturedStmtInfo {
+  const OMPExecutableDirective &Directive;
+
+public:
+  CGOpenMPRegionInfo(const OMPExecutableDirective &D, const CapturedStmt &S)
+    : CGCapturedStmtInfo(S, CR_OpenMP), Directive(D) { }
+
+  virtual void EmitBody(CodeGenFunction &CGF, Stmt *S) {
+    CGF.EmitOMPPrivateClauses(Directive);
+    CGF.EmitStmt(S);
+  }
+
+  virtual StringRef getHelperName() const { return "__omp_parallel"; }
+};
+}
+
+/// \brief void GOMP_parallel_start(void (*fn)(void *), void *data,
+///                                 unsigned num_threads);
+static llvm::Constant *getParallelStartFn(CodeGenModule &CGM) {
+  llvm::Type *MicrotaskTy =
+    llvm::FunctionType::get(CGM.VoidTy, CGM.VoidPtrTy, /*isVarArg=*/false);
+  llvm::Type *Params[] = {
+    MicrotaskTy->getPointerTo(), CGM.VoidPtrTy, CGM.Int32Ty
+  };
+  llvm::FunctionType *FTy =
+    llvm::FunctionType::get(CGM.VoidTy, Params, /*isVarArg=*/false);
+  return CGM.CreateRuntimeFunction(FTy, "GOMP_parallel_start");
+}
+
+/// \brief void GOMP_parallel_end(void);
+static llvm::Constant *getParallelEndFn(CodeGenModule &CGM) {
+  llvm::FunctionType *FTy =
+    llvm::FunctionType::get(CGM.VoidTy, /*isVarArg=*/false);
+  return CGM.CreateRuntimeFunction(FTy, "GOMP_parallel_end");
+}
+
+/// \brief Whether a private copy of a variable of type \p Ty can be made
+/// without running constructors or destructors.
+static bool isTriviallyPrivatizable(ASTContext &Ctx, QualType Ty) {
+  return !Ty->isVariablyModifiedType() && Ty.isPODType(Ctx);
+}
+
+void CodeGenFunction::EmitOMPPrivateClauses(const OMPExecutableDirective &D) {
+  ArrayRef<OMPClause *> Clauses = D.clauses();
+  for (unsigned I = 0, N = Clauses.size(); I != N; ++I) {
+    const OMPClause *C = Clauses[I];
+    ArrayRef<const Expr *> Vars;
+    bool IsFirstprivate = false;
+    if (const OMPPrivateClause *PC = dyn_cast<OMPPrivateClause>(C)) {
+      Vars = PC->getVarRefs();
+    } else if (const OMPFirstprivateClause *FC =
+                 dyn_cast<OMPFirstprivateClause>(C)) {
+      Vars = FC->getVarRefs();
+      IsFirstprivate = true;
+    } else {
+      continue;
+    }
+
+    for (unsigned J = 0, M = Vars.size(); J != M; ++J) {
+      const DeclRefExpr *Ref = cast<DeclRefExpr>(Vars[J]);
+      const VarDecl *VD = cast<VarDecl>(Ref->getDecl());
+      QualType Ty = VD->getType();
+
+      // A local variable that isn't captured isn't used in the region.
+      if (!VD->hasGlobalStorage() && !CapturedStmtInfo->lookup(VD))
+        continue;
+
+      if (!isTriviallyPrivatizable(getContext(), Ty)) {
+        CGM.ErrorUnsupported(Ref, IsFirstprivate ?
+                                    "OpenMP firstprivate variable of this type" :
+                                    "OpenMP private variable of this type");
+        continue;
+      }
+
+      llvm::Value *Private =
+        CreateMemTemp(Ty, VD->getName() +
+                            (IsFirstprivate ? ".firstprivate" : ".private"));
+      if (IsFirstprivate) {
+        // Copy the value the variable has on entry to the region; the
+        // reference still resolves to the shared variable here.
+        LValue Src = EmitLValue(Ref);
+        LValue Dest = MakeNaturalAlignAddrLValue(Private, Ty);
+        switch (getEvaluationKind(Ty)) {
+        case TEK_Scalar:
+          EmitStoreOfScalar(EmitLoadOfScalar(Src, Ref->getExprLoc()), Dest,
+                            /*isInit=*/true);
+          break;
+        case TEK_Complex:
+          EmitStoreOfComplex(EmitLoadOfComplex(Src, Ref->getExprLoc()), Dest,
+                             /*isInit=*/true);
+          break;
+        case TEK_Aggregate:
+          EmitAggregateCopy(Private, Src.getAddress(), Ty);
+          break;
+        }
+      }
+
+      // From here on, the region refers to the private copy.
+      LocalDeclMap[VD] = Private;
+    }
+  }
+}
+
+void CodeGenFunction::EmitOMPParallelDirective(const OMPParallelDirective &S) {
+  const CapturedStmt &CS = *cast<CapturedStmt>(S.getAssociatedStmt());
+  LValue CapStruct = InitCapturedStruct(CS);
+
+  // Outline the region.
+  CodeGenFunction CGF(CGM, true);
+  CGOpenMPRegionInfo RegionInfo(S, CS);
+  CGF.CapturedStmtInfo = &RegionInfo;
+  llvm::Function *OutlinedFn =
+    CGF.GenerateCapturedStmtFunction(CS.getCapturedDecl(),
+                                     CS.getCapturedRecordDecl(),
+                                     S.getLocStart());
+
+  // Start the team; the runtime runs the region on the other threads, and
+  // this thread runs it as the master.
+  llvm::Type *MicrotaskPtrTy =
+    llvm::FunctionType::get(VoidTy, VoidPtrTy, /*isVarArg=*/false)
+      ->getPointerTo();
+  llvm::Value *StartArgs[] = {
+    Builder.CreateBitCast(OutlinedFn, MicrotaskPtrTy),
+    Builder.CreateBitCast(CapStruct.getAddress(), VoidPtrTy),
+    // Let the runtime pick the number of threads.
+    Builder.getInt32(0)
+  };
+  EmitRuntimeCall(getParallelStartFn(CGM), StartArgs);
+  EmitCallOrInvoke(OutlinedFn, CapStruct.getAddress());
+  EmitRuntimeCall(getParallelEndFn(CGM));
+}
@@ -78,6 +78,8 @@ public:
     return *cast<MicrosoftVTableContext>(VTContext.get());
   }
 
+  const VTableContextBase &getVTableContext() const { return *VTContext; }
+
   /// getSubVTTIndex - Return the index of the sub-VTT for the base class of the
   /// given record decl.
   uint64_t getSubVTTIndex(const CXXRecordDecl *RD, BaseSubobject Base);
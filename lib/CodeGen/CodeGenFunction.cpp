@@ -276,6 +276,10 @@ void CodeGenFunction::FinishFunction(SourceLocation EndLoc) {
 
   if (CGM.getCodeGenOpts().EmitDeclMetadata)
     EmitDeclMetadata();
+
+  CGM.addEHCleanupStats(CurFn, EHStats);
+  if (CGM.getLangOpts().ObjC1)
+    CGM.addObjCMessageSendStats(CurFn, ObjCStats);
 }
 
 /// ShouldInstrumentFunction - Return true if the current function should be
@@ -71,6 +71,8 @@ namespace clang {
   class ObjCAtThrowStmt;
   class ObjCAtSynchronizedStmt;
   class ObjCAutoreleasePoolStmt;
+  class OMPExecutableDirective;
+  class OMPParallelDirective;
 
 namespace CodeGen {
   class CodeGenTypes;
@@ -231,6 +233,9 @@ public:
   /// In ARC, whether we should autorelease the return value.
   bool AutoreleaseResult;
 
+  /// The Objective-C message sends emitted in this function.
+  ObjCMessageSendStats ObjCStats;
+
   const CodeGen::CGBlockInfo *BlockInfo;
   llvm::Value *BlockPointer;
 
@@ -242,6 +247,7 @@ public:
   llvm::DenseMap<const VarDecl *, llvm::Value *> NRVOFlags;
 
   EHScopeStack EHStack;
+  EHCleanupStats EHStats;
   llvm::SmallVector<char, 256> LifetimeExtendedCleanupStack;
 
   /// Header for data within LifetimeExtendedCleanupStack.
@@ -1330,6 +1336,12 @@ public:
   /// code.
   void EmitBranch(llvm::BasicBlock *Block);
 
+  /// EmitLoopBackEdge - Emit the branch from the latch of a loop back to its
+  /// header, as EmitBranch would, and attach the loop ID built from any
+  /// '#pragma clang loop' options in \p Attrs to it.
+  void EmitLoopBackEdge(llvm::BasicBlock *Header,
+                        ArrayRef<const Attr *> Attrs);
+
   /// HaveInsertPoint - True if an insertion point is defined. If not, this
   /// indicates that the current code being emitted is unreachable.
   bool HaveInsertPoint() const {
@@ -1838,9 +1850,10 @@ public:
   void EmitGotoStmt(const GotoStmt &S);
   void EmitIndirectGotoStmt(const IndirectGotoStmt &S);
   void EmitIfStmt(const IfStmt &S);
-  void EmitWhileStmt(const WhileStmt &S);
-  void EmitDoStmt(const DoStmt &S);
-  void EmitForStmt(const ForStmt &S);
+  void EmitWhileStmt(const WhileStmt &S,
+                     ArrayRef<const Attr *> Attrs = None);
+  void EmitDoStmt(const DoStmt &S, ArrayRef<const Attr *> Attrs = None);
+  void EmitForStmt(const ForStmt &S, ArrayRef<const Attr *> Attrs = None);
   void EmitReturnStmt(const ReturnStmt &S);
   void EmitDeclStmt(const DeclStmt &S);
   void EmitBreakStmt(const BreakStmt &S);
@@ -1864,12 +1877,22 @@ public:
 
   void EmitCXXTryStmt(const CXXTryStmt &S);
   void EmitSEHTryStmt(const SEHTryStmt &S);
-  void EmitCXXForRangeStmt(const CXXForRangeStmt &S);
+  void EmitCXXForRangeStmt(const CXXForRangeStmt &S,
+                           ArrayRef<const Attr *> Attrs = None);
 
   llvm::Function *EmitCapturedStmt(const CapturedStmt &S, CapturedRegionKind K);
   llvm::Function *GenerateCapturedStmtFunction(const CapturedDecl *CD,
                                                const RecordDecl *RD,
                                                SourceLocation Loc);
+  /// InitCapturedStruct - Allocate the record holding the variables captured
+  /// by \p S, and store their addresses into it.
+  LValue InitCapturedStruct(const CapturedStmt &S);
+
+  void EmitOMPParallelDirective(const OMPParallelDirective &S);
+  /// EmitOMPPrivateClauses - Emit the private copies of the variables listed
+  /// in the private and firstprivate clauses of \p D, in the function the
+  /// region of \p D was outlined into.
+  void EmitOMPPrivateClauses(const OMPExecutableDirective &D);
 
   //===--------------------------------------------------------------------===//
   //                         LValue Expression Emission
@@ -49,6 +49,7 @@
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace CodeGen;
@@ -86,7 +87,8 @@ CodeGenModule::CodeGenModule(ASTContext &C, const CodeGenOptions &CGO,
       SanitizerBlacklist(
           llvm::SpecialCaseList::createOrDie(CGO.SanitizerBlacklistFile)),
       SanOpts(SanitizerBlacklist->isIn(M) ? SanitizerOptions::Disabled
-                                          : LangOpts.Sanitize) {
+                                          : LangOpts.Sanitize),
+      MaxLandingPads(0), MaxMessageSends(0) {
 
   // Initialize the type cache.
   llvm::LLVMContext &LLVMContext = M.getContext();
@@ -288,6 +290,57 @@ void CodeGenModule::Release() {
   EmitVersionIdentMetadata();
 }
 
+void CodeGenModule::PrintStats() const {
+  llvm::errs() << "\n*** IR Generation Stats:\n";
+  llvm::errs() << "  " << MangledDeclNames.size()
+               << " declaration names mangled and cached in "
+               << MangledNamesAllocator.getTotalMemory() << " bytes\n";
+  getCXXABI().getMangleContext().PrintStats();
+  if (Context.getLangOpts().CPlusPlus)
+    VTables.getVTableContext().PrintStats();
+  if (TBAA)
+    TBAA->PrintStats();
+
+  if (Context.getLangOpts().Exceptions) {
+    llvm::errs() << "  " << EHStats.NumCleanups << " cleanup scopes, "
+                 << EHStats.NumEHCleanups << " EH cleanup blocks emitted, "
+                 << EHStats.NumEHCleanupsSkipped
+                 << " skipped as inactive\n";
+    llvm::errs() << "  " << EHStats.NumLandingPads << " landing pads emitted, "
+                 << EHStats.NumLandingPadsShared << " shared between invokes\n";
+    if (MaxLandingPads)
+      llvm::errs() << "  " << MaxLandingPads << " landing pads in '"
+                   << MaxLandingPadsFn << "', the most of any function\n";
+  }
+
+  if (Context.getLangOpts().ObjC1) {
+    llvm::errs() << "  " << ObjCStats.NumMessageSends
+                 << " messages sent through the runtime, "
+                 << ObjCStats.NumDirectCalls << " dispatched directly\n";
+    if (MaxMessageSends)
+      llvm::errs() << "  " << MaxMessageSends << " message sends in '"
+                   << MaxMessageSendsFn << "', the most of any function\n";
+  }
+}
+
+void CodeGenModule::addEHCleanupStats(const llvm::Function *Fn,
+                                      const EHCleanupStats &Stats) {
+  EHStats.add(Stats);
+  if (Stats.NumLandingPads > MaxLandingPads) {
+    MaxLandingPads = Stats.NumLandingPads;
+    MaxLandingPadsFn = Fn->getName();
+  }
+}
+
+void CodeGenModule::addObjCMessageSendStats(const llvm::Function *Fn,
+                                            const ObjCMessageSendStats &Stats) {
+  ObjCStats.add(Stats);
+  if (Stats.NumMessageSends > MaxMessageSends) {
+    MaxMessageSends = Stats.NumMessageSends;
+    MaxMessageSendsFn = Fn->getName();
+  }
+}
+
 void CodeGenModule::UpdateCompletedType(const TagDecl *TD) {
   // Make sure that this type is translated.
   Types.UpdateCompletedType(TD);
@@ -333,10 +386,10 @@ void CodeGenModule::DecorateInstruction(llvm::Instruction *Inst,
                                         llvm::MDNode *TBAAInfo,
                                         bool ConvertTypeToTag) {
   if (ConvertTypeToTag && TBAA)
-    Inst->setMetadata(llvm::LLVMContext::MD_tbaa,
-                      TBAA->getTBAAScalarTagInfo(TBAAInfo));
-  else
-    Inst->setMetadata(llvm::LLVMContext::MD_tbaa, TBAAInfo);
+    TBAAInfo = TBAA->getTBAAScalarTagInfo(TBAAInfo);
+  if (TBAA)
+    TBAA->noteTaggedAccess(TBAAInfo);
+  Inst->setMetadata(llvm::LLVMContext::MD_tbaa, TBAAInfo);
 }
 
 void CodeGenModule::Error(SourceLocation loc, StringRef message) {
@@ -222,6 +222,56 @@ struct ARCEntrypoints {
   llvm::Constant *clang_arc_use;
 };
 
+/// EHCleanupStats - Counts of the exception handling code emitted for
+/// cleanups, in one function or in the whole module.
+struct EHCleanupStats {
+  EHCleanupStats()
+    : NumCleanups(0), NumEHCleanups(0), NumEHCleanupsSkipped(0),
+      NumLandingPads(0), NumLandingPadsShared(0) {}
+
+  /// The number of cleanup scopes popped.
+  unsigned NumCleanups;
+
+  /// The number of EH cleanup blocks emitted.
+  unsigned NumEHCleanups;
+
+  /// The number of EH cleanups that had nothing to do when unwinding, whose
+  /// users were sent straight to the enclosing EH scope instead.
+  unsigned NumEHCleanupsSkipped;
+
+  /// The number of landing pads emitted.
+  unsigned NumLandingPads;
+
+  /// The number of invokes that reused an existing landing pad.
+  unsigned NumLandingPadsShared;
+
+  void add(const EHCleanupStats &Other) {
+    NumCleanups += Other.NumCleanups;
+    NumEHCleanups += Other.NumEHCleanups;
+    NumEHCleanupsSkipped += Other.NumEHCleanupsSkipped;
+    NumLandingPads += Other.NumLandingPads;
+    NumLandingPadsShared += Other.NumLandingPadsShared;
+  }
+};
+
+/// ObjCMessageSendStats - Counts of the Objective-C message sends emitted,
+/// in one function or in the whole module.
+struct ObjCMessageSendStats {
+  ObjCMessageSendStats() : NumMessageSends(0), NumDirectCalls(0) {}
+
+  /// The number of messages sent through the runtime.
+  unsigned NumMessageSends;
+
+  /// The number of messages turned into direct calls to the method
+  /// implementation under -fobjc-direct-dispatch.
+  unsigned NumDirectCalls;
+
+  void add(const ObjCMessageSendStats &Other) {
+    NumMessageSends += Other.NumMessageSends;
+    NumDirectCalls += Other.NumDirectCalls;
+  }
+};
+
 /// CodeGenModule - This class organizes the cross-function state that is used
 /// while generating LLVM code.
 class CodeGenModule : public CodeGenTypeCache {
@@ -435,6 +485,20 @@ class CodeGenModule : public CodeGenTypeCache {
 
   const SanitizerOptions &SanOpts;
 
+  /// EHStats - The EH cleanup statistics of all the functions emitted.
+  EHCleanupStats EHStats;
+
+  /// The function with the most landing pads, and their number.
+  std::string MaxLandingPadsFn;
+  unsigned MaxLandingPads;
+
+  /// ObjCStats - The message send statistics of all the functions emitted.
+  ObjCMessageSendStats ObjCStats;
+
+  /// The function with the most message sends, and their number.
+  std::string MaxMessageSendsFn;
+  unsigned MaxMessageSends;
+
   /// @}
 public:
   CodeGenModule(ASTContext &C, const CodeGenOptions &CodeGenOpts,
@@ -448,6 +512,26 @@ public:
   /// Release - Finalize LLVM code generation.
   void Release();
 
+  /// PrintStats - Print statistics about IR generation.
+  void PrintStats() const;
+
+  /// revertObjCDirectCalls - Note that \p NumCalls direct method calls were
+  /// turned back into message sends at the end of the translation unit.
+  void revertObjCDirectCalls(unsigned NumCalls) {
+    ObjCStats.NumDirectCalls -= NumCalls;
+    ObjCStats.NumMessageSends += NumCalls;
+  }
+
+  /// addEHCleanupStats - Add the EH cleanup statistics of the function
+  /// \p Fn, which was just emitted, to those of the module.
+  void addEHCleanupStats(const llvm::Function *Fn,
+                         const EHCleanupStats &Stats);
+
+  /// addObjCMessageSendStats - Add the message send statistics of the
+  /// function \p Fn, which was just emitted, to those of the module.
+  void addObjCMessageSendStats(const llvm::Function *Fn,
+                               const ObjCMessageSendStats &Stats);
+
   /// getObjCRuntime() - Return a reference to the configured
   /// Objective-C runtime.
   CGObjCRuntime &getObjCRuntime() {
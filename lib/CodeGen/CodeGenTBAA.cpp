@@ -18,6 +18,7 @@
 #include "CodeGenTBAA.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Attr.h"
+#include "clang/AST/DeclCXX.h"
 #include "clang/AST/Mangle.h"
 #include "clang/AST/RecordLayout.h"
 #include "clang/Frontend/CodeGenOptions.h"
@@ -26,6 +27,8 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Type.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 using namespace clang;
 using namespace CodeGen;
 
@@ -33,7 +36,8 @@ CodeGenTBAA::CodeGenTBAA(ASTContext &Ctx, llvm::LLVMContext& VMContext,
                          const CodeGenOptions &CGO,
                          const LangOptions &Features, MangleContext &MContext)
   : Context(Ctx), CodeGenOpts(CGO), Features(Features), MContext(MContext),
-    MDHelper(VMContext), Root(0), Char(0) {
+    MDHelper(VMContext), Root(0), Char(0), NumTaggedAccesses(0),
+    NumCharAccesses(0), NumPathAccesses(0) {
 }
 
 CodeGenTBAA::~CodeGenTBAA() {
@@ -145,12 +149,21 @@ CodeGenTBAA::getTBAAInfo(QualType QTy) {
   // Enum types are distinct types. In C++ they have "underlying types",
   // however they aren't related for TBAA.
   if (const EnumType *ETy = dyn_cast<EnumType>(Ty)) {
-    // In C++ mode, types have linkage, so we can rely on the ODR and
-    // on their mangled names, if they're external.
+    // In C, an enum is compatible with its integer type, so it aliases
+    // exactly what that type does.  In C++, an enum we can't name uniquely
+    // across the program is treated the same way, which is conservative
+    // but still better than letting it alias anything.
     // TODO: Is there a way to get a program-wide unique name for a
     // decl with local linkage or no linkage?
-    if (!Features.CPlusPlus || !ETy->getDecl()->isExternallyVisible())
-      return MetadataCache[Ty] = getChar();
+    if (!Features.CPlusPlus || !ETy->getDecl()->isExternallyVisible()) {
+      QualType IntTy = ETy->getDecl()->getIntegerType();
+      if (IntTy.isNull())
+        return MetadataCache[Ty] = getChar();
+      return MetadataCache[Ty] = getTBAAInfo(IntTy);
+    }
+
+    // In C++ mode, types have linkage, so we can rely on the ODR and
+    // on their mangled names, if they're external.
 
     SmallString<256> OutName;
     llvm::raw_svector_ostream Out(OutName);
@@ -173,20 +186,33 @@ CodeGenTBAA::CollectFields(uint64_t BaseOffset,
                            SmallVectorImpl<llvm::MDBuilder::TBAAStructField> &
                              Fields,
                            bool MayAlias) {
-  /* Things not handled yet include: C++ base classes, bitfields, */
+  /* Things not handled yet include: virtual bases, bitfields, */
 
   if (const RecordType *TTy = QTy->getAs<RecordType>()) {
     const RecordDecl *RD = TTy->getDecl()->getDefinition();
     if (RD->hasFlexibleArrayMember())
       return false;
 
-    // TODO: Handle C++ base classes.
-    if (const CXXRecordDecl *Decl = dyn_cast<CXXRecordDecl>(RD))
-      if (Decl->bases_begin() != Decl->bases_end())
-        return false;
-
     const ASTRecordLayout &Layout = Context.getASTRecordLayout(RD);
 
+    // Non-virtual bases are copied like the fields they contain.  Classes
+    // with a vtable pointer or virtual bases are left alone.
+    if (const CXXRecordDecl *Decl = dyn_cast<CXXRecordDecl>(RD)) {
+      if (Decl->isDynamicClass())
+        return false;
+      for (CXXRecordDecl::base_class_const_iterator i = Decl->bases_begin(),
+           e = Decl->bases_end(); i != e; ++i) {
+        const CXXRecordDecl *Base = i->getType()->getAsCXXRecordDecl();
+        if (Base->isEmpty())
+          continue;
+        uint64_t Offset = BaseOffset +
+                          Layout.getBaseClassOffset(Base).getQuantity();
+        if (!CollectFields(Offset, i->getType(), Fields,
+                           MayAlias || TypeHasMayAlias(i->getType())))
+          return false;
+      }
+    }
+
     unsigned idx = 0;
     for (RecordDecl::field_iterator i = RD->field_begin(),
          e = RD->field_end(); i != e; ++i, ++idx) {
@@ -238,6 +264,11 @@ static bool isTBAAPathStruct(QualType QTy) {
   return false;
 }
 
+static bool compareFieldOffsets(const std::pair<llvm::MDNode*, uint64_t> &LHS,
+                                const std::pair<llvm::MDNode*, uint64_t> &RHS) {
+  return LHS.second < RHS.second;
+}
+
 llvm::MDNode *
 CodeGenTBAA::getTBAAStructTypeInfo(QualType QTy) {
   const Type *Ty = Context.getCanonicalType(QTy).getTypePtr();
@@ -251,6 +282,28 @@ CodeGenTBAA::getTBAAStructTypeInfo(QualType QTy) {
 
     const ASTRecordLayout &Layout = Context.getASTRecordLayout(RD);
     SmallVector <std::pair<llvm::MDNode*, uint64_t>, 4> Fields;
+
+    // Non-virtual bases are described like fields, so that accesses to
+    // their members through the derived class keep the derived class in
+    // their path.  Empty bases have nothing to access.
+    if (const CXXRecordDecl *Decl = dyn_cast<CXXRecordDecl>(RD)) {
+      for (CXXRecordDecl::base_class_const_iterator i = Decl->bases_begin(),
+           e = Decl->bases_end(); i != e; ++i) {
+        if (i->isVirtual())
+          continue;
+        const CXXRecordDecl *Base = i->getType()->getAsCXXRecordDecl();
+        if (Base->isEmpty())
+          continue;
+        if (!isTBAAPathStruct(i->getType()))
+          return StructTypeMetadataCache[Ty] = NULL;
+        llvm::MDNode *BaseNode = getTBAAStructTypeInfo(i->getType());
+        if (!BaseNode)
+          return StructTypeMetadataCache[Ty] = NULL;
+        Fields.push_back(std::make_pair(
+            BaseNode, uint64_t(Layout.getBaseClassOffset(Base).getQuantity())));
+      }
+    }
+
     unsigned idx = 0;
     for (RecordDecl::field_iterator i = RD->field_begin(),
          e = RD->field_end(); i != e; ++i, ++idx) {
@@ -266,6 +319,10 @@ CodeGenTBAA::getTBAAStructTypeInfo(QualType QTy) {
           FieldNode, Layout.getFieldOffset(idx) / Context.getCharWidth()));
     }
 
+    // The optimizer finds the member at an offset by walking the fields in
+    // order, and bases aren't necessarily laid out in declaration order.
+    std::stable_sort(Fields.begin(), Fields.end(), compareFieldOffsets);
+
     SmallString<256> OutName;
     if (Features.CPlusPlus) {
       // Don't use the mangler for C code.
@@ -319,3 +376,28 @@ CodeGenTBAA::getTBAAScalarTagInfo(llvm::MDNode *AccessNode) {
   return ScalarTagMetadataCache[AccessNode] =
     MDHelper.createTBAAStructTagNode(AccessNode, AccessNode, 0);
 }
+
+void CodeGenTBAA::noteTaggedAccess(const llvm::MDNode *Tag) {
+  ++NumTaggedAccesses;
+  if (!Tag)
+    return;
+
+  // Under -no-struct-path-tbaa most accesses are tagged with a scalar type
+  // node {name, parent}, which is its own access type.  Struct-path tags
+  // {base type, access type, offset} start with a node instead of a name;
+  // this is how the optimizer tells the two apart as well.
+  const llvm::Value *AccessNode = Tag;
+  if (Tag->getNumOperands() >= 3 && isa<llvm::MDNode>(Tag->getOperand(0))) {
+    AccessNode = Tag->getOperand(1);
+    if (Tag->getOperand(0) != AccessNode)
+      ++NumPathAccesses;
+  }
+  if (AccessNode == Char)
+    ++NumCharAccesses;
+}
+
+void CodeGenTBAA::PrintStats() const {
+  llvm::errs() << "  " << NumTaggedAccesses << " loads and stores with TBAA "
+               << "tags, " << NumPathAccesses << " through an aggregate, "
+               << NumCharAccesses << " conservatively tagged as char\n";
+}
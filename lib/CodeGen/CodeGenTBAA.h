@@ -71,6 +71,15 @@ class CodeGenTBAA {
   llvm::MDNode *Root;
   llvm::MDNode *Char;
 
+  /// The number of loads and stores given a TBAA tag.
+  unsigned NumTaggedAccesses;
+  /// The number of tagged loads and stores whose access type is "omnipotent
+  /// char", and so may alias anything.
+  unsigned NumCharAccesses;
+  /// The number of tagged loads and stores whose tag describes a path
+  /// through an aggregate.
+  unsigned NumPathAccesses;
+
   /// getRoot - This is the mdnode for the root of the metadata type graph
   /// for this translation unit.
   llvm::MDNode *getRoot();
@@ -119,6 +128,12 @@ public:
 
   /// Get the scalar tag MDNode for a given scalar type.
   llvm::MDNode *getTBAAScalarTagInfo(llvm::MDNode *AccessNode);
+
+  /// Record that a load or store was given the tag \p Tag, for statistics.
+  void noteTaggedAccess(const llvm::MDNode *Tag);
+
+  /// Print statistics about the TBAA tags given to loads and stores.
+  void PrintStats() const;
 };
 
 }  // end namespace CodeGen
@@ -127,6 +127,11 @@ namespace {
         Builder->Release();
     }
 
+    virtual void PrintStats() {
+      if (Builder)
+        Builder->PrintStats();
+    }
+
     virtual void CompleteTentativeDefinition(VarDecl *D) {
       if (Diags.hasErrorOccurred())
         return;
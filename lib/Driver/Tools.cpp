@@ -2959,6 +2959,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   // Forward -f (flag) options which we can pass directly.
   Args.AddLastArg(CmdArgs, options::OPT_femit_all_decls);
   Args.AddLastArg(CmdArgs, options::OPT_fheinous_gnu_extensions);
+  Args.AddLastArg(CmdArgs, options::OPT_fheader_token_cache_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fprefetch_includes_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_fstandalone_debug);
   Args.AddLastArg(CmdArgs, options::OPT_fno_standalone_debug);
   Args.AddLastArg(CmdArgs, options::OPT_fno_operator_names);
@@ -2967,6 +2969,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       Output.getType() != types::TY_PP_Asm)
     Args.AddLastArg(CmdArgs, options::OPT_faltivec);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_show_template_tree);
+  Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_buffered);
   Args.AddLastArg(CmdArgs, options::OPT_fno_elide_type);
 
   const SanitizerArgs &Sanitize = getToolChain().getSanitizerArgs();
@@ -3195,6 +3198,14 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back("-fmodules-decluse");
   }
 
+  // -fmodules-cache-module-maps keeps an index of module map locations in the
+  // module cache (off by default).
+  if (Args.hasFlag(options::OPT_fmodules_cache_module_maps,
+                   options::OPT_fno_modules_cache_module_maps,
+                   false)) {
+    CmdArgs.push_back("-fmodules-cache-module-maps");
+  }
+
   // -fmodule-name specifies the module that is currently being built (or
   // used for header checking by -fmodule-maps).
   if (Arg *A = Args.getLastArg(options::OPT_fmodule_name)) {
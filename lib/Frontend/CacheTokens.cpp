@@ -19,6 +19,7 @@
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/OnDiskHashTable.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Lex/HeaderTokenCache.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/ADT/StringExtras.h"
@@ -59,20 +60,24 @@ class PTHEntryKeyVariant {
   union { const FileEntry* FE; const char* Path; };
   enum { IsFE = 0x1, IsDE = 0x2, IsNoExist = 0x0 } Kind;
   FileData *Data;
+  const char *FileName;
 
 public:
-  PTHEntryKeyVariant(const FileEntry *fe) : FE(fe), Kind(IsFE), Data(0) {}
+  PTHEntryKeyVariant(const FileEntry *fe, const char *FileName = 0)
+      : FE(fe), Kind(IsFE), Data(0), FileName(FileName) {}
 
   PTHEntryKeyVariant(FileData *Data, const char *path)
-      : Path(path), Kind(IsDE), Data(new FileData(*Data)) {}
+      : Path(path), Kind(IsDE), Data(new FileData(*Data)), FileName(0) {}
 
   explicit PTHEntryKeyVariant(const char *path)
-      : Path(path), Kind(IsNoExist), Data(0) {}
+      : Path(path), Kind(IsNoExist), Data(0), FileName(0) {}
 
   bool isFile() const { return Kind == IsFE; }
 
   StringRef getString() const {
-    return Kind == IsFE ? FE->getName() : Path;
+    if (Kind != IsFE)
+      return Path;
+    return FileName ? FileName : FE->getName();
   }
 
   unsigned getKind() const { return (unsigned) Kind; }
@@ -180,6 +185,9 @@ class PTHWriter {
   Offset CurStrOffset;
   std::vector<llvm::StringMapEntry<OffsetOpt>*> StrEntries;
 
+  /// Set when a file with unbalanced conditionals was lexed.
+  bool UnbalancedConditionals;
+
   //// Get the persistent id for the given IdentifierInfo*.
   uint32_t ResolveID(const IdentifierInfo* II);
 
@@ -214,12 +222,23 @@ class PTHWriter {
   PTHEntry LexTokens(Lexer& L);
   Offset EmitCachedSpellings();
 
+  /// EmitPrologue - Emit the PTH header, with room for the table offsets
+  ///  that are filled in by EmitTables.
+  Offset EmitPrologue(const std::string &MainFile);
+  void EmitTables(Offset PrologueOffset);
+
 public:
   PTHWriter(llvm::raw_fd_ostream& out, Preprocessor& pp)
-    : Out(out), PP(pp), idcount(0), CurStrOffset(0) {}
+    : Out(out), PP(pp), idcount(0), CurStrOffset(0),
+      UnbalancedConditionals(false) {}
 
   PTHMap &getPM() { return PM; }
   void GeneratePTH(const std::string &MainFile);
+
+  /// GenerateHeaderPTH - Write an entry of a per-header token cache, holding
+  ///  the tokens of the single file \p FID.  Returns false if the file can't
+  ///  be cached.
+  bool GenerateHeaderPTH(FileID FID);
 };
 } // end anonymous namespace
 
@@ -366,12 +385,15 @@ PTHEntry PTHWriter::LexTokens(Lexer& L) {
         break;
       }
       case tok::pp_endif: {
+        if (PPStartCond.empty()) {
+          UnbalancedConditionals = true;
+          break;
+        }
         // Add an entry for '#endif'.  We set the target table index to itself.
         // This will later be set to zero when emitting to the PTH file.  We
         // use 0 for uninitialized indices because that is easier to debug.
         unsigned index = PPCond.size();
         // Backpatch the opening '#if' entry.
-        assert(!PPStartCond.empty());
         assert(PPCond.size() > PPStartCond.back());
         assert(PPCond[PPStartCond.back()].second == 0);
         PPCond[PPStartCond.back()].second = index;
@@ -391,12 +413,15 @@ PTHEntry PTHWriter::LexTokens(Lexer& L) {
       }
       case tok::pp_elif:
       case tok::pp_else: {
+        if (PPStartCond.empty()) {
+          UnbalancedConditionals = true;
+          break;
+        }
         // Add an entry for #elif or #else.
         // This serves as both a closing and opening of a conditional block.
         // This means that its entry will get backpatched later.
         unsigned index = PPCond.size();
         // Backpatch the previous '#if' entry.
-        assert(!PPStartCond.empty());
         assert(PPCond.size() > PPStartCond.back());
         assert(PPCond[PPStartCond.back()].second == 0);
         PPCond[PPStartCond.back()].second = index;
@@ -413,7 +438,8 @@ PTHEntry PTHWriter::LexTokens(Lexer& L) {
   }
   while (Tok.isNot(tok::eof));
 
-  assert(PPStartCond.empty() && "Error: imblanced preprocessor conditionals.");
+  if (!PPStartCond.empty())
+    UnbalancedConditionals = true;
 
   // Next write out PPCond.
   Offset PPCondOff = (Offset) Out.tell();
@@ -424,7 +450,8 @@ PTHEntry PTHWriter::LexTokens(Lexer& L) {
   for (unsigned i = 0, e = PPCond.size(); i!=e; ++i) {
     Emit32(PPCond[i].first - TokenOff);
     uint32_t x = PPCond[i].second;
-    assert(x != 0 && "PPCond entry not backpatched.");
+    assert((x != 0 || UnbalancedConditionals) &&
+           "PPCond entry not backpatched.");
     // Emit zero for #endifs.  This allows us to do checking when
     // we read the PTH file back in.
     Emit32(x == i ? 0 : x);
@@ -444,7 +471,7 @@ Offset PTHWriter::EmitCachedSpellings() {
   return SpellingsOff;
 }
 
-void PTHWriter::GeneratePTH(const std::string &MainFile) {
+Offset PTHWriter::EmitPrologue(const std::string &MainFile) {
   // Generate the prologue.
   Out << "cfe-pth" << '\0';
   Emit32(PTHManager::Version);
@@ -463,6 +490,30 @@ void PTHWriter::GeneratePTH(const std::string &MainFile) {
   }
   Emit8(0);
 
+  return PrologueOffset;
+}
+
+void PTHWriter::EmitTables(Offset PrologueOffset) {
+  // Write out the identifier table.
+  const std::pair<Offset,Offset> &IdTableOff = EmitIdentifierTable();
+
+  // Write out the cached strings table.
+  Offset SpellingOff = EmitCachedSpellings();
+
+  // Write out the file table.
+  Offset FileTableOff = EmitFileTable();
+
+  // Finally, write the prologue.
+  Out.seek(PrologueOffset);
+  Emit32(IdTableOff.first);
+  Emit32(IdTableOff.second);
+  Emit32(FileTableOff);
+  Emit32(SpellingOff);
+}
+
+void PTHWriter::GeneratePTH(const std::string &MainFile) {
+  Offset PrologueOffset = EmitPrologue(MainFile);
+
   // Iterate over all the files in SourceManager.  Create a lexer
   // for each file and cache the tokens.
   SourceManager &SM = PP.getSourceManager();
@@ -484,23 +535,33 @@ void PTHWriter::GeneratePTH(const std::string &MainFile) {
     const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
     Lexer L(FID, FromFile, SM, LOpts);
     PM.insert(FE, LexTokens(L));
+    assert(!UnbalancedConditionals &&
+           "Error: imblanced preprocessor conditionals.");
   }
 
-  // Write out the identifier table.
-  const std::pair<Offset,Offset> &IdTableOff = EmitIdentifierTable();
-
-  // Write out the cached strings table.
-  Offset SpellingOff = EmitCachedSpellings();
-
-  // Write out the file table.
-  Offset FileTableOff = EmitFileTable();
+  EmitTables(PrologueOffset);
+}
 
-  // Finally, write the prologue.
-  Out.seek(PrologueOffset);
-  Emit32(IdTableOff.first);
-  Emit32(IdTableOff.second);
-  Emit32(FileTableOff);
-  Emit32(SpellingOff);
+bool PTHWriter::GenerateHeaderPTH(FileID FID) {
+  SourceManager &SM = PP.getSourceManager();
+  const FileEntry *FE = SM.getFileEntryForID(FID);
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Buffer = SM.getBuffer(FID, &Invalid);
+  if (!FE || Invalid)
+    return false;
+
+  Offset PrologueOffset = EmitPrologue(std::string());
+
+  // The file is recorded under a fixed name so that the entry is found
+  // whatever path the header is included by.
+  Lexer L(FID, Buffer, SM, PP.getLangOpts());
+  PM.insert(PTHEntryKeyVariant(FE, PTHManager::HeaderCacheFileName),
+            LexTokens(L));
+  if (UnbalancedConditionals)
+    return false;
+
+  EmitTables(PrologueOffset);
+  return true;
 }
 
 namespace {
@@ -561,6 +622,47 @@ void clang::CacheTokens(Preprocessor &PP, llvm::raw_fd_ostream* OS) {
   PW.GeneratePTH(MainFilePath.str());
 }
 
+void clang::CacheHeaderTokens(Preprocessor &PP) {
+  HeaderTokenCache *Cache = PP.getHeaderTokenCache();
+  if (!Cache || Cache->getMisses().empty())
+    return;
+
+  // A cache that can't be written to is not worth a diagnostic; the headers
+  // are simply lexed again next time.
+  if (llvm::sys::fs::create_directories(Cache->getDirectory()))
+    return;
+
+  SourceManager &SM = PP.getSourceManager();
+  ArrayRef<FileID> Misses = Cache->getMisses();
+  for (unsigned I = 0, N = Misses.size(); I != N; ++I) {
+    const FileEntry *File = SM.getFileEntryForID(Misses[I]);
+    if (!Cache->isCacheable(File))
+      continue;
+    std::string CacheFile = Cache->getCacheFileName(File);
+
+    // Write to a temporary file and rename it into place, so that concurrent
+    // compilations never see a partial entry.
+    SmallString<128> TempPath(CacheFile);
+    TempPath += "-%%%%%%%%";
+    int FD;
+    if (llvm::sys::fs::createUniqueFile(TempPath.str(), FD, TempPath))
+      continue;
+
+    bool Written;
+    {
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      PTHWriter PW(OS, PP);
+      Written = PW.GenerateHeaderPTH(Misses[I]);
+      OS.close();
+      Written = Written && !OS.has_error();
+      OS.clear_error();
+    }
+
+    if (!Written || llvm::sys::fs::rename(TempPath.str(), CacheFile))
+      llvm::sys::fs::remove(TempPath.str());
+  }
+}
+
 //===----------------------------------------------------------------------===//
 
 namespace {
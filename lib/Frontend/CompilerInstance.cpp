@@ -26,7 +26,9 @@
 #include "clang/Frontend/Utils.h"
 #include "clang/Frontend/VerifyDiagnosticConsumer.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderTokenCache.h"
 #include "clang/Lex/PTHManager.h"
+#include "clang/Lex/PreprocessingRecord.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
 #include "clang/Sema/Sema.h"
@@ -235,9 +237,23 @@ void CompilerInstance::createPreprocessor() {
     PP->setPTHManager(PTHMgr);
   }
 
-  if (PPOpts.DetailedRecord)
+  if (!PPOpts.HeaderTokenCache.empty())
+    PP->setHeaderTokenCache(new HeaderTokenCache(PPOpts.HeaderTokenCache,
+                                                 getLangOpts()));
+
+  if (PPOpts.DetailedRecord) {
     PP->createPreprocessingRecord();
 
+    if (PPOpts.DetailedRecordMainFileOnly) {
+      SmallVector<const FileEntry *, 4> Files;
+      for (unsigned I = 0, N = PPOpts.DetailedRecordFiles.size(); I != N; ++I)
+        if (const FileEntry *File =
+                getFileManager().getFile(PPOpts.DetailedRecordFiles[I]))
+          Files.push_back(File);
+      PP->getPreprocessingRecord()->restrictToFiles(Files);
+    }
+  }
+
   InitializePreprocessor(*PP, PPOpts, getHeaderSearchOpts(), getFrontendOpts());
 
   PP->setPreprocessedOutput(getPreprocessorOutputOpts().ShowCPP);
@@ -258,6 +274,8 @@ void CompilerInstance::createPreprocessor() {
   if (!DepOpts.DOTOutputFile.empty())
     AttachDependencyGraphGen(*PP, DepOpts.DOTOutputFile,
                              getHeaderSearchOpts().Sysroot);
+  if (!DepOpts.HeaderCostReportFile.empty())
+    AttachHeaderCostReport(*PP, DepOpts.HeaderCostReportFile);
 
 
   // Handle generating header include information, if requested.
@@ -1058,9 +1076,10 @@ static void pruneModuleCache(const HeaderSearchOptions &HSOpts) {
     bool RemovedAllFiles = true;
     for (llvm::sys::fs::directory_iterator File(Dir->path(), EC), FileEnd;
          File != FileEnd && !EC; File.increment(EC)) {
-      // We only care about module and global module index files.
+      // We only care about module files and the module indices.
       if (llvm::sys::path::extension(File->path()) != ".pcm" &&
-          llvm::sys::path::filename(File->path()) != "modules.idx") {
+          llvm::sys::path::filename(File->path()) != "modules.idx" &&
+          llvm::sys::path::filename(File->path()) != "modulemaps.idx") {
         RemovedAllFiles = false;
         continue;
       }
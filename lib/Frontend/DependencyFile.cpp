@@ -42,6 +42,7 @@ private:
   bool FileMatchesDepCriteria(const char *Filename,
                               SrcMgr::CharacteristicKind FileType);
   void AddFilename(StringRef Filename);
+  void AddFileEntry(const FileEntry *FE, SrcMgr::CharacteristicKind FileType);
   void OutputDependencyFile();
 
 public:
@@ -65,6 +66,7 @@ public:
                                   StringRef SearchPath,
                                   StringRef RelativePath,
                                   const Module *Imported);
+  virtual void FileEmbedded(SourceLocation Loc, const FileEntry &File);
 
   virtual void EndOfMainFile() {
     OutputDependencyFile();
@@ -115,6 +117,18 @@ void DependencyFileCallback::FileChanged(SourceLocation Loc,
     SM.getFileEntryForID(SM.getFileID(SM.getExpansionLoc(Loc)));
   if (FE == 0) return;
 
+  AddFileEntry(FE, FileType);
+}
+
+void DependencyFileCallback::FileEmbedded(SourceLocation Loc,
+                                          const FileEntry &File) {
+  // Embedded files are looked up like quoted includes, so treat them as user
+  // files.
+  AddFileEntry(&File, SrcMgr::C_User);
+}
+
+void DependencyFileCallback::AddFileEntry(const FileEntry *FE,
+                                          SrcMgr::CharacteristicKind FileType) {
   StringRef Filename = FE->getName();
   if (!FileMatchesDepCriteria(Filename.data(), FileType))
     return;
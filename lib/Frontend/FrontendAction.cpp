@@ -418,9 +418,17 @@ void FrontendAction::EndSourceFile() {
   }
 
   // Inform the preprocessor we are done.
-  if (CI.hasPreprocessor())
+  if (CI.hasPreprocessor()) {
     CI.getPreprocessor().EndSourceFile();
 
+    // Add the headers that missed to the header token cache, and remember
+    // where module maps were found.
+    if (!CI.getDiagnostics().hasFatalErrorOccurred()) {
+      CacheHeaderTokens(CI.getPreprocessor());
+      CI.getPreprocessor().getHeaderSearchInfo().writeModuleMapIndex();
+    }
+  }
+
   if (CI.getFrontendOpts().ShowStats) {
     llvm::errs() << "\nSTATISTICS FOR '" << getCurrentFile() << "':\n";
     CI.getPreprocessor().PrintStats();
@@ -0,0 +1,208 @@
+//===--- HeaderCostReport.cpp - Report preprocessing cost per header ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This code writes a report of how much work each file in a translation unit
+// causes: how often it was entered or skipped, the tokens and macros it
+// produced, and the time spent preprocessing it and parsing its tokens.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace clang;
+using llvm::sys::TimeValue;
+
+namespace {
+/// \brief The cost of one file, summed over all of its inclusions.
+struct HeaderCost {
+  unsigned NumEntered;
+  unsigned NumSkipped;
+  unsigned NumTokens;
+  unsigned NumMacros;
+  /// \brief Microseconds spent in the preprocessor while in this file.
+  uint64_t PPTime;
+  /// \brief Microseconds spent by the client of the preprocessor (the
+  /// parser and Sema) between tokens of this file.
+  uint64_t ParseTime;
+  /// \brief Microseconds from entering this file to leaving it, including
+  /// everything it includes.
+  uint64_t InclusiveTime;
+
+  HeaderCost()
+    : NumEntered(0), NumSkipped(0), NumTokens(0), NumMacros(0), PPTime(0),
+      ParseTime(0), InclusiveTime(0) { }
+};
+
+typedef llvm::StringMapEntry<HeaderCost> HeaderCostEntry;
+
+class HeaderCostReportCallback : public PPCallbacks, public PPTokenObserver {
+  Preprocessor &PP;
+  std::string OutputFile;
+  llvm::StringMap<HeaderCost> Costs;
+
+  /// \brief The files being preprocessed, innermost last, along with the
+  /// time each was entered.
+  SmallVector<std::pair<HeaderCost *, TimeValue>, 16> IncludeStack;
+
+  /// \brief When the time up to now was last charged to a file.
+  TimeValue LastCharged;
+
+  /// \brief Whether we are inside Preprocessor::Lex().
+  bool InLex;
+
+  /// \brief Charge the time since the last event to the current file.
+  TimeValue chargeElapsedTime();
+  void OutputReport();
+
+public:
+  HeaderCostReportCallback(Preprocessor &PP, StringRef OutputFile)
+    : PP(PP), OutputFile(OutputFile.str()), LastCharged(TimeValue::now()),
+      InLex(false) { }
+
+  virtual void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                           SrcMgr::CharacteristicKind FileType,
+                           FileID PrevFID);
+  virtual void FileSkipped(const FileEntry &File, const Token &FilenameTok,
+                           SrcMgr::CharacteristicKind FileType);
+  virtual void MacroDefined(const Token &MacroNameTok,
+                            const MacroDirective *MD);
+  virtual void EndOfMainFile();
+
+  virtual void LexBegin();
+  virtual void LexEnd(const Token &Tok);
+};
+}
+
+void clang::AttachHeaderCostReport(Preprocessor &PP, StringRef OutputFile) {
+  HeaderCostReportCallback *Callback =
+      new HeaderCostReportCallback(PP, OutputFile);
+  PP.addPPCallbacks(Callback);
+  PP.setTokenObserver(Callback);
+}
+
+TimeValue HeaderCostReportCallback::chargeElapsedTime() {
+  TimeValue Now = TimeValue::now();
+  if (!IncludeStack.empty()) {
+    uint64_t Elapsed = (Now - LastCharged).usec();
+    HeaderCost *Current = IncludeStack.back().first;
+    if (InLex)
+      Current->PPTime += Elapsed;
+    else
+      Current->ParseTime += Elapsed;
+  }
+  LastCharged = Now;
+  return Now;
+}
+
+void HeaderCostReportCallback::FileChanged(SourceLocation Loc,
+                                           FileChangeReason Reason,
+                                           SrcMgr::CharacteristicKind FileType,
+                                           FileID PrevFID) {
+  if (Reason != EnterFile && Reason != ExitFile)
+    return;
+
+  TimeValue Now = chargeElapsedTime();
+  if (Reason == EnterFile) {
+    StringRef Name = PP.getSourceManager().getBufferName(Loc);
+    HeaderCost &Cost = Costs.GetOrCreateValue(Name).getValue();
+    ++Cost.NumEntered;
+    IncludeStack.push_back(std::make_pair(&Cost, Now));
+    return;
+  }
+
+  if (IncludeStack.empty())
+    return;
+  IncludeStack.back().first->InclusiveTime +=
+      (Now - IncludeStack.back().second).usec();
+  IncludeStack.pop_back();
+}
+
+void HeaderCostReportCallback::FileSkipped(const FileEntry &File,
+                                           const Token &FilenameTok,
+                                           SrcMgr::CharacteristicKind FileType) {
+  ++Costs.GetOrCreateValue(File.getName()).getValue().NumSkipped;
+}
+
+void HeaderCostReportCallback::MacroDefined(const Token &MacroNameTok,
+                                            const MacroDirective *MD) {
+  if (!IncludeStack.empty())
+    ++IncludeStack.back().first->NumMacros;
+}
+
+void HeaderCostReportCallback::LexBegin() {
+  chargeElapsedTime();
+  InLex = true;
+}
+
+void HeaderCostReportCallback::LexEnd(const Token &Tok) {
+  chargeElapsedTime();
+  InLex = false;
+  if (!IncludeStack.empty() && Tok.isNot(tok::eof))
+    ++IncludeStack.back().first->NumTokens;
+}
+
+void HeaderCostReportCallback::EndOfMainFile() {
+  // The main file (and anything still open) is never exited.
+  TimeValue Now = chargeElapsedTime();
+  for (unsigned I = 0, N = IncludeStack.size(); I != N; ++I)
+    IncludeStack[I].first->InclusiveTime +=
+        (Now - IncludeStack[I].second).usec();
+  IncludeStack.clear();
+
+  OutputReport();
+}
+
+static bool compareInclusiveTime(const HeaderCostEntry *LHS,
+                                 const HeaderCostEntry *RHS) {
+  if (LHS->getValue().InclusiveTime != RHS->getValue().InclusiveTime)
+    return LHS->getValue().InclusiveTime > RHS->getValue().InclusiveTime;
+  return LHS->getKey() < RHS->getKey();
+}
+
+static llvm::format_object1<double> formatMS(uint64_t Microseconds) {
+  return llvm::format("%.3f", Microseconds / 1000.0);
+}
+
+void HeaderCostReportCallback::OutputReport() {
+  std::string Err;
+  llvm::raw_fd_ostream OS(OutputFile.c_str(), Err);
+  if (!Err.empty()) {
+    PP.getDiagnostics().Report(diag::err_fe_error_opening)
+      << OutputFile << Err;
+    return;
+  }
+
+  std::vector<const HeaderCostEntry *> Entries;
+  for (llvm::StringMap<HeaderCost>::const_iterator I = Costs.begin(),
+                                                   E = Costs.end();
+       I != E; ++I)
+    Entries.push_back(&*I);
+  std::sort(Entries.begin(), Entries.end(), compareInclusiveTime);
+
+  OS << "# file\tentered\tskipped\ttokens\tmacros\tpp-ms\tparse-ms"
+        "\tinclusive-ms\n";
+  for (unsigned I = 0, N = Entries.size(); I != N; ++I) {
+    const HeaderCost &Cost = Entries[I]->getValue();
+    OS << Entries[I]->getKey() << '\t' << Cost.NumEntered << '\t'
+       << Cost.NumSkipped << '\t' << Cost.NumTokens << '\t' << Cost.NumMacros
+       << '\t' << formatMS(Cost.PPTime) << '\t' << formatMS(Cost.ParseTime)
+       << '\t' << formatMS(Cost.InclusiveTime) << '\n';
+  }
+}
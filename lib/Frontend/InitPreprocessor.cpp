@@ -799,7 +799,7 @@ void clang::InitializePreprocessor(Preprocessor &PP,
                                    const FrontendOptions &FEOpts) {
   const LangOptions &LangOpts = PP.getLangOpts();
   std::string PredefineBuffer;
-  PredefineBuffer.reserve(4080);
+  PredefineBuffer.reserve(16384);
   llvm::raw_string_ostream Predefines(PredefineBuffer);
   MacroBuilder Builder(Predefines);
 
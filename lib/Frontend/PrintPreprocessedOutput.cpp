@@ -566,8 +566,8 @@ bool PrintPPOutputPPCallbacks::HandleFirstTokOnLine(Token &Tok) {
     OS << ' ';
 
   // Otherwise, indent the appropriate number of spaces.
-  for (; ColNo > 1; --ColNo)
-    OS << ' ';
+  if (ColNo > 1)
+    OS.indent(ColNo - 1);
 
   return true;
 }
@@ -623,12 +623,54 @@ struct UnknownPragmaHandler : public PragmaHandler {
 } // end anonymous namespace
 
 
+namespace {
+/// \brief Finds the characters of tokens that were lexed straight from a file
+/// buffer, without asking the SourceManager for each one.
+///
+/// Tokens arrive in runs from the same buffer, and file locations within a
+/// buffer are contiguous, so remembering the last buffer's location range
+/// turns the lookup into a subtraction.
+class FileSpellingCache {
+  SourceManager &SM;
+  unsigned BufStartOffset, BufEndOffset;
+  const char *BufStart;
+
+public:
+  explicit FileSpellingCache(SourceManager &SM)
+    : SM(SM), BufStartOffset(0), BufEndOffset(0), BufStart(0) {}
+
+  /// \brief Return the characters of \p Tok if they can be copied verbatim
+  /// from its file buffer, or null.
+  const char *getSpelling(const Token &Tok) {
+    SourceLocation Loc = Tok.getLocation();
+    if (!Loc.isFileID() || Tok.needsCleaning())
+      return 0;
+
+    // File locations are plain offsets into the file location space.
+    unsigned Offset = Loc.getRawEncoding();
+    if (Offset < BufStartOffset ||
+        Offset + Tok.getLength() > BufEndOffset) {
+      std::pair<FileID, unsigned> LocInfo = SM.getDecomposedLoc(Loc);
+      bool Invalid = false;
+      StringRef Buffer = SM.getBufferData(LocInfo.first, &Invalid);
+      if (Invalid || LocInfo.second + Tok.getLength() > Buffer.size())
+        return 0;
+      BufStart = Buffer.data();
+      BufStartOffset = Offset - LocInfo.second;
+      BufEndOffset = BufStartOffset + Buffer.size();
+    }
+    return BufStart + (Offset - BufStartOffset);
+  }
+};
+} // end anonymous namespace
+
 static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                                     PrintPPOutputPPCallbacks *Callbacks,
                                     raw_ostream &OS) {
   bool DropComments = PP.getLangOpts().TraditionalCPP &&
                       !PP.getCommentRetentionState();
 
+  FileSpellingCache FileSpellings(PP.getSourceManager());
   char Buffer[256];
   Token PrevPrevTok, PrevTok;
   PrevPrevTok.startToken();
@@ -669,6 +711,14 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
     } else if (Tok.isLiteral() && !Tok.needsCleaning() &&
                Tok.getLiteralData()) {
       OS.write(Tok.getLiteralData(), Tok.getLength());
+    } else if (const char *TokPtr = FileSpellings.getSpelling(Tok)) {
+      // The token was lexed unchanged from a file; copy it from there.
+      OS.write(TokPtr, Tok.getLength());
+
+      // Tokens that can contain embedded newlines need to adjust our current
+      // line number.
+      if (Tok.getKind() == tok::comment || Tok.getKind() == tok::unknown)
+        Callbacks->HandleNewlinesInToken(TokPtr, Tok.getLength());
     } else if (Tok.getLength() < 256) {
       const char *TokPtr = Buffer;
       unsigned Len = PP.getSpelling(Tok, TokPtr);
@@ -747,6 +797,13 @@ void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
   // to -C or -CC.
   PP.SetCommentRetentionState(Opts.ShowComments, Opts.ShowMacroComments);
 
+  // The output is written in many small pieces; make sure they are collected
+  // into reasonably large writes.
+  const size_t OutputBufferSize = 64 * 1024;
+  if (size_t CurBufferSize = OS->GetBufferSize())
+    if (CurBufferSize < OutputBufferSize)
+      OS->SetBufferSize(OutputBufferSize);
+
   PrintPPOutputPPCallbacks *Callbacks =
       new PrintPPOutputPPCallbacks(PP, *OS, !Opts.ShowLineMarkers,
                                    Opts.ShowMacros);
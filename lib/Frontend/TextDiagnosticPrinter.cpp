@@ -19,31 +19,97 @@
 #include "clang/Lex/Lexer.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <vector>
 using namespace clang;
 
+/// \brief The printers that buffer their output, which a crash would
+/// otherwise lose.
+static llvm::ManagedStatic<std::vector<TextDiagnosticPrinter *> >
+  BufferedPrinters;
+static llvm::ManagedStatic<llvm::sys::Mutex> BufferedPrintersLock;
+
+void TextDiagnosticPrinter::flushBuffersOnCrash(void *) {
+  // No locking here: this runs in a signal handler.
+  std::vector<TextDiagnosticPrinter *> &Printers = *BufferedPrinters;
+  for (unsigned I = 0, N = Printers.size(); I != N; ++I)
+    Printers[I]->flushBuffer();
+}
+
 TextDiagnosticPrinter::TextDiagnosticPrinter(raw_ostream &os,
                                              DiagnosticOptions *diags,
                                              bool _OwnsOutputStream)
   : OS(os), DiagOpts(diags),
     OwnsOutputStream(_OwnsOutputStream) {
+  // Unbuffered streams such as llvm::errs() turn every diagnostic into many
+  // small writes.  In buffered mode, render into our own buffer and write it
+  // out at the end of each source file (or when it grows large), leaving the
+  // stream itself, which may well be shared, untouched.  Colors are a
+  // property of the terminal stream, so colored output is not buffered.
+  //
+  // Diagnostics are still rendered as they arrive: rendering needs the source
+  // manager and preprocessor state of that moment, and the source manager
+  // already caches the last line number lookup, which is what diagnostics
+  // arriving in source order keep hitting.
+  if (!DiagOpts->BufferedOutput || DiagOpts->ShowColors)
+    return;
+  BufferOS.reset(new llvm::raw_svector_ostream(Buffer));
+
+  // Diagnostics leading up to a crash are the most useful ones of all.
+  llvm::sys::ScopedLock Lock(*BufferedPrintersLock);
+  static bool RegisteredSignalHandler = false;
+  if (!RegisteredSignalHandler) {
+    llvm::sys::AddSignalHandler(flushBuffersOnCrash, 0);
+    RegisteredSignalHandler = true;
+  }
+  BufferedPrinters->push_back(this);
 }
 
 TextDiagnosticPrinter::~TextDiagnosticPrinter() {
+  if (BufferOS) {
+    llvm::sys::ScopedLock Lock(*BufferedPrintersLock);
+    BufferedPrinters->erase(std::find(BufferedPrinters->begin(),
+                                      BufferedPrinters->end(), this));
+  }
+  flushBuffer();
   if (OwnsOutputStream)
     delete &OS;
 }
 
+raw_ostream &TextDiagnosticPrinter::getOutput() {
+  if (BufferOS)
+    return *BufferOS;
+  return OS;
+}
+
+void TextDiagnosticPrinter::flushBuffer() {
+  if (!BufferOS)
+    return;
+
+  OS << BufferOS->str();
+  OS.flush();
+  Buffer.clear();
+  BufferOS->resync();
+}
+
 void TextDiagnosticPrinter::BeginSourceFile(const LangOptions &LO,
                                             const Preprocessor *PP) {
   // Build the TextDiagnostic utility.
-  TextDiag.reset(new TextDiagnostic(OS, LO, &*DiagOpts));
+  TextDiag.reset(new TextDiagnostic(getOutput(), LO, &*DiagOpts));
 }
 
 void TextDiagnosticPrinter::EndSourceFile() {
   TextDiag.reset(0);
+  flushBuffer();
+}
+
+void TextDiagnosticPrinter::finish() {
+  flushBuffer();
 }
 
 /// \brief Print any diagnostic option information to a raw_ostream.
@@ -105,6 +171,17 @@ static void printDiagnosticOptions(raw_ostream &OS,
     OS << ']';
 }
 
+void TextDiagnosticPrinter::flushDiagnostic(DiagnosticsEngine::Level Level) {
+  if (!BufferOS) {
+    OS.flush();
+    return;
+  }
+
+  // Always get fatal errors out, since compilation is about to stop.
+  if (Level == DiagnosticsEngine::Fatal || BufferOS->tell() >= 64 * 1024)
+    flushBuffer();
+}
+
 void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
                                              const Diagnostic &Info) {
   // Default implementation (Warnings/errors count).
@@ -122,23 +199,24 @@ void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
   // information (e.g., "foo.c:10:4:") that precedes the error
   // message. We use this information to determine how long the
   // file+line+column number prefix is.
-  uint64_t StartOfLocationInfo = OS.tell();
+  raw_ostream &Out = getOutput();
+  uint64_t StartOfLocationInfo = Out.tell();
 
   if (!Prefix.empty())
-    OS << Prefix << ": ";
+    Out << Prefix << ": ";
 
   // Use a dedicated, simpler path for diagnostics without a valid location.
   // This is important as if the location is missing, we may be emitting
   // diagnostics in a context that lacks language options, a source manager, or
   // other infrastructure necessary when emitting more rich diagnostics.
   if (!Info.getLocation().isValid()) {
-    TextDiagnostic::printDiagnosticLevel(OS, Level, DiagOpts->ShowColors,
+    TextDiagnostic::printDiagnosticLevel(Out, Level, DiagOpts->ShowColors,
                                          DiagOpts->CLFallbackMode);
-    TextDiagnostic::printDiagnosticMessage(OS, Level, DiagMessageStream.str(),
-                                           OS.tell() - StartOfLocationInfo,
+    TextDiagnostic::printDiagnosticMessage(Out, Level, DiagMessageStream.str(),
+                                           Out.tell() - StartOfLocationInfo,
                                            DiagOpts->MessageLength,
                                            DiagOpts->ShowColors);
-    OS.flush();
+    flushDiagnostic(Level);
     return;
   }
 
@@ -154,5 +232,5 @@ void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
                                               Info.getNumFixItHints()),
                            &Info.getSourceManager());
 
-  OS.flush();
+  flushDiagnostic(Level);
 }
@@ -0,0 +1,281 @@
+//===--- CrossTUImport.cpp - Import definitions from other TUs ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the CrossTUImporter.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Index/CrossTUImport.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/ASTImporter.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace clang::index;
+
+/// \brief A loaded AST file and the definitions it provides.
+struct CrossTUImporter::ASTFileInfo {
+  OwningPtr<ASTUnit> Unit;
+
+  /// \brief The importer for everything imported from this file, which must
+  /// be destroyed before the unit.
+  OwningPtr<ASTImporter> Importer;
+
+  /// \brief Mapping from USRs to the function definitions in this file.
+  llvm::StringMap<FunctionDecl *> Definitions;
+};
+
+CrossTUImporter::CrossTUImporter(ASTContext &ToContext,
+                                 FileManager &ToFileManager,
+                                 DiagnosticsEngine &Diags)
+  : ToContext(ToContext), ToFileManager(ToFileManager), Diags(Diags),
+    NumLookups(0), NumCachedLookups(0), NumImportedDefinitions(0) {
+}
+
+CrossTUImporter::~CrossTUImporter() {
+  for (llvm::StringMap<ASTFileInfo *>::iterator I = LoadedFiles.begin(),
+                                                E = LoadedFiles.end();
+       I != E; ++I)
+    delete I->second;
+}
+
+bool CrossTUImporter::loadIndex(StringRef IndexFile,
+                                std::string &ErrorMessage) {
+  OwningPtr<llvm::MemoryBuffer> IndexBuffer;
+  llvm::error_code Result = llvm::MemoryBuffer::getFile(IndexFile, IndexBuffer);
+  if (Result != 0) {
+    ErrorMessage = "Error while opening cross-TU index: " + Result.message();
+    return false;
+  }
+
+  StringRef IndexDir = llvm::sys::path::parent_path(IndexFile);
+  StringRef Rest = IndexBuffer->getBuffer();
+  for (unsigned LineNo = 1; !Rest.empty(); ++LineNo) {
+    std::pair<StringRef, StringRef> Line = Rest.split('\n');
+    Rest = Line.second;
+
+    StringRef Entry = Line.first.trim();
+    if (Entry.empty())
+      continue;
+
+    std::pair<StringRef, StringRef> USRAndPath = Entry.split(' ');
+    StringRef Path = USRAndPath.second.trim();
+    if (Path.empty()) {
+      ErrorMessage = (IndexFile + ":" + Twine(LineNo) +
+                      ": expected a USR followed by an AST file").str();
+      return false;
+    }
+
+    if (llvm::sys::path::is_absolute(Path)) {
+      addDefinitionFile(USRAndPath.first, Path);
+    } else {
+      SmallString<128> FullPath(IndexDir);
+      llvm::sys::path::append(FullPath, Path);
+      addDefinitionFile(USRAndPath.first, FullPath);
+    }
+  }
+  return true;
+}
+
+void CrossTUImporter::addDefinitionFile(StringRef USR, StringRef ASTFile) {
+  DefinitionFiles[USR] = ASTFile;
+}
+
+/// \brief Collect the function definitions with external linkage in \p DC
+/// and the namespaces, linkage specifications and classes nested in it.
+static void collectDefinitions(DeclContext *DC,
+                               llvm::StringMap<FunctionDecl *> &Definitions) {
+  for (DeclContext::decl_iterator D = DC->decls_begin(),
+                               DEnd = DC->decls_end();
+       D != DEnd; ++D) {
+    if (FunctionDecl *FD = dyn_cast<FunctionDecl>(*D)) {
+      if (!FD->isThisDeclarationADefinition() || FD->isDependentContext() ||
+          !FD->hasExternalFormalLinkage())
+        continue;
+
+      SmallString<128> USR;
+      if (!generateUSRForDecl(FD, USR))
+        Definitions[USR] = FD;
+      continue;
+    }
+
+    if (isa<NamespaceDecl>(*D) || isa<LinkageSpecDecl>(*D) ||
+        isa<RecordDecl>(*D))
+      collectDefinitions(cast<DeclContext>(*D), Definitions);
+  }
+}
+
+CrossTUImporter::ASTFileInfo *CrossTUImporter::getASTFile(StringRef Path) {
+  llvm::StringMap<ASTFileInfo *>::iterator Known = LoadedFiles.find(Path);
+  if (Known != LoadedFiles.end())
+    return Known->second;
+
+  // Diagnostics from the AST file go wherever ours go.
+  IntrusiveRefCntPtr<DiagnosticsEngine>
+      UnitDiags(new DiagnosticsEngine(Diags.getDiagnosticIDs(),
+                                      &Diags.getDiagnosticOptions(),
+                                      new ForwardingDiagnosticConsumer(
+                                            *Diags.getClient()),
+                                      /*ShouldOwnClient=*/true));
+  ASTUnit *Unit = ASTUnit::LoadFromASTFile(Path.str(), UnitDiags,
+                                       ToFileManager.getFileSystemOptions());
+  if (!Unit) {
+    LoadedFiles[Path] = 0;
+    return 0;
+  }
+
+  ASTFileInfo *Info = new ASTFileInfo;
+  Info->Unit.reset(Unit);
+  Info->Importer.reset(new ASTImporter(ToContext, ToFileManager,
+                                       Unit->getASTContext(),
+                                       Unit->getFileManager(),
+                                       /*MinimalImport=*/false));
+  collectDefinitions(Unit->getASTContext().getTranslationUnitDecl(),
+                     Info->Definitions);
+  LoadedFiles[Path] = Info;
+  return Info;
+}
+
+const FunctionDecl *CrossTUImporter::importDefinition(StringRef USR) {
+  llvm::StringMap<std::string>::const_iterator File
+    = DefinitionFiles.find(USR);
+  if (File == DefinitionFiles.end())
+    return 0;
+
+  ASTFileInfo *Info = getASTFile(File->second);
+  if (!Info)
+    return 0;
+
+  llvm::StringMap<FunctionDecl *>::const_iterator FromDef
+    = Info->Definitions.find(USR);
+  if (FromDef == Info->Definitions.end())
+    return 0;
+
+  FunctionDecl *From = FromDef->second;
+  ASTImporter &Importer = *Info->Importer;
+  FunctionDecl *To = cast_or_null<FunctionDecl>(Importer.Import(From));
+  if (!To)
+    return 0;
+
+  const FunctionDecl *ToDef;
+  if (To->hasBody(ToDef))
+    return ToDef;
+
+  // The importer merges a function into a matching declaration in our context
+  // without bringing its body along, so import the body ourselves, making its
+  // references to the parameters refer to the parameters of that declaration.
+  if (To->getNumParams() != From->getNumParams())
+    return 0;
+
+  // A body we can't import is simply a definition we don't have, so nothing
+  // about the failure is reported, and the locals it added to the function
+  // are removed along with the mappings of the parameters and locals.  The
+  // declarations it imported elsewhere before failing, such as callees,
+  // records and typedefs, are complete on their own, so they stay in our
+  // context and stay mapped for later imports to reuse.
+  llvm::SmallPtrSet<Decl *, 8> KnownDecls;
+  for (DeclContext::decl_iterator D = To->decls_begin(),
+                               DEnd = To->decls_end();
+       D != DEnd; ++D)
+    KnownDecls.insert(*D);
+
+  for (unsigned I = 0, N = From->getNumParams(); I != N; ++I)
+    Importer.Imported(From->getParamDecl(I), To->getParamDecl(I));
+
+  DiagnosticsEngine &FromDiags = Info->Unit->getDiagnostics();
+  DiagnosticsEngine &ToDiags = ToContext.getDiagnostics();
+  bool FromSuppressed = FromDiags.getSuppressAllDiagnostics();
+  bool ToSuppressed = ToDiags.getSuppressAllDiagnostics();
+  FromDiags.setSuppressAllDiagnostics(true);
+  ToDiags.setSuppressAllDiagnostics(true);
+  Stmt *Body = Importer.Import(From->getBody());
+  FromDiags.setSuppressAllDiagnostics(FromSuppressed);
+  ToDiags.setSuppressAllDiagnostics(ToSuppressed);
+
+  if (!Body) {
+    SmallVector<Decl *, 8> Stray;
+    for (DeclContext::decl_iterator D = To->decls_begin(),
+                                 DEnd = To->decls_end();
+         D != DEnd; ++D)
+      if (!KnownDecls.count(*D))
+        Stray.push_back(*D);
+    for (unsigned I = 0, N = Stray.size(); I != N; ++I)
+      To->removeDecl(Stray[I]);
+
+    for (unsigned I = 0, N = From->getNumParams(); I != N; ++I)
+      Importer.Forget(From->getParamDecl(I));
+    for (DeclContext::decl_iterator D = From->decls_begin(),
+                                 DEnd = From->decls_end();
+         D != DEnd; ++D)
+      Importer.Forget(*D);
+    return 0;
+  }
+
+  To->setBody(Body);
+  ++NumImportedDefinitions;
+  return To;
+}
+
+const FunctionDecl *
+CrossTUImporter::getCrossTUDefinition(const FunctionDecl *FD) {
+  const FunctionDecl *Def;
+  if (FD->hasBody(Def))
+    return Def;
+
+  SmallString<128> USR;
+  if (generateUSRForDecl(FD, USR))
+    return 0;
+
+  ++NumLookups;
+  llvm::StringMap<const FunctionDecl *>::iterator Known
+    = ImportedDefinitions.find(USR);
+  if (Known != ImportedDefinitions.end()) {
+    ++NumCachedLookups;
+    return Known->second;
+  }
+
+  Def = importDefinition(USR);
+  ImportedDefinitions[USR] = Def;
+  return Def;
+}
+
+void CrossTUImporter::PrintStats() const {
+  unsigned NumLoadedFiles = 0;
+  unsigned NumEquivalentDecls = 0;
+  for (llvm::StringMap<ASTFileInfo *>::const_iterator I = LoadedFiles.begin(),
+                                                      E = LoadedFiles.end();
+       I != E; ++I) {
+    if (!I->second)
+      continue;
+    ++NumLoadedFiles;
+    NumEquivalentDecls += I->second->Importer->getEquivalentDecls().size();
+  }
+
+  llvm::errs() << "\n*** Cross-TU Import Stats:\n";
+  llvm::errs() << "  " << DefinitionFiles.size() << " indexed definitions, "
+               << NumLoadedFiles << " of " << LoadedFiles.size()
+               << " AST files loaded\n";
+  llvm::errs() << "  " << NumLookups << " definition lookups, "
+               << NumCachedLookups << " answered from the cache, "
+               << NumImportedDefinitions << " definitions imported\n";
+  llvm::errs() << "  " << NumEquivalentDecls
+               << " declaration pairs known to be structurally equivalent\n";
+}
@@ -13,14 +13,20 @@
 
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FilePrefetcher.h"
 #include "clang/Basic/IdentifierTable.h"
+#include "clang/Basic/Version.h"
 #include "clang/Lex/HeaderMap.h"
 #include "clang/Lex/HeaderSearchOptions.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/Lexer.h"
+#include "clang/Lex/MultipleIncludeOpt.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
@@ -58,6 +64,10 @@ HeaderSearch::HeaderSearch(IntrusiveRefCntPtr<HeaderSearchOptions> HSOpts,
   NumIncluded = 0;
   NumMultiIncludeFileOptzn = 0;
   NumFrameworkLookups = NumSubFrameworkLookups = 0;
+  NumModuleMapIndexHits = 0;
+
+  ModuleMapIndexLoaded = false;
+  ModuleMapIndexOutOfDate = false;
 
   EnabledModules = LangOpts.Modules;
 }
@@ -68,6 +78,28 @@ HeaderSearch::~HeaderSearch() {
     delete HeaderMaps[i].second;
 }
 
+static const char *getGuardFailureName(unsigned Reason) {
+  switch (Reason) {
+  case MultipleIncludeOpt::GF_None:
+    return "guarded";
+  case MultipleIncludeOpt::GF_NoGuard:
+    return "no top-level conditional";
+  case MultipleIncludeOpt::GF_TokensBeforeGuard:
+    return "tokens before the guard";
+  case MultipleIncludeOpt::GF_UnrecognizedCondition:
+    return "condition is not '!defined(X)' or '!defined(X) && ...'";
+  case MultipleIncludeOpt::GF_MacroInCondition:
+    return "macro expanded in the guard condition";
+  case MultipleIncludeOpt::GF_TopLevelElse:
+    return "top-level #else or #elif";
+  case MultipleIncludeOpt::GF_MultipleConditionals:
+    return "more than one top-level conditional";
+  case MultipleIncludeOpt::GF_TokensAfterEndif:
+    return "tokens after the guard's #endif";
+  }
+  llvm_unreachable("Unknown guard failure");
+}
+
 void HeaderSearch::PrintStats() {
   fprintf(stderr, "\n*** HeaderSearch Stats:\n");
   fprintf(stderr, "%d files tracked.\n", (int)FileInfo.size());
@@ -86,8 +118,28 @@ void HeaderSearch::PrintStats() {
   fprintf(stderr, "    %d #includes skipped due to"
           " the multi-include optimization.\n", NumMultiIncludeFileOptzn);
 
+  // List the headers that were lexed more than once although they might have
+  // been skipped, along with the reason no include guard was detected.
+  SmallVector<const FileEntry *, 16> UIDToFile;
+  FileMgr.GetUniqueIDMapping(UIDToFile);
+  unsigned NumRelexedFiles = 0;
+  for (unsigned i = 0, e = FileInfo.size(); i != e; ++i) {
+    const HeaderFileInfo &HFI = FileInfo[i];
+    if (HFI.NumIncludes < 2 || HFI.isImport || HFI.ControllingMacro ||
+        HFI.ControllingMacroID || i >= UIDToFile.size() || !UIDToFile[i])
+      continue;
+    if (NumRelexedFiles++ == 0)
+      fprintf(stderr, "  Headers lexed more than once:\n");
+    fprintf(stderr, "    %s: %u times, %s.\n", UIDToFile[i]->getName(),
+            (unsigned)HFI.NumIncludes, getGuardFailureName(HFI.GuardFailure));
+  }
+  fprintf(stderr, "  %u headers lexed more than once.\n", NumRelexedFiles);
+
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
+  if (HSOpts->ModuleMapIndex)
+    fprintf(stderr, "%d modules found through the module map index.\n",
+            NumModuleMapIndexHits);
 }
 
 /// CreateHeaderMap - This method returns a HeaderMap for the specified
@@ -138,6 +190,11 @@ Module *HeaderSearch::lookupModule(StringRef ModuleName, bool AllowSearch) {
   Module *Module = ModMap.findModule(ModuleName);
   if (Module || !AllowSearch)
     return Module;
+
+  // If an earlier compilation told us which module map defines this module,
+  // load just that one.
+  if ((Module = lookupModuleInIndex(ModuleName)))
+    return Module;
   
   // Look through the various header search paths to load any available module
   // maps, searching for a module map that describes this module.
@@ -695,6 +752,87 @@ const FileEntry *HeaderSearch::LookupFile(
   return 0;
 }
 
+void HeaderSearch::getIncludeCandidates(
+    StringRef Filename, bool isAngled, const FileEntry *Includer,
+    SmallVectorImpl<std::string> &Candidates) {
+  Candidates.clear();
+
+  if (llvm::sys::path::is_absolute(Filename)) {
+    Candidates.push_back(Filename.str());
+    return;
+  }
+
+  // Build the paths exactly as LookupFile and DirectoryLookup::LookupFile do,
+  // so that the FileManager asks for the same strings.
+  SmallString<1024> TmpDir;
+  if (Includer && !isAngled && !NoCurDirSearch) {
+    TmpDir = Includer->getDir()->getName();
+    TmpDir.push_back('/');
+    TmpDir.append(Filename.begin(), Filename.end());
+    Candidates.push_back(std::string(TmpDir.begin(), TmpDir.end()));
+  }
+
+  for (unsigned i = isAngled ? AngledDirIdx : 0, e = SearchDirs.size();
+       i != e; ++i) {
+    if (!SearchDirs[i].isNormalDir())
+      continue;
+    TmpDir = SearchDirs[i].getDir()->getName();
+    llvm::sys::path::append(TmpDir, Filename);
+    Candidates.push_back(std::string(TmpDir.begin(), TmpDir.end()));
+  }
+
+  // The FileManager stats paths relative to its working directory.
+  for (unsigned i = 0, e = Candidates.size(); i != e; ++i) {
+    TmpDir = Candidates[i];
+    FileMgr.FixupRelativePath(TmpDir);
+    Candidates[i].assign(TmpDir.begin(), TmpDir.end());
+  }
+}
+
+void HeaderSearch::prefetchIncludes(const FileEntry *File, StringRef Buffer) {
+  FilePrefetcher *Prefetcher = FileMgr.getPrefetcher();
+  if (!Prefetcher)
+    return;
+
+  SmallVector<std::string, 16> Candidates;
+  while (!Buffer.empty()) {
+    // Look at one line at a time.
+    size_t Pos = Buffer.find('\n');
+    StringRef Line = Buffer.substr(0, Pos);
+    Buffer = Pos == StringRef::npos ? StringRef() : Buffer.substr(Pos + 1);
+
+    // Match '#' 'include' or '#' 'import', then a header name.
+    Pos = Line.find_first_not_of(" \t");
+    if (Pos == StringRef::npos || Line[Pos] != '#')
+      continue;
+    Line = Line.substr(Pos + 1);
+    Line = Line.substr(Line.find_first_not_of(" \t"));
+    if (Line.startswith("include"))
+      Line = Line.substr(7);
+    else if (Line.startswith("import"))
+      Line = Line.substr(6);
+    else
+      continue;
+    Line = Line.substr(Line.find_first_not_of(" \t"));
+    if (Line.empty() || (Line[0] != '"' && Line[0] != '<'))
+      continue;
+
+    bool isAngled = Line[0] == '<';
+    size_t NameEnd = Line.find(isAngled ? '>' : '"', 1);
+    if (NameEnd == StringRef::npos || NameEnd == 1)
+      continue;
+    StringRef Filename = Line.slice(1, NameEnd);
+
+    // Angled includes that were looked up before are already known to the
+    // FileManager.
+    if (isAngled && LookupFileCache.count(Filename))
+      continue;
+
+    getIncludeCandidates(Filename, isAngled, File, Candidates);
+    Prefetcher->prefetch(Candidates);
+  }
+}
+
 /// LookupSubframeworkHeader - Look up a subframework for the specified
 /// \#include file.  For example, if \#include'ing <HIToolbox/HIToolbox.h> from
 /// within ".../Carbon.framework/Headers/Carbon.h", check to see if HIToolbox
@@ -1019,13 +1157,18 @@ bool HeaderSearch::loadModuleMapFile(const FileEntry *File, bool IsSystem) {
     return !KnownDir->second;
   
   bool Result = ModMap.parseModuleMapFile(File, IsSystem);
+  if (!Result)
+    LoadedModuleMaps[File] = IsSystem;
   if (!Result && llvm::sys::path::filename(File->getName()) == "module.map") {
     // If the file we loaded was a module.map, look for the corresponding
     // module_private.map.
     SmallString<128> PrivateFilename(Dir->getName());
     llvm::sys::path::append(PrivateFilename, "module_private.map");
-    if (const FileEntry *PrivateFile = FileMgr.getFile(PrivateFilename))
+    if (const FileEntry *PrivateFile = FileMgr.getFile(PrivateFilename)) {
       Result = ModMap.parseModuleMapFile(PrivateFile, IsSystem);
+      if (!Result)
+        LoadedModuleMaps[PrivateFile] = IsSystem;
+    }
   }
   
   DirectoryHasModuleMap[Dir] = !Result;  
@@ -1092,6 +1235,13 @@ HeaderSearch::loadModuleMapFile(const DirectoryEntry *Dir, bool IsSystem) {
     = DirectoryHasModuleMap.find(Dir);
   if (KnownDir != DirectoryHasModuleMap.end())
     return KnownDir->second? LMM_AlreadyLoaded : LMM_InvalidModuleMap;
+
+  // Don't bother probing for a module map if an earlier compilation found
+  // none here and the directory hasn't changed since.
+  if (isKnownToHaveNoModuleMap(Dir)) {
+    DirectoryHasModuleMap[Dir] = false;
+    return LMM_InvalidModuleMap;
+  }
   
   SmallString<128> ModuleMapFileName;
   ModuleMapFileName += Dir->getName();
@@ -1107,6 +1257,7 @@ HeaderSearch::loadModuleMapFile(const DirectoryEntry *Dir, bool IsSystem) {
 
     // This directory has a module map.
     DirectoryHasModuleMap[Dir] = true;
+    LoadedModuleMaps[ModuleMapFile] = IsSystem;
     
     // Check whether there is a private module map that we need to load as well.
     ModuleMapFileName.erase(ModuleMapFileName.begin() + ModuleMapDirNameLen,
@@ -1119,6 +1270,7 @@ HeaderSearch::loadModuleMapFile(const DirectoryEntry *Dir, bool IsSystem) {
         DirectoryHasModuleMap[Dir] = false;
         return LMM_InvalidModuleMap;
       }      
+      LoadedModuleMaps[PrivateModuleMapFile] = IsSystem;
     }
     
     return LMM_NewlyLoaded;
@@ -1126,6 +1278,7 @@ HeaderSearch::loadModuleMapFile(const DirectoryEntry *Dir, bool IsSystem) {
   
   // No suitable module map.
   DirectoryHasModuleMap[Dir] = false;
+  noteDirectoryWithoutModuleMap(Dir);
   return LMM_InvalidModuleMap;
 }
 
@@ -1206,3 +1359,339 @@ void HeaderSearch::loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir) {
 
   SearchDir.setSearchedAllModuleMaps(true);
 }
+
+//===----------------------------------------------------------------------===//
+// Module map index
+//===----------------------------------------------------------------------===//
+//
+// The module map index is a text file in the module cache with one record per
+// line.  The first line identifies the format and the compiler version; each
+// following line is either
+//
+//   M <tab> is-system <tab> mtime <tab> size <tab> module map <tab> module
+//   N <tab> mtime <tab> directory
+//
+// Every record is checked against the file system before it is used, along
+// with everything the search would have looked at before the indexed module
+// map, and the index is only ever a hint: when it doesn't help, the normal
+// search runs.
+//
+// Which module map defines a module depends on the order of the search
+// directories, so the first line also holds a hash of the search path.  An
+// index written with a different search path is ignored, and replaced.
+
+std::string HeaderSearch::getModuleMapIndexSignature() const {
+  llvm::hash_code SearchPathHash = llvm::hash_value(SearchDirs.size());
+  for (unsigned I = 0, N = SearchDirs.size(); I != N; ++I)
+    SearchPathHash = llvm::hash_combine(SearchPathHash,
+                                        StringRef(SearchDirs[I].getName()),
+                                        SearchDirs[I].getLookupType(),
+                                        SearchDirs[I].getDirCharacteristic());
+  SearchPathHash = llvm::hash_combine(SearchPathHash, AngledDirIdx,
+                                      SystemDirIdx);
+
+  std::string Signature = "module-map-index 2 " +
+                          getClangFullRepositoryVersion() + " ";
+  llvm::raw_string_ostream OS(Signature);
+  OS.write_hex(size_t(SearchPathHash));
+  return OS.str();
+}
+
+bool HeaderSearch::findSearchDirectory(const DirectoryEntry *Dir,
+                                       unsigned &Idx) {
+  // Header search loads module maps from the search directories and their
+  // immediate subdirectories.
+  const DirectoryEntry *Parent
+    = FileMgr.getDirectory(llvm::sys::path::parent_path(Dir->getName()));
+  for (Idx = 0; Idx != SearchDirs.size(); ++Idx) {
+    if (!SearchDirs[Idx].isNormalDir())
+      continue;
+    if (SearchDirs[Idx].getDir() == Dir || SearchDirs[Idx].getDir() == Parent)
+      return true;
+  }
+  return false;
+}
+
+bool HeaderSearch::isSearchUnchangedBefore(StringRef ModuleName,
+                                           unsigned MapDirIdx,
+                                           const DirectoryEntry *MapDir) {
+  // Walk the search directories the way lookupModule() does, stopping at the
+  // module map the index points to.
+  for (unsigned Idx = 0; Idx <= MapDirIdx; ++Idx) {
+    DirectoryLookup &SearchDir = SearchDirs[Idx];
+    if (SearchDir.isFramework()) {
+      SmallString<128> FrameworkDirName;
+      FrameworkDirName += SearchDir.getFrameworkDir()->getName();
+      llvm::sys::path::append(FrameworkDirName, ModuleName + ".framework");
+      if (FileMgr.getDirectory(FrameworkDirName))
+        return false;
+      continue;
+    }
+
+    if (!SearchDir.isNormalDir())
+      continue;
+
+    // The search directory itself.
+    const DirectoryEntry *Dir = SearchDir.getDir();
+    if (Dir == MapDir)
+      return true;
+    if (!hasNoNewModuleMaps(Dir))
+      return false;
+
+    // The subdirectory named after the module.
+    SmallString<128> NestedDirName;
+    NestedDirName += Dir->getName();
+    llvm::sys::path::append(NestedDirName, ModuleName);
+    const DirectoryEntry *NestedDir = FileMgr.getDirectory(NestedDirName);
+    if (NestedDir == MapDir)
+      return true;
+    if (NestedDir && !hasNoNewModuleMaps(NestedDir))
+      return false;
+
+    // The module map is in some other subdirectory of this search directory.
+    // The order in which those are visited is unspecified, so there is
+    // nothing more to compare against.
+    if (Idx == MapDirIdx)
+      return true;
+
+    // Every other subdirectory of an earlier search directory.
+    if (SearchDir.haveSearchedAllModuleMaps())
+      continue;
+    llvm::error_code EC;
+    SmallString<128> DirNative;
+    llvm::sys::path::native(Dir->getName(), DirNative);
+    for (llvm::sys::fs::directory_iterator Entry(DirNative.str(), EC), End;
+         Entry != End && !EC; Entry.increment(EC)) {
+      const DirectoryEntry *SubDir = FileMgr.getDirectory(Entry->path());
+      if (SubDir && SubDir != NestedDir && !hasNoNewModuleMaps(SubDir))
+        return false;
+    }
+    if (EC)
+      return false;
+  }
+  return true;
+}
+
+bool HeaderSearch::hasNoNewModuleMaps(const DirectoryEntry *Dir) {
+  // Header search never looks at a directory twice, and any module map it
+  // loaded from here doesn't define the module we're looking for.
+  if (DirectoryHasModuleMap.count(Dir))
+    return true;
+
+  // Adding a module map to a directory that had none, or adding a
+  // subdirectory, changes its modification time.
+  if (isKnownToHaveNoModuleMap(Dir))
+    return true;
+
+  // Otherwise the directory must have a module map (and possibly a private
+  // one) that the index recorded, unchanged.
+  static const char *const MapNames[] = { "module.map", "module_private.map" };
+  for (unsigned I = 0; I != llvm::array_lengthof(MapNames); ++I) {
+    SmallString<128> MapName;
+    MapName += Dir->getName();
+    llvm::sys::path::append(MapName, MapNames[I]);
+    const FileEntry *File = FileMgr.getFile(MapName);
+    if (!File) {
+      if (I == 0)
+        return false;
+      continue;
+    }
+
+    llvm::StringMap<std::pair<time_t, off_t> >::iterator Known
+      = IndexedModuleMapFiles.find(File->getName());
+    if (Known == IndexedModuleMapFiles.end() ||
+        Known->second.first != File->getModificationTime() ||
+        Known->second.second != File->getSize())
+      return false;
+  }
+  return true;
+}
+
+std::string HeaderSearch::getModuleMapIndexPath() const {
+  SmallString<256> Result(ModuleCachePath);
+  llvm::sys::path::append(Result, "modulemaps.idx");
+  return Result.str().str();
+}
+
+void HeaderSearch::loadModuleMapIndex() {
+  if (ModuleMapIndexLoaded)
+    return;
+  ModuleMapIndexLoaded = true;
+
+  if (!HSOpts->ModuleMapIndex || !enabledModules() || ModuleCachePath.empty())
+    return;
+
+  OwningPtr<llvm::MemoryBuffer> Buffer;
+  if (llvm::MemoryBuffer::getFile(getModuleMapIndexPath(), Buffer))
+    return;
+
+  SmallVector<StringRef, 64> Lines;
+  Buffer->getBuffer().split(Lines, "\n", -1, /*KeepEmpty=*/false);
+  if (Lines.empty() || Lines[0] != getModuleMapIndexSignature())
+    return;
+
+  for (unsigned I = 1, N = Lines.size(); I != N; ++I) {
+    SmallVector<StringRef, 6> Fields;
+    Lines[I].split(Fields, "\t");
+    if (Fields[0] == "M" && Fields.size() == 6) {
+      IndexedModuleMap Map;
+      long long ModTime, Size;
+      if (Fields[2].getAsInteger(10, ModTime) ||
+          Fields[3].getAsInteger(10, Size))
+        continue;
+      Map.IsSystem = Fields[1] == "1";
+      Map.ModTime = ModTime;
+      Map.Size = Size;
+      Map.FileName = Fields[4];
+      IndexedModules[Fields[5]] = Map;
+      IndexedModuleMapFiles[Map.FileName] = std::make_pair(Map.ModTime,
+                                                           Map.Size);
+    } else if (Fields[0] == "N" && Fields.size() == 3) {
+      long long ModTime;
+      if (Fields[1].getAsInteger(10, ModTime))
+        continue;
+      IndexedDirsWithoutModuleMap[Fields[2]] = ModTime;
+    }
+  }
+}
+
+Module *HeaderSearch::lookupModuleInIndex(StringRef ModuleName) {
+  loadModuleMapIndex();
+  llvm::StringMap<IndexedModuleMap>::iterator Known
+    = IndexedModules.find(ModuleName);
+  if (Known == IndexedModules.end())
+    return 0;
+
+  // Make sure the module map is still the one we indexed, and that the
+  // search would still look for it where it is.
+  const IndexedModuleMap &Map = Known->second;
+  const FileEntry *File = FileMgr.getFile(Map.FileName);
+  unsigned SearchDirIdx;
+  if (!File || File->getModificationTime() != Map.ModTime ||
+      File->getSize() != Map.Size ||
+      !findSearchDirectory(File->getDir(), SearchDirIdx)) {
+    IndexedModules.erase(Known);
+    ModuleMapIndexOutOfDate = true;
+    return 0;
+  }
+
+  // The search stops at the first module map that defines the module, so a
+  // module map added since to a directory searched earlier takes precedence.
+  if (!isSearchUnchangedBefore(ModuleName, SearchDirIdx, File->getDir()))
+    return 0;
+
+  // Load the module map (and any private module map) from its directory, just
+  // as the search would have.
+  if (loadModuleMapFile(File->getDir(), Map.IsSystem) == LMM_InvalidModuleMap)
+    return 0;
+
+  Module *Result = ModMap.findModule(ModuleName);
+  if (Result)
+    ++NumModuleMapIndexHits;
+  return Result;
+}
+
+bool HeaderSearch::isKnownToHaveNoModuleMap(const DirectoryEntry *Dir) {
+  loadModuleMapIndex();
+  if (IndexedDirsWithoutModuleMap.empty())
+    return false;
+
+  llvm::StringMap<time_t>::iterator Known
+    = IndexedDirsWithoutModuleMap.find(Dir->getName());
+  if (Known == IndexedDirsWithoutModuleMap.end())
+    return false;
+
+  // Adding a module map to the directory changes its modification time.
+  if (Dir->getModificationTime() == 0 ||
+      Known->second != Dir->getModificationTime()) {
+    IndexedDirsWithoutModuleMap.erase(Known);
+    ModuleMapIndexOutOfDate = true;
+    return false;
+  }
+  return true;
+}
+
+void HeaderSearch::noteDirectoryWithoutModuleMap(const DirectoryEntry *Dir) {
+  if (!HSOpts->ModuleMapIndex || Dir->getModificationTime() == 0)
+    return;
+
+  time_t &ModTime = IndexedDirsWithoutModuleMap[Dir->getName()];
+  if (ModTime != Dir->getModificationTime()) {
+    ModTime = Dir->getModificationTime();
+    ModuleMapIndexOutOfDate = true;
+  }
+}
+
+void HeaderSearch::writeModuleMapIndex() {
+  if (!HSOpts->ModuleMapIndex || !enabledModules() || ModuleCachePath.empty())
+    return;
+  loadModuleMapIndex();
+
+  // Record the module map that defines each top-level module we've seen.
+  for (ModuleMap::module_iterator M = ModMap.module_begin(),
+                               MEnd = ModMap.module_end();
+       M != MEnd; ++M) {
+    const FileEntry *File = ModMap.getContainingModuleMapFile(M->getValue());
+    if (!File)
+      continue;
+
+    // Only module maps found by header search can be found again this way.
+    llvm::DenseMap<const FileEntry *, bool>::iterator Loaded
+      = LoadedModuleMaps.find(File);
+    if (Loaded == LoadedModuleMaps.end())
+      continue;
+
+    IndexedModuleMap &Map = IndexedModules[M->getKey()];
+    if (Map.FileName == File->getName() &&
+        Map.ModTime == File->getModificationTime() &&
+        Map.Size == File->getSize() && Map.IsSystem == Loaded->second)
+      continue;
+    Map.FileName = File->getName();
+    Map.ModTime = File->getModificationTime();
+    Map.Size = File->getSize();
+    Map.IsSystem = Loaded->second;
+    ModuleMapIndexOutOfDate = true;
+  }
+
+  if (!ModuleMapIndexOutOfDate)
+    return;
+
+  // Write the index to a temporary file and move it into place, so that
+  // concurrent compilations never see a partial index.
+  if (llvm::sys::fs::create_directories(ModuleCachePath))
+    return;
+  std::string IndexPath = getModuleMapIndexPath();
+  SmallString<256> TempPath(IndexPath);
+  TempPath += "-%%%%%%%%";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(TempPath.str(), FD, TempPath))
+    return;
+
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    Out << getModuleMapIndexSignature() << '\n';
+    for (llvm::StringMap<IndexedModuleMap>::iterator
+           I = IndexedModules.begin(), E = IndexedModules.end(); I != E; ++I) {
+      const IndexedModuleMap &Map = I->getValue();
+      if (Map.FileName.find_first_of("\t\n") != std::string::npos)
+        continue;
+      Out << "M\t" << (Map.IsSystem ? 1 : 0) << '\t'
+          << (long long)Map.ModTime << '\t' << (long long)Map.Size << '\t'
+          << Map.FileName << '\t' << I->getKey() << '\n';
+    }
+    for (llvm::StringMap<time_t>::iterator
+           I = IndexedDirsWithoutModuleMap.begin(),
+           E = IndexedDirsWithoutModuleMap.end(); I != E; ++I) {
+      if (I->getKey().find_first_of("\t\n") != StringRef::npos)
+        continue;
+      Out << "N\t" << (long long)I->getValue() << '\t' << I->getKey()
+          << '\n';
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath.str(), IndexPath)) {
+    llvm::sys::fs::remove(TempPath.str());
+    return;
+  }
+  ModuleMapIndexOutOfDate = false;
+}
@@ -0,0 +1,121 @@
+//===--- HeaderTokenCache.cpp - Per-header pretokenized cache -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the HeaderTokenCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/HeaderTokenCache.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
+#include "clang/Lex/PTHManager.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace clang;
+
+HeaderTokenCache::HeaderTokenCache(StringRef Directory,
+                                   const LangOptions &LangOpts)
+  : Directory(Directory), NumHits(0), NumMisses(0) {
+  using llvm::hash_code;
+  using llvm::hash_value;
+  using llvm::hash_combine;
+
+  // Token kinds are only stable within a compiler version and PTH format.
+  hash_code Code = hash_combine(hash_value(getClangFullRepositoryVersion()),
+                                unsigned(PTHManager::Version));
+
+  // Most language options affect how the raw lexer splits tokens.
+#define LANGOPT(Name, Bits, Default, Description) \
+  Code = hash_combine(Code, LangOpts.Name);
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description) \
+  Code = hash_combine(Code, static_cast<unsigned>(LangOpts.get##Name()));
+#define BENIGN_LANGOPT(Name, Bits, Default, Description)
+#define BENIGN_ENUM_LANGOPT(Name, Type, Bits, Default, Description)
+#include "clang/Basic/LangOptions.def"
+
+  ConfigurationHash = Code;
+}
+
+HeaderTokenCache::~HeaderTokenCache() {
+  for (llvm::DenseMap<const FileEntry *, PTHManager *>::iterator
+         I = Managers.begin(), E = Managers.end(); I != E; ++I)
+    delete I->second;
+}
+
+std::string HeaderTokenCache::getCacheFileName(const FileEntry *File) const {
+  const llvm::sys::fs::UniqueID &ID = File->getUniqueID();
+  size_t Key = llvm::hash_combine(ConfigurationHash, ID.getDevice(),
+                                  ID.getFile(),
+                                  uint64_t(File->getModificationTime()),
+                                  uint64_t(File->getSize()));
+
+  SmallString<128> Path(Directory);
+  llvm::sys::path::append(Path, llvm::utohexstr(Key) + ".pth");
+  return Path.str();
+}
+
+PTHLexer *HeaderTokenCache::CreateLexer(Preprocessor &PP, FileID FID) {
+  const FileEntry *File = PP.getSourceManager().getFileEntryForID(FID);
+  if (!File || PP.getSourceManager().isFileOverridden(File))
+    return 0;
+
+  std::pair<llvm::DenseMap<const FileEntry *, PTHManager *>::iterator, bool>
+    Known = Managers.insert(std::make_pair(File, (PTHManager *)0));
+  if (Known.second) {
+    Known.first->second =
+      PTHManager::CreateHeaderCache(getCacheFileName(File), PP);
+    if (!Known.first->second)
+      Misses.push_back(FID);
+  }
+
+  if (PTHManager *Mgr = Known.first->second) {
+    if (PTHLexer *L = Mgr->CreateHeaderLexer(FID)) {
+      ++NumHits;
+      return L;
+    }
+  }
+
+  ++NumMisses;
+  return 0;
+}
+
+void HeaderTokenCache::noteLexerDiagnostic(Preprocessor &PP,
+                                           SourceLocation Loc,
+                                           unsigned DiagID) {
+  // Only system headers use the cache, and only when warnings in them are
+  // suppressed, so warnings ignored here would be ignored with any flags.
+  if (!Loc.isFileID() ||
+      (DiagnosticIDs::isBuiltinWarningOrExtension(DiagID) &&
+       PP.getDiagnostics().getDiagnosticLevel(DiagID, Loc) ==
+         DiagnosticsEngine::Ignored))
+    return;
+
+  SourceManager &SM = PP.getSourceManager();
+  const FileEntry *File = SM.getFileEntryForID(SM.getFileID(Loc));
+  llvm::DenseMap<const FileEntry *, PTHManager *>::iterator Known =
+    Managers.find(File);
+  if (Known != Managers.end() && !Known->second)
+    Uncacheable.insert(File);
+}
+
+void HeaderTokenCache::PrintStats() const {
+  llvm::errs() << "\n*** Header Token Cache Stats:\n";
+  llvm::errs() << "  " << NumHits << " headers lexed from the cache.\n";
+  llvm::errs() << "  " << NumMisses << " headers lexed from source.\n";
+  llvm::errs() << "  " << Misses.size() - Uncacheable.size()
+               << " new cache entries needed.\n";
+  llvm::errs() << "  " << Uncacheable.size()
+               << " headers not cached because of lexer diagnostics.\n";
+}
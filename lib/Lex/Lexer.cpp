@@ -29,6 +29,7 @@
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/CodeCompletionHandler.h"
+#include "clang/Lex/HeaderTokenCache.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/LiteralSupport.h"
 #include "clang/Lex/Preprocessor.h"
@@ -1080,7 +1081,10 @@ SourceLocation Lexer::getSourceLocation(const char *Loc,
 /// Diag - Forwarding function for diagnostics.  This translate a source
 /// position in the current buffer into a SourceLocation object for rendering.
 DiagnosticBuilder Lexer::Diag(const char *Loc, unsigned DiagID) const {
-  return PP->Diag(getSourceLocation(Loc), DiagID);
+  SourceLocation DiagLoc = getSourceLocation(Loc);
+  if (HeaderTokenCache *Cache = PP->getHeaderTokenCache())
+    Cache->noteLexerDiagnostic(*PP, DiagLoc, DiagID);
+  return PP->Diag(DiagLoc, DiagID);
 }
 
 //===----------------------------------------------------------------------===//
@@ -1450,9 +1454,19 @@ static void maybeDiagnoseIDCharCompat(DiagnosticsEngine &Diags, uint32_t C,
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+
+  // Hash the identifier as we scan it, so that looking it up in the
+  // identifier table doesn't have to go over it again.
+  unsigned Hash = IdentifierTable::EmptyHash;
+  for (const char *Ptr = BufferPtr; Ptr != CurPtr; ++Ptr)
+    Hash = IdentifierTable::extendHash(Hash, *Ptr);
+  bool HaveHash = true;
+
   unsigned char C = *CurPtr++;
-  while (isIdentifierBody(C))
+  while (isIdentifierBody(C)) {
+    Hash = IdentifierTable::extendHash(Hash, C);
     C = *CurPtr++;
+  }
 
   --CurPtr;   // Back up over the skipped character.
 
@@ -1475,7 +1489,8 @@ FinishIdentifier:
 
     // Fill in Result.IdentifierInfo and update the token kind,
     // looking up the identifier in the identifier table.
-    IdentifierInfo *II = PP->LookUpIdentifierInfo(Result);
+    IdentifierInfo *II = HaveHash ? PP->LookUpIdentifierInfo(Result, Hash)
+                                  : PP->LookUpIdentifierInfo(Result);
 
     // Finally, now that we know we have an identifier, pass this off to the
     // preprocessor, which may macro expand it or something.
@@ -1485,7 +1500,9 @@ FinishIdentifier:
     return true;
   }
 
-  // Otherwise, $,\,? in identifier found.  Enter slower path.
+  // Otherwise, $,\,? in identifier found.  Enter slower path; the hash won't
+  // cover the rest of the identifier.
+  HaveHash = false;
 
   C = getCharAndSize(CurPtr, Size);
   while (1) {
@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Lex/Preprocessor.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/CodeCompletionHandler.h"
@@ -660,6 +661,11 @@ private:
 void Preprocessor::HandleDirective(Token &Result) {
   // FIXME: Traditional: # with whitespace before it not recognized by K&R?
 
+  // Plain definitions in the predefines buffer take a shortcut.
+  if (CurLexer && CurLexer->getFileID() == getPredefinesFileID() &&
+      HandlePredefinesDefineDirective())
+    return;
+
   // We just parsed a # character at the start of a line, so we're in directive
   // mode.  Tell the lexer this so any newlines we see will be converted into an
   // EOD token (which terminates the directive).
@@ -2100,6 +2106,106 @@ void Preprocessor::HandleDefineDirective(Token &DefineTok,
     Callbacks->MacroDefined(MacroNameTok, MD);
 }
 
+/// \brief Try to handle a \#define line of the predefines buffer without
+/// going through the general directive machinery.
+///
+/// The predefines buffer is made of hundreds of object-like definitions of
+/// the form "#define NAME VALUE" produced by the driver and by
+/// InitPreprocessor.  None of the checks performed on user-written
+/// definitions can fire for them, so their bodies are raw-lexed straight out
+/// of the buffer.  Anything unusual (function-like macros, redefinitions,
+/// comments, line continuations, ...) is left to HandleDirective, as is
+/// anything the lexer or the preprocessor might diagnose (string and
+/// character literals, trigraphs, digraphs, '$' and poisoned identifiers such
+/// as __VA_ARGS__), so that -D options keep their diagnostics.
+///
+/// \returns true if the line was handled, in which case the lexer has been
+/// moved to the start of the next line.
+bool Preprocessor::HandlePredefinesDefineDirective() {
+  if (KeepMacroComments || InMacroArgs)
+    return false;
+
+  const char *BufStart = CurLexer->BufferStart;
+  const char *BufEnd = CurLexer->BufferEnd;
+  const char *Ptr = CurLexer->BufferPtr;
+  if (BufEnd - Ptr < 7 || memcmp(Ptr, "define ", 7) != 0)
+    return false;
+
+  const char *NameStart = Ptr + 7;
+  const char *NameEnd = NameStart;
+  if (!isIdentifierHead(*NameStart))
+    return false;
+  while (isIdentifierBody(*NameEnd))
+    ++NameEnd;
+  if (*NameEnd != ' ')
+    return false;
+
+  const char *LineEnd =
+    static_cast<const char *>(memchr(NameEnd, '\n', BufEnd - NameEnd));
+  if (!LineEnd)
+    return false;
+  for (const char *C = NameEnd; C != LineEnd; ++C) {
+    switch (*C) {
+    case '\\': case '/': case '#': case '\r':
+    case '"': case '\'': case '?': case '%': case '$':
+      return false;
+    default:
+      if (!isASCII(*C))
+        return false;
+    }
+  }
+
+  IdentifierInfo *II = getIdentifierInfo(StringRef(NameStart,
+                                                   NameEnd - NameStart));
+  if (II->hasMacroDefinition() || II->isPoisoned() ||
+      II->isCPlusPlusOperatorKeyword() ||
+      II->getPPKeywordID() == tok::pp_defined)
+    return false;
+
+  SourceLocation FileLoc = SourceMgr.getLocForStartOfFile(getPredefinesFileID());
+  Token MacroNameTok;
+  MacroNameTok.startToken();
+  MacroNameTok.setKind(tok::identifier);
+  MacroNameTok.setIdentifierInfo(II);
+  MacroNameTok.setLocation(FileLoc.getLocWithOffset(NameStart - BufStart));
+  MacroNameTok.setLength(NameEnd - NameStart);
+
+  // Raw-lex the body up to the end of the line.
+  SmallVector<Token, 8> Body;
+  SourceLocation LineEndLoc = FileLoc.getLocWithOffset(LineEnd - BufStart);
+  Lexer RawLex(FileLoc, getLangOpts(), BufStart, NameEnd, BufEnd);
+  Token Tok;
+  while (true) {
+    RawLex.LexFromRawLexer(Tok);
+    if (Tok.is(tok::eof) || !(Tok.getLocation() < LineEndLoc))
+      break;
+    if (Tok.is(tok::raw_identifier) && LookUpIdentifierInfo(Tok)->isPoisoned())
+      return false;
+    Tok.clearFlag(Token::StartOfLine);
+    if (Body.empty())
+      Tok.clearFlag(Token::LeadingSpace);
+    Body.push_back(Tok);
+  }
+
+  ++NumDirectives;
+  ++NumDefined;
+
+  MacroInfo *MI = AllocateMacroInfo(MacroNameTok.getLocation());
+  SourceLocation LastLoc = MacroNameTok.getLocation();
+  for (unsigned I = 0, N = Body.size(); I != N; ++I) {
+    MI->AddTokenToBody(Body[I]);
+    LastLoc = Body[I].getLocation();
+  }
+  MI->setDefinitionEndLoc(LastLoc);
+
+  DefMacroDirective *MD = appendDefMacroDirective(II, MI);
+  if (Callbacks)
+    Callbacks->MacroDefined(MacroNameTok, MD);
+
+  CurLexer->SkipBytes(LineEnd + 1 - CurLexer->BufferPtr, /*StartOfLine=*/true);
+  return true;
+}
+
 /// HandleUndefDirective - Implements \#undef.
 ///
 void Preprocessor::HandleUndefDirective(Token &UndefTok) {
@@ -2180,7 +2286,7 @@ void Preprocessor::HandleIfdefDirective(Token &Result, bool isIfndef,
       assert(isIfndef && "#ifdef shouldn't reach here");
       CurPPLexer->MIOpt.EnterTopLevelIfndef(MII, MacroNameTok.getLocation());
     } else
-      CurPPLexer->MIOpt.EnterTopLevelConditional();
+      CurPPLexer->MIOpt.EnterTopLevelConditional(ReadAnyTokensBeforeDirective);
   }
 
   // If there is a macro, process it.
@@ -2216,18 +2322,23 @@ void Preprocessor::HandleIfDirective(Token &IfToken,
 
   // Parse and evaluate the conditional expression.
   IdentifierInfo *IfNDefMacro = 0;
+  bool IfNDefConjunct = false;
   const SourceLocation ConditionalBegin = CurPPLexer->getSourceLocation();
-  const bool ConditionalTrue = EvaluateDirectiveExpression(IfNDefMacro);
+  const bool ConditionalTrue = EvaluateDirectiveExpression(IfNDefMacro,
+                                                           &IfNDefConjunct);
   const SourceLocation ConditionalEnd = CurPPLexer->getSourceLocation();
 
-  // If this condition is equivalent to #ifndef X, and if this is the first
-  // directive seen, handle it for the multiple-include optimization.
+  // If this condition is equivalent to #ifndef X (possibly with further
+  // conditions and'ed on), and if this is the first directive seen, handle it
+  // for the multiple-include optimization.  Once X is defined the condition
+  // is false no matter what the rest of it says.
   if (CurPPLexer->getConditionalStackDepth() == 0) {
     if (!ReadAnyTokensBeforeDirective && IfNDefMacro && ConditionalTrue)
       // FIXME: Pass in the location of the macro name, not the 'if' token.
-      CurPPLexer->MIOpt.EnterTopLevelIfndef(IfNDefMacro, IfToken.getLocation());
+      CurPPLexer->MIOpt.EnterTopLevelIfndef(IfNDefMacro, IfToken.getLocation(),
+                                            IfNDefConjunct);
     else
-      CurPPLexer->MIOpt.EnterTopLevelConditional();
+      CurPPLexer->MIOpt.EnterTopLevelConditional(ReadAnyTokensBeforeDirective);
   }
 
   if (Callbacks)
@@ -2289,7 +2400,7 @@ void Preprocessor::HandleElseDirective(Token &Result) {
 
   // If this is a top-level #else, inform the MIOpt.
   if (CurPPLexer->getConditionalStackDepth() == 0)
-    CurPPLexer->MIOpt.EnterTopLevelConditional();
+    CurPPLexer->MIOpt.EnterTopLevelElse();
 
   // If this is a #else with a #else before it, report the error.
   if (CI.FoundElse) Diag(Result, diag::pp_err_else_after_else);
@@ -2322,7 +2433,7 @@ void Preprocessor::HandleElifDirective(Token &ElifToken) {
 
   // If this is a top-level #elif, inform the MIOpt.
   if (CurPPLexer->getConditionalStackDepth() == 0)
-    CurPPLexer->MIOpt.EnterTopLevelConditional();
+    CurPPLexer->MIOpt.EnterTopLevelElse();
 
   // If this is a #elif with a #else before it, report the error.
   if (CI.FoundElse) Diag(ElifToken, diag::pp_err_elif_after_else);
@@ -56,7 +56,8 @@ public:
 
 static bool EvaluateDirectiveSubExpr(PPValue &LHS, unsigned MinPrec,
                                      Token &PeekTok, bool ValueLive,
-                                     Preprocessor &PP);
+                                     Preprocessor &PP,
+                                     bool *OnlyConjunctions = 0);
 
 /// DefinedTracker - This struct is used while parsing expressions to keep track
 /// of whether !defined(X) has been seen.
@@ -455,9 +456,14 @@ static unsigned getPrecedence(tok::TokenKind Kind) {
 /// If ValueLive is false, then this value is being evaluated in a context where
 /// the result is not used.  As such, avoid diagnostics that relate to
 /// evaluation, such as division by zero warnings.
+///
+/// If OnlyConjunctions is non-null, it is cleared if an operator other than
+/// '&&' is applied to LHS at this level, i.e. if LHS is not known to be false
+/// whenever its initial value is.
 static bool EvaluateDirectiveSubExpr(PPValue &LHS, unsigned MinPrec,
                                      Token &PeekTok, bool ValueLive,
-                                     Preprocessor &PP) {
+                                     Preprocessor &PP,
+                                     bool *OnlyConjunctions) {
   unsigned PeekPrec = getPrecedence(PeekTok.getKind());
   // If this token isn't valid, report the error.
   if (PeekPrec == ~0U) {
@@ -473,6 +479,8 @@ static bool EvaluateDirectiveSubExpr(PPValue &LHS, unsigned MinPrec,
       return false;
 
     tok::TokenKind Operator = PeekTok.getKind();
+    if (OnlyConjunctions && Operator != tok::ampamp)
+      *OnlyConjunctions = false;
 
     // If this is a short-circuiting operator, see if the RHS of the operator is
     // dead.  Note that this cannot just clobber ValueLive.  Consider
@@ -734,9 +742,11 @@ static bool EvaluateDirectiveSubExpr(PPValue &LHS, unsigned MinPrec,
 
 /// EvaluateDirectiveExpression - Evaluate an integer constant expression that
 /// may occur after a #if or #elif directive.  If the expression is equivalent
-/// to "!defined(X)" return X in IfNDefMacro.
+/// to "!defined(X)" return X in IfNDefMacro.  If IfNDefConjunct is non-null,
+/// also do so for "!defined(X) && ...", and set *IfNDefConjunct.
 bool Preprocessor::
-EvaluateDirectiveExpression(IdentifierInfo *&IfNDefMacro) {
+EvaluateDirectiveExpression(IdentifierInfo *&IfNDefMacro,
+                            bool *IfNDefConjunct) {
   SaveAndRestore<bool> PPDir(ParsingIfOrElifDirective, true);
   // Save the current state of 'DisableMacroExpansion' and reset it to false. If
   // 'DisableMacroExpansion' is true, then we must be in a macro argument list
@@ -780,10 +790,18 @@ EvaluateDirectiveExpression(IdentifierInfo *&IfNDefMacro) {
     return ResVal.Val != 0;
   }
 
+  // If the leading operand is !defined(X) and nothing has been macro expanded
+  // so far, the whole expression is false whenever X is defined as long as
+  // only '&&' is applied to it.  The rest of the line may expand macros freely.
+  bool OnlyConjunctions = IfNDefConjunct &&
+    DT.State == DefinedTracker::NotDefinedMacro &&
+    CurPPLexer && !CurPPLexer->MIOpt.getDidMacroExpansion();
+
   // Otherwise, we must have a binary operator (e.g. "#if 1 < 2"), so parse the
   // operator and the stuff after it.
   if (EvaluateDirectiveSubExpr(ResVal, getPrecedence(tok::question),
-                               Tok, true, *this)) {
+                               Tok, true, *this,
+                               OnlyConjunctions ? &OnlyConjunctions : 0)) {
     // Parse error, skip the rest of the macro line.
     if (Tok.isNot(tok::eod))
       DiscardUntilEndOfDirective();
@@ -798,6 +816,9 @@ EvaluateDirectiveExpression(IdentifierInfo *&IfNDefMacro) {
   if (Tok.isNot(tok::eod)) {
     Diag(Tok, diag::err_pp_expected_eol);
     DiscardUntilEndOfDirective();
+  } else if (OnlyConjunctions) {
+    IfNDefMacro = DT.TheMacro;
+    *IfNDefConjunct = true;
   }
 
   // Restore 'DisableMacroExpansion'.
@@ -16,6 +16,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderTokenCache.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/MacroInfo.h"
 #include "llvm/ADT/StringSwitch.h"
@@ -26,6 +27,8 @@ using namespace clang;
 
 PPCallbacks::~PPCallbacks() {}
 
+PPTokenObserver::~PPTokenObserver() {}
+
 //===----------------------------------------------------------------------===//
 // Miscellaneous Methods.
 //===----------------------------------------------------------------------===//
@@ -82,6 +85,22 @@ void Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
       return;
     }
   }
+
+  // Only system headers are taken from the header token cache: the cached
+  // tokens carry neither comments nor lexer warnings, both of which are
+  // dropped for system headers anyway.  Headers with lexer errors are never
+  // cached.
+  if (HeaderTokCache && FID != SourceMgr.getMainFileID() && !KeepComments &&
+      !isCodeCompletionEnabled() &&
+      !getLangOpts().RetainCommentsFromSystemHeaders &&
+      getDiagnostics().getSuppressSystemWarnings() &&
+      SourceMgr.getFileCharacteristic(SourceMgr.getLocForStartOfFile(FID)) !=
+        SrcMgr::C_User) {
+    if (PTHLexer *PL = HeaderTokCache->CreateLexer(*this, FID)) {
+      EnterSourceFileWithPTH(PL, CurDir, IsSubmodule);
+      return;
+    }
+  }
   
   // Get the MemoryBuffer for this FID, if it fails, we fail.
   bool Invalid = false;
@@ -94,6 +113,11 @@ void Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
     return;
   }
 
+  // Start reading the headers this file includes while we lex it.
+  if (FileMgr.getPrefetcher())
+    if (const FileEntry *File = SourceMgr.getFileEntryForID(FID))
+      HeaderInfo.prefetchIncludes(File, InputFile->getBuffer());
+
   if (isCodeCompletionEnabled() &&
       SourceMgr.getFileEntryForID(FID) == CodeCompletionFile) {
     CodeCompletionFileLoc = SourceMgr.getLocForStartOfFile(FID);
@@ -281,6 +305,14 @@ bool Preprocessor::HandleEndOfFile(Token &Result, bool isEndOfMacro) {
 
   // See if this file had a controlling macro.
   if (CurPPLexer) {  // Not ending a macro, ignore it.
+    // Remember why the file can't be skipped next time, for -print-stats.
+    // Later inclusions see the guard macro defined, which is not interesting.
+    if (const FileEntry *FE =
+          SourceMgr.getFileEntryForID(CurPPLexer->getFileID()))
+      if (HeaderInfo.FirstTimeLexingFile(FE))
+        HeaderInfo.SetFileGuardFailure(FE,
+                               CurPPLexer->MIOpt.GetGuardFailureAtEndOfFile());
+
     if (const IdentifierInfo *ControllingMacro =
           CurPPLexer->MIOpt.GetControllingMacroAtEndOfFile()) {
       // Okay, this has a controlling macro, remember in HeaderFileInfo.
@@ -350,6 +350,27 @@ public:
   }
 };
 
+/// PTHFileNameLookupTrait - Looks up file entries by name, as done for the
+///  single file of a per-header token cache.
+class PTHFileNameLookupTrait : public PTHFileLookupCommonTrait {
+public:
+  typedef const char* external_key_type;
+  typedef PTHFileData data_type;
+
+  static internal_key_type GetInternalKey(const char *Name) {
+    return std::make_pair((unsigned char) 0x1, Name);
+  }
+
+  static bool EqualKey(internal_key_type a, internal_key_type b) {
+    return a.first == b.first && strcmp(a.second, b.second) == 0;
+  }
+
+  static PTHFileData ReadData(const internal_key_type& k,
+                              const unsigned char* d, unsigned) {
+    return PTHFileLookupTrait::ReadData(k, d, 0);
+  }
+};
+
 class PTHStringLookupTrait {
 public:
   typedef uint32_t
@@ -409,7 +430,9 @@ PTHManager::PTHManager(const llvm::MemoryBuffer* buf, void* fileLookup,
 : Buf(buf), PerIDCache(perIDCache), FileLookup(fileLookup),
   IdDataTable(idDataTable), StringIdLookup(stringIdLookup),
   NumIds(numIds), PP(0), SpellingBase(spellingBase),
-  OriginalSourceFile(originalSourceFile) {}
+  OriginalSourceFile(originalSourceFile), ResolveInIdentifierTable(false) {}
+
+const char PTHManager::HeaderCacheFileName[] = "<header>";
 
 PTHManager::~PTHManager() {
   delete Buf;
@@ -418,18 +441,48 @@ PTHManager::~PTHManager() {
   free(PerIDCache);
 }
 
-static void InvalidPTH(DiagnosticsEngine &Diags, const char *Msg) {
-  Diags.Report(Diags.getCustomDiagID(DiagnosticsEngine::Error, "%0")) << Msg;
+static void InvalidPTH(DiagnosticsEngine *Diags, const char *Msg) {
+  if (Diags)
+    Diags->Report(Diags->getCustomDiagID(DiagnosticsEngine::Error, "%0"))
+      << Msg;
+}
+
+static void InvalidPTHFile(DiagnosticsEngine *Diags, const std::string &file) {
+  if (Diags)
+    Diags->Report(diag::err_invalid_pth_file) << file;
 }
 
 PTHManager *PTHManager::Create(const std::string &file,
                                DiagnosticsEngine &Diags) {
+  PTHManager *PTHMgr = Load(file, &Diags);
+
+  // Warn if the PTH file is empty.  We still want to create a PTHManager
+  // as the PTH could be used with -include-pth.
+  if (PTHMgr && ((PTHFileLookup*) PTHMgr->FileLookup)->isEmpty())
+    InvalidPTH(&Diags, "PTH file contains no cached source data");
+
+  return PTHMgr;
+}
+
+PTHManager *PTHManager::CreateHeaderCache(const std::string &file,
+                                          Preprocessor &PP) {
+  PTHManager *PTHMgr = Load(file, 0);
+  if (!PTHMgr)
+    return 0;
+
+  PTHMgr->ResolveInIdentifierTable = true;
+  PTHMgr->setPreprocessor(&PP);
+  return PTHMgr;
+}
+
+PTHManager *PTHManager::Load(const std::string &file,
+                             DiagnosticsEngine *Diags) {
   // Memory map the PTH file.
   OwningPtr<llvm::MemoryBuffer> File;
 
   if (llvm::MemoryBuffer::getFile(file, File)) {
     // FIXME: Add ec.message() to this diag.
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return 0;
   }
 
@@ -441,7 +494,7 @@ PTHManager *PTHManager::Create(const std::string &file,
   // Check the prologue of the file.
   if ((BufEnd - BufBeg) < (signed)(sizeof("cfe-pth") + 4 + 4) ||
       memcmp(BufBeg, "cfe-pth", sizeof("cfe-pth")) != 0) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return 0;
   }
 
@@ -461,7 +514,7 @@ PTHManager *PTHManager::Create(const std::string &file,
   const unsigned char *PrologueOffset = p;
 
   if (PrologueOffset >= BufEnd) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return 0;
   }
 
@@ -471,24 +524,19 @@ PTHManager *PTHManager::Create(const std::string &file,
   const unsigned char* FileTable = BufBeg + ReadLE32(FileTableOffset);
 
   if (!(FileTable > BufBeg && FileTable < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return 0; // FIXME: Proper error diagnostic?
   }
 
   OwningPtr<PTHFileLookup> FL(PTHFileLookup::Create(FileTable, BufBeg));
 
-  // Warn if the PTH file is empty.  We still want to create a PTHManager
-  // as the PTH could be used with -include-pth.
-  if (FL->isEmpty())
-    InvalidPTH(Diags, "PTH file contains no cached source data");
-
   // Get the location of the table mapping from persistent ids to the
   // data needed to reconstruct identifiers.
   const unsigned char* IDTableOffset = PrologueOffset + sizeof(uint32_t)*0;
   const unsigned char* IData = BufBeg + ReadLE32(IDTableOffset);
 
   if (!(IData >= BufBeg && IData < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return 0;
   }
 
@@ -497,7 +545,7 @@ PTHManager *PTHManager::Create(const std::string &file,
   const unsigned char* StringIdTableOffset = PrologueOffset + sizeof(uint32_t)*1;
   const unsigned char* StringIdTable = BufBeg + ReadLE32(StringIdTableOffset);
   if (!(StringIdTable >= BufBeg && StringIdTable < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return 0;
   }
 
@@ -508,7 +556,7 @@ PTHManager *PTHManager::Create(const std::string &file,
   const unsigned char* spellingBaseOffset = PrologueOffset + sizeof(uint32_t)*3;
   const unsigned char* spellingBase = BufBeg + ReadLE32(spellingBaseOffset);
   if (!(spellingBase >= BufBeg && spellingBase < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return 0;
   }
 
@@ -545,13 +593,20 @@ IdentifierInfo* PTHManager::LazilyCreateIdentifierInfo(unsigned PersistentID) {
   const unsigned char* IDData =
     (const unsigned char*)Buf->getBufferStart() + ReadLE32(TableEntry);
   assert(IDData < (const unsigned char*)Buf->getBufferEnd());
+  assert(IDData[0] != '\0');
+
+  // Per-header caches share the identifiers of the translation unit.
+  if (ResolveInIdentifierTable) {
+    IdentifierInfo *II = PP->getIdentifierInfo((const char*) IDData);
+    PerIDCache[PersistentID] = II;
+    return II;
+  }
 
   // Allocate the object.
   std::pair<IdentifierInfo,const unsigned char*> *Mem =
     Alloc.Allocate<std::pair<IdentifierInfo,const unsigned char*> >();
 
   Mem->second = IDData;
-  assert(IDData[0] != '\0');
   IdentifierInfo *II = new ((void*) Mem) IdentifierInfo();
 
   // Store the new IdentifierInfo in the cache.
@@ -603,6 +658,28 @@ PTHLexer *PTHManager::CreateLexer(FileID FID) {
   return new PTHLexer(*PP, FID, data, ppcond, *this);
 }
 
+PTHLexer *PTHManager::CreateHeaderLexer(FileID FID) {
+  typedef OnDiskChainedHashTable<PTHFileNameLookupTrait> NameLookupTy;
+  PTHFileLookup &PFL = *((PTHFileLookup*)FileLookup);
+  NameLookupTy NameLookup(PFL.getNumBuckets(), PFL.getNumEntries(),
+                          PFL.getBuckets(), PFL.getBase());
+
+  NameLookupTy::iterator I = NameLookup.find(HeaderCacheFileName);
+  if (I == NameLookup.end())
+    return 0;
+
+  const PTHFileData& FileData = *I;
+
+  const unsigned char *BufStart = (const unsigned char *)Buf->getBufferStart();
+  const unsigned char* data = BufStart + FileData.getTokenOffset();
+  const unsigned char* ppcond = BufStart + FileData.getPPCondOffset();
+  uint32_t Len = ReadLE32(ppcond);
+  if (Len == 0) ppcond = 0;
+
+  assert(PP && "No preprocessor set yet!");
+  return new PTHLexer(*PP, FID, data, ppcond, *this);
+}
+
 //===----------------------------------------------------------------------===//
 // 'stat' caching.
 //===----------------------------------------------------------------------===//
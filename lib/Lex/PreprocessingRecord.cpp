@@ -14,6 +14,7 @@
 #include "clang/Lex/PreprocessingRecord.h"
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/Token.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/ErrorHandling.h"
 
@@ -40,6 +41,7 @@ InclusionDirective::InclusionDirective(PreprocessingRecord &PPRec,
 
 PreprocessingRecord::PreprocessingRecord(SourceManager &SM)
   : SourceMgr(SM),
+    RestrictToRecordedFiles(false), LastCheckedFileIsRecorded(false),
     ExternalSource(0) {
 }
 
@@ -119,8 +121,10 @@ bool PreprocessingRecord::isEntityInFileID(iterator PPEI, FileID FID) {
     assert(0 && "Out-of bounds local preprocessed entity");
     return false;
   }
-  return isPreprocessedEntityIfInFileID(PreprocessedEntities[Pos],
-                                        FID, SourceMgr);
+  SourceLocation Loc = LocalEntityRanges[Pos].getBegin();
+  if (Loc.isInvalid())
+    return false;
+  return SourceMgr.isInFileID(SourceMgr.getFileLoc(Loc), FID);
 }
 
 /// \brief Returns a pair of [Begin, End) iterators of preprocessed entities
@@ -169,31 +173,22 @@ PreprocessingRecord::findLocalPreprocessedEntitiesInRange(
 
 namespace {
 
-template <SourceLocation (SourceRange::*getRangeLoc)() const>
-struct PPEntityComp {
+/// \brief Orders entity source ranges by their begin location.
+struct PPEntityBeginComp {
   const SourceManager &SM;
 
-  explicit PPEntityComp(const SourceManager &SM) : SM(SM) { }
-
-  bool operator()(PreprocessedEntity *L, PreprocessedEntity *R) const {
-    SourceLocation LHS = getLoc(L);
-    SourceLocation RHS = getLoc(R);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
-  }
+  explicit PPEntityBeginComp(const SourceManager &SM) : SM(SM) { }
 
-  bool operator()(PreprocessedEntity *L, SourceLocation RHS) const {
-    SourceLocation LHS = getLoc(L);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
+  bool operator()(const SourceRange &L, const SourceRange &R) const {
+    return SM.isBeforeInTranslationUnit(L.getBegin(), R.getBegin());
   }
 
-  bool operator()(SourceLocation LHS, PreprocessedEntity *R) const {
-    SourceLocation RHS = getLoc(R);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
+  bool operator()(const SourceRange &L, SourceLocation RHS) const {
+    return SM.isBeforeInTranslationUnit(L.getBegin(), RHS);
   }
 
-  SourceLocation getLoc(PreprocessedEntity *PPE) const {
-    SourceRange Range = PPE->getSourceRange();
-    return (Range.*getRangeLoc)();
+  bool operator()(SourceLocation LHS, const SourceRange &R) const {
+    return SM.isBeforeInTranslationUnit(LHS, R.getBegin());
   }
 };
 
@@ -204,11 +199,10 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  size_t Count = PreprocessedEntities.size();
+  size_t Count = LocalEntityRanges.size();
   size_t Half;
-  std::vector<PreprocessedEntity *>::const_iterator
-    First = PreprocessedEntities.begin();
-  std::vector<PreprocessedEntity *>::const_iterator I;
+  std::vector<SourceRange>::const_iterator First = LocalEntityRanges.begin();
+  std::vector<SourceRange>::const_iterator I;
 
   // Do a binary search manually instead of using std::lower_bound because
   // The end locations of entities may be unordered (when a macro expansion
@@ -218,8 +212,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
     Half = Count/2;
     I = First;
     std::advance(I, Half);
-    if (SourceMgr.isBeforeInTranslationUnit((*I)->getSourceRange().getEnd(),
-                                            Loc)){
+    if (SourceMgr.isBeforeInTranslationUnit(I->getEnd(), Loc)) {
       First = I;
       ++First;
       Count = Count - Half - 1;
@@ -227,7 +220,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
       Count = Half;
   }
 
-  return First - PreprocessedEntities.begin();
+  return First - LocalEntityRanges.begin();
 }
 
 unsigned PreprocessingRecord::findEndLocalPreprocessedEntity(
@@ -235,33 +228,40 @@ unsigned PreprocessingRecord::findEndLocalPreprocessedEntity(
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  std::vector<PreprocessedEntity *>::const_iterator
-  I = std::upper_bound(PreprocessedEntities.begin(),
-                       PreprocessedEntities.end(),
-                       Loc,
-                       PPEntityComp<&SourceRange::getBegin>(SourceMgr));
-  return I - PreprocessedEntities.begin();
+  std::vector<SourceRange>::const_iterator
+  I = std::upper_bound(LocalEntityRanges.begin(), LocalEntityRanges.end(),
+                       Loc, PPEntityBeginComp(SourceMgr));
+  return I - LocalEntityRanges.begin();
 }
 
 PreprocessingRecord::PPEntityID
 PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   assert(Entity);
-  SourceLocation BeginLoc = Entity->getSourceRange().getBegin();
+  SourceRange Range = Entity->getSourceRange();
 
   if (isa<MacroDefinition>(Entity)) {
-    assert((PreprocessedEntities.empty() ||
-            !SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                   PreprocessedEntities.back()->getSourceRange().getBegin())) &&
+    assert((LocalEntityRanges.empty() ||
+            !SourceMgr.isBeforeInTranslationUnit(Range.getBegin(),
+                                      LocalEntityRanges.back().getBegin())) &&
            "a macro definition was encountered out-of-order");
     PreprocessedEntities.push_back(Entity);
+    LocalEntityRanges.push_back(Range);
     return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
   }
 
+  return addLocalEntity(Entity, Range);
+}
+
+PreprocessingRecord::PPEntityID
+PreprocessingRecord::addLocalEntity(LocalEntity Entity, SourceRange Range) {
+  SourceLocation BeginLoc = Range.getBegin();
+
   // Check normal case, this entity begin location is after the previous one.
-  if (PreprocessedEntities.empty() ||
+  if (LocalEntityRanges.empty() ||
       !SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                   PreprocessedEntities.back()->getSourceRange().getBegin())) {
+                                      LocalEntityRanges.back().getBegin())) {
     PreprocessedEntities.push_back(Entity);
+    LocalEntityRanges.push_back(Range);
     return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
   }
 
@@ -277,32 +277,33 @@ PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   //  FM(M1, M2)
   // \endcode
 
-  typedef std::vector<PreprocessedEntity *>::iterator pp_iter;
+  typedef std::vector<SourceRange>::iterator range_iter;
 
   // Usually there are few macro expansions when defining the filename, do a
   // linear search for a few entities.
+  range_iter InsertPos = LocalEntityRanges.end();
   unsigned count = 0;
-  for (pp_iter RI    = PreprocessedEntities.end(),
-               Begin = PreprocessedEntities.begin();
+  for (range_iter RI    = LocalEntityRanges.end(),
+                  Begin = LocalEntityRanges.begin();
        RI != Begin && count < 4; --RI, ++count) {
-    pp_iter I = RI;
+    range_iter I = RI;
     --I;
-    if (!SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                                           (*I)->getSourceRange().getBegin())) {
-      pp_iter insertI = PreprocessedEntities.insert(RI, Entity);
-      return getPPEntityID(insertI - PreprocessedEntities.begin(),
-                           /*isLoaded=*/false);
+    if (!SourceMgr.isBeforeInTranslationUnit(BeginLoc, I->getBegin())) {
+      InsertPos = RI;
+      break;
     }
   }
 
   // Linear search unsuccessful. Do a binary search.
-  pp_iter I = std::upper_bound(PreprocessedEntities.begin(),
-                               PreprocessedEntities.end(),
-                               BeginLoc,
-                               PPEntityComp<&SourceRange::getBegin>(SourceMgr));
-  pp_iter insertI = PreprocessedEntities.insert(I, Entity);
-  return getPPEntityID(insertI - PreprocessedEntities.begin(),
-                       /*isLoaded=*/false);
+  if (InsertPos == LocalEntityRanges.end())
+    InsertPos = std::upper_bound(LocalEntityRanges.begin(),
+                                 LocalEntityRanges.end(),
+                                 BeginLoc, PPEntityBeginComp(SourceMgr));
+
+  unsigned Index = InsertPos - LocalEntityRanges.begin();
+  LocalEntityRanges.insert(InsertPos, Range);
+  PreprocessedEntities.insert(PreprocessedEntities.begin() + Index, Entity);
+  return getPPEntityID(Index, /*isLoaded=*/false);
 }
 
 void PreprocessingRecord::SetExternalSource(
@@ -335,10 +336,27 @@ PreprocessedEntity *PreprocessingRecord::getPreprocessedEntity(PPEntityID PPID){
 
   if (PPID.ID == 0)
     return 0;
-  unsigned Index = PPID.ID - 1;
+  return getLocalPreprocessedEntity(PPID.ID - 1);
+}
+
+/// \brief Retrieve the local preprocessed entity at the given index.
+PreprocessedEntity *
+PreprocessingRecord::getLocalPreprocessedEntity(unsigned Index) {
   assert(Index < PreprocessedEntities.size() &&
          "Out-of bounds local preprocessed entity");
-  return PreprocessedEntities[Index];
+  LocalEntity &Entity = PreprocessedEntities[Index];
+  if (PreprocessedEntity *PPE = Entity.dyn_cast<PreprocessedEntity *>())
+    return PPE;
+
+  // Materialize the macro expansion.
+  MacroExpansion *ME;
+  if (MacroDefinition *Def = Entity.dyn_cast<MacroDefinition *>())
+    ME = new (*this) MacroExpansion(Def, LocalEntityRanges[Index]);
+  else
+    ME = new (*this) MacroExpansion(Entity.get<IdentifierInfo *>(),
+                                    LocalEntityRanges[Index]);
+  Entity = ME;
+  return ME;
 }
 
 /// \brief Retrieve the loaded preprocessed entity at the given index.
@@ -373,12 +391,37 @@ void PreprocessingRecord::addMacroExpansion(const Token &Id,
   if (Id.getLocation().isMacroID())
     return;
 
+  if (!isRecordedLocation(Id.getLocation()))
+    return;
+
+  // The MacroExpansion object itself is only created when somebody asks for
+  // it; see getLocalPreprocessedEntity().
   if (MI->isBuiltinMacro())
-    addPreprocessedEntity(
-                      new (*this) MacroExpansion(Id.getIdentifierInfo(),Range));
+    addLocalEntity(Id.getIdentifierInfo(), Range);
   else if (MacroDefinition *Def = findMacroDefinition(MI))
-    addPreprocessedEntity(
-                       new (*this) MacroExpansion(Def, Range));
+    addLocalEntity(Def, Range);
+}
+
+void PreprocessingRecord::restrictToFiles(ArrayRef<const FileEntry *> Files) {
+  RestrictToRecordedFiles = true;
+  RecordedFiles.insert(Files.begin(), Files.end());
+  LastCheckedFile = FileID();
+}
+
+bool PreprocessingRecord::isRecordedLocation(SourceLocation Loc) {
+  if (!RestrictToRecordedFiles || Loc.isInvalid())
+    return true;
+
+  FileID FID = SourceMgr.getFileID(SourceMgr.getExpansionLoc(Loc));
+  if (FID == LastCheckedFile)
+    return LastCheckedFileIsRecorded;
+
+  LastCheckedFile = FID;
+  LastCheckedFileIsRecorded = FID == SourceMgr.getMainFileID();
+  if (!LastCheckedFileIsRecorded)
+    if (const FileEntry *File = SourceMgr.getFileEntryForID(FID))
+      LastCheckedFileIsRecorded = RecordedFiles.count(File);
+  return LastCheckedFileIsRecorded;
 }
 
 void PreprocessingRecord::Ifdef(SourceLocation Loc, const Token &MacroNameTok,
@@ -443,6 +486,9 @@ void PreprocessingRecord::InclusionDirective(
     StringRef SearchPath,
     StringRef RelativePath,
     const Module *Imported) {
+  if (!isRecordedLocation(HashLoc))
+    return;
+
   InclusionDirective::InclusionKind Kind = InclusionDirective::Include;
   
   switch (IncludeTok.getIdentifierInfo()->getPPKeywordID()) {
@@ -485,6 +531,7 @@ void PreprocessingRecord::InclusionDirective(
 size_t PreprocessingRecord::getTotalMemory() const {
   return BumpAlloc.getTotalMemory()
     + llvm::capacity_in_bytes(MacroDefinitions)
+    + llvm::capacity_in_bytes(LocalEntityRanges)
     + llvm::capacity_in_bytes(PreprocessedEntities)
     + llvm::capacity_in_bytes(LoadedPreprocessedEntities);
 }
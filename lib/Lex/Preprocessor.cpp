@@ -32,6 +32,7 @@
 #include "clang/Lex/CodeCompletionHandler.h"
 #include "clang/Lex/ExternalPreprocessorSource.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderTokenCache.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/LiteralSupport.h"
 #include "clang/Lex/MacroArgs.h"
@@ -68,7 +69,8 @@ Preprocessor::Preprocessor(IntrusiveRefCntPtr<PreprocessorOptions> PPOpts,
       LastTokenWasAt(false), ModuleImportExpectsIdentifier(false),
       CodeCompletionReached(0), SkipMainFilePreamble(0, true), CurPPLexer(0),
       CurDirLookup(0), CurLexerKind(CLK_Lexer), CurIsSubmodule(false),
-      Callbacks(0), MacroArgCache(0), Record(0), MIChainHead(0), MICache(0),
+      Callbacks(0), TokenObserver(0), InObservedLex(false), MacroArgCache(0),
+      Record(0), MIChainHead(0), MICache(0),
       DeserialMIChainHead(0) {
   OwnsHeaderSearch = OwnsHeaders;
   
@@ -190,6 +192,10 @@ void Preprocessor::setPTHManager(PTHManager* pm) {
   FileMgr.addStatCache(PTH->createStatCache());
 }
 
+void Preprocessor::setHeaderTokenCache(HeaderTokenCache *Cache) {
+  HeaderTokCache.reset(Cache);
+}
+
 void Preprocessor::DumpToken(const Token &Tok, bool DumpFlags) const {
   llvm::errs() << tok::getTokenName(Tok.getKind()) << " '"
                << getSpelling(Tok) << "'";
@@ -261,6 +267,9 @@ void Preprocessor::PrintStats() {
                << llvm::capacity_in_bytes(PoisonReasons);
   llvm::errs() << "\n  Comment Handlers: "
                << llvm::capacity_in_bytes(CommentHandlers) << "\n";
+
+  if (HeaderTokCache)
+    HeaderTokCache->PrintStats();
 }
 
 Preprocessor::macro_iterator
@@ -578,6 +587,20 @@ IdentifierInfo *Preprocessor::LookUpIdentifierInfo(Token &Identifier) const {
   return II;
 }
 
+IdentifierInfo *Preprocessor::LookUpIdentifierInfo(Token &Identifier,
+                                                   unsigned Hash) const {
+  assert(Identifier.getRawIdentifierData() != 0 && "No raw identifier data!");
+  if (Identifier.needsCleaning() || Identifier.hasUCN())
+    return LookUpIdentifierInfo(Identifier);
+
+  IdentifierInfo *II =
+    &Identifiers.getWithHash(StringRef(Identifier.getRawIdentifierData(),
+                                       Identifier.getLength()), Hash);
+  Identifier.setIdentifierInfo(II);
+  Identifier.setKind(II->getTokenID());
+  return II;
+}
+
 void Preprocessor::SetPoisonReason(IdentifierInfo *II, unsigned DiagID) {
   PoisonReasons[II] = DiagID;
 }
@@ -706,6 +729,15 @@ bool Preprocessor::HandleIdentifier(Token &Identifier) {
 }
 
 void Preprocessor::Lex(Token &Result) {
+  if (TokenObserver && !InObservedLex) {
+    InObservedLex = true;
+    TokenObserver->LexBegin();
+    Lex(Result);
+    TokenObserver->LexEnd(Result);
+    InObservedLex = false;
+    return;
+  }
+
   // We loop here until a lex function retuns a token; this avoids recursion.
   bool ReturnedToken;
   do {
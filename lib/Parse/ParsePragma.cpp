@@ -15,6 +15,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Parse/ParseDiagnostic.h"
 #include "clang/Parse/Parser.h"
+#include "clang/Sema/LoopHint.h"
 #include "clang/Sema/Scope.h"
 #include "llvm/ADT/StringSwitch.h"
 using namespace clang;
@@ -151,6 +152,69 @@ StmtResult Parser::HandlePragmaCaptured()
   return Actions.ActOnCapturedRegionEnd(R.get());
 }
 
+/// \brief The option and argument tokens of one '#pragma clang loop' option.
+struct PragmaLoopHintInfo {
+  Token Option;
+  Token Value;
+};
+
+/// \brief Handle the annotation token produced for each option of a
+/// '#pragma clang loop'.
+///
+/// \returns true if \p Hint was filled in with a well-formed option.
+bool Parser::HandlePragmaLoopHint(LoopHint &Hint) {
+  assert(Tok.is(tok::annot_pragma_loop_hint));
+  PragmaLoopHintInfo *Info =
+    static_cast<PragmaLoopHintInfo *>(Tok.getAnnotationValue());
+  ConsumeToken(); // The annotation token.
+
+  Hint.Option = Info->Option.getIdentifierInfo();
+  Hint.OptionLoc = Info->Option.getLocation();
+  Hint.ValueLoc = Info->Value.getLocation();
+
+  if (Info->Value.is(tok::identifier)) {
+    Hint.State = Info->Value.getIdentifierInfo();
+    return true;
+  }
+
+  if (Info->Value.is(tok::numeric_constant)) {
+    ExprResult Value = Actions.ActOnNumericConstant(Info->Value);
+    if (Value.isInvalid())
+      return false;
+    Hint.ValueExpr = Value.take();
+    return true;
+  }
+
+  Diag(Hint.ValueLoc, diag::err_pragma_loop_missing_argument)
+    << Hint.Option->getName();
+  return false;
+}
+
+/// \brief Parse a loop preceded by one or more '#pragma clang loop'
+/// directives, and attach their options to it.
+StmtResult Parser::ParsePragmaLoopHint(StmtVector &Stmts, bool OnlyStatement,
+                                       SourceLocation *TrailingElseLoc,
+                                       ParsedAttributesWithRange &Attrs) {
+  SmallVector<LoopHint, 4> Hints;
+  while (Tok.is(tok::annot_pragma_loop_hint)) {
+    LoopHint Hint;
+    if (HandlePragmaLoopHint(Hint))
+      Hints.push_back(Hint);
+  }
+
+  bool IsLoop = Tok.is(tok::kw_for) || Tok.is(tok::kw_while) ||
+                Tok.is(tok::kw_do);
+  if (!IsLoop)
+    Diag(Tok, diag::err_pragma_loop_precedes_nonloop);
+
+  StmtResult S = ParseStatementOrDeclarationAfterAttributes(
+      Stmts, OnlyStatement, TrailingElseLoc, Attrs);
+  if (!IsLoop || S.isInvalid() || Hints.empty())
+    return S;
+
+  return Actions.ActOnPragmaLoopHints(Hints, S.take());
+}
+
 namespace {
   typedef llvm::PointerIntPair<IdentifierInfo *, 1, bool> OpenCLExtData;
 }
@@ -929,3 +993,88 @@ void PragmaCommentHandler::HandlePragma(Preprocessor &PP,
 
   Actions.ActOnPragmaMSComment(Kind, ArgumentString);
 }
+
+/// \brief Handle the loop optimization hints
+///   #pragma clang loop option(argument) [option(argument) ...]
+/// where the option is one of 'vectorize', 'vectorize_width',
+/// 'interleave_count', 'unroll' or 'unroll_count', and the argument is
+/// 'enable', 'disable' or an integer constant.
+///
+/// Each option becomes an annot_pragma_loop_hint token, which the parser
+/// attaches to the loop that follows.
+void PragmaLoopHintHandler::HandlePragma(Preprocessor &PP,
+                                         PragmaIntroducerKind Introducer,
+                                         Token &Tok) {
+  SmallVector<Token, 4> TokenList;
+
+  PP.Lex(Tok);
+  if (Tok.isNot(tok::identifier)) {
+    PP.Diag(Tok.getLocation(), diag::err_pragma_loop_missing_option);
+    return;
+  }
+
+  while (Tok.is(tok::identifier)) {
+    Token Option = Tok;
+    IdentifierInfo *OptionInfo = Tok.getIdentifierInfo();
+    bool OptionValid = llvm::StringSwitch<bool>(OptionInfo->getName())
+      .Case("vectorize", true)
+      .Case("vectorize_width", true)
+      .Case("interleave_count", true)
+      .Case("unroll", true)
+      .Case("unroll_count", true)
+      .Default(false);
+    if (!OptionValid) {
+      PP.Diag(Tok.getLocation(), diag::err_pragma_loop_invalid_option)
+        << OptionInfo;
+      return;
+    }
+
+    PP.Lex(Tok);
+    if (Tok.isNot(tok::l_paren)) {
+      PP.Diag(Tok.getLocation(), diag::err_expected) << tok::l_paren;
+      return;
+    }
+
+    PP.Lex(Tok);
+    if (Tok.is(tok::r_paren) || Tok.is(tok::eod)) {
+      PP.Diag(Tok.getLocation(), diag::err_pragma_loop_missing_argument)
+        << OptionInfo->getName();
+      return;
+    }
+    Token Value = Tok;
+
+    PP.Lex(Tok);
+    if (Tok.isNot(tok::r_paren)) {
+      PP.Diag(Tok.getLocation(), diag::err_expected) << tok::r_paren;
+      return;
+    }
+    PP.Lex(Tok);
+
+    PragmaLoopHintInfo *Info =
+      (PragmaLoopHintInfo*) PP.getPreprocessorAllocator().Allocate(
+        sizeof(PragmaLoopHintInfo), llvm::alignOf<PragmaLoopHintInfo>());
+    new (Info) PragmaLoopHintInfo();
+    Info->Option = Option;
+    Info->Value = Value;
+
+    Token LoopHintTok;
+    LoopHintTok.startToken();
+    LoopHintTok.setKind(tok::annot_pragma_loop_hint);
+    LoopHintTok.setLocation(Option.getLocation());
+    LoopHintTok.setAnnotationValue(static_cast<void*>(Info));
+    TokenList.push_back(LoopHintTok);
+  }
+
+  if (Tok.isNot(tok::eod)) {
+    PP.Diag(Tok.getLocation(), diag::warn_pragma_extra_tokens_at_eol)
+      << "clang loop";
+    return;
+  }
+
+  Token *TokenArray =
+    (Token*) PP.getPreprocessorAllocator().Allocate(
+      sizeof(Token) * TokenList.size(), llvm::alignOf<Token>());
+  std::copy(TokenList.begin(), TokenList.end(), TokenArray);
+  PP.EnterTokenStream(TokenArray, TokenList.size(),
+                      /*DisableMacroExpansion=*/true, /*OwnsTokens=*/false);
+}
@@ -113,6 +113,13 @@ public:
                             Token &FirstToken);
 };
 
+class PragmaLoopHintHandler : public PragmaHandler {
+public:
+  PragmaLoopHintHandler() : PragmaHandler("loop") { }
+  virtual void HandlePragma(Preprocessor &PP, PragmaIntroducerKind Introducer,
+                            Token &FirstToken);
+};
+
 /// PragmaCommentHandler - "\#pragma comment ...".
 class PragmaCommentHandler : public PragmaHandler {
 public:
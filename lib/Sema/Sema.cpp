@@ -21,6 +21,7 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/StmtCXX.h"
+#include "clang/Analysis/Analyses/FormatString.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/PartialDiagnostic.h"
 #include "clang/Basic/TargetInfo.h"
@@ -208,6 +209,10 @@ Sema::~Sema() {
                                         E = LateParsedTemplateMap.end();
        I != E; ++I)
     delete I->second;
+  for (llvm::StringMap<analyze_format_string::ParsedFormatString *>::iterator
+         I = ParsedFormatStrings.begin(), E = ParsedFormatStrings.end();
+       I != E; ++I)
+    delete I->second;
   if (PackContext) FreePackedContext();
   if (VisContext) FreeVisContext();
   MSStructPragmaOn = false;
@@ -2218,6 +2218,11 @@ checkFormatStringExpr(Sema &S, const Expr *E, ArrayRef<const Expr *> Args,
     else
       StrE = cast<StringLiteral>(E);
 
+    // The contents of an embedded file are data, not a format string
+    // anybody wrote, so don't second-guess them.
+    if (StrE && StrE->isEmbedded())
+      return SLCT_UncheckedLiteral;
+
     if (StrE) {
       S.CheckFormatString(StrE, E, Args, HasVAListArg, format_idx, firstDataArg,
                           Type, InFunctionCall, CallType, CheckedVarArgs);
@@ -3561,26 +3566,46 @@ void Sema::CheckFormatString(const StringLiteral *FExpr,
     return;
   }
   
+  if (Type != FST_Printf && Type != FST_NSString && Type != FST_Scanf)
+    return; // TODO: handle other formats
+
+  // Parse each distinct format string only once per kind.  The key is a
+  // stable copy of the string, so the parse is done against the key and the
+  // handler interprets positions relative to it; the bytes are identical to
+  // those of this literal, so every offset maps back onto FExpr.
+  const analyze_format_string::ParsedFormatString::Kind ParseKind =
+      Type == FST_Scanf ? analyze_format_string::ParsedFormatString::Scanf
+                        : analyze_format_string::ParsedFormatString::Printf;
+  SmallString<128> Key;
+  Key += static_cast<char>(ParseKind);
+  Key += StrRef;
+  llvm::StringMapEntry<analyze_format_string::ParsedFormatString *> &Entry =
+      ParsedFormatStrings.GetOrCreateValue(Key);
+  if (!Entry.getValue()) {
+    const char *KeyStr = Entry.getKeyData() + 1;
+    Entry.setValue(new analyze_format_string::ParsedFormatString(
+        ParseKind, KeyStr, KeyStr + StrLen, getLangOpts(),
+        Context.getTargetInfo()));
+  }
+  const analyze_format_string::ParsedFormatString &Parsed = *Entry.getValue();
+  Str = Parsed.getBegin();
+
   if (Type == FST_Printf || Type == FST_NSString) {
     CheckPrintfHandler H(*this, FExpr, OrigFormatExpr, firstDataArg,
                          numDataArgs, (Type == FST_NSString),
                          Str, HasVAListArg, Args, format_idx,
                          inFunctionCall, CallType, CheckedVarArgs);
   
-    if (!analyze_format_string::ParsePrintfString(H, Str, Str + StrLen,
-                                                  getLangOpts(),
-                                                  Context.getTargetInfo()))
+    if (!Parsed.Replay(H))
       H.DoneProcessing();
-  } else if (Type == FST_Scanf) {
+  } else {
     CheckScanfHandler H(*this, FExpr, OrigFormatExpr, firstDataArg, numDataArgs,
                         Str, HasVAListArg, Args, format_idx,
                         inFunctionCall, CallType, CheckedVarArgs);
     
-    if (!analyze_format_string::ParseScanfString(H, Str, Str + StrLen,
-                                                 getLangOpts(),
-                                                 Context.getTargetInfo()))
+    if (!Parsed.Replay(H))
       H.DoneProcessing();
-  } // TODO: handle other formats
+  }
 }
 
 //===--- CHECK: Standard memory functions ---------------------------------===//
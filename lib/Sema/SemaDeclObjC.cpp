@@ -580,6 +580,11 @@ ActOnStartClassInterface(SourceLocation AtInterfaceLoc,
                                      ClassName,
                                      SourceRange(AtInterfaceLoc, ClassLoc))) {
           SuperClassDecl = 0;
+        } else if (SuperClassDecl->hasAttr<ObjCSubclassingRestrictedAttr>()) {
+          Diag(SuperLoc, diag::err_restricted_superclass)
+            << SuperClassDecl->getDeclName();
+          Diag(SuperClassDecl->getLocation(), diag::note_previous_decl)
+            << SuperClassDecl->getDeclName();
         }
       }
       IDecl->setSuperClass(SuperClassDecl);
@@ -1051,6 +1056,13 @@ Decl *Sema::ActOnStartClassImplementation(
         Diag(SuperClassLoc, diag::err_conflicting_super_class)
           << SDecl->getDeclName();
         Diag(SDecl->getLocation(), diag::note_previous_definition);
+      } else if (!IDecl &&
+                 SDecl->hasAttr<ObjCSubclassingRestrictedAttr>()) {
+        // An implementation without an interface declares the subclass.
+        Diag(SuperClassLoc, diag::err_restricted_superclass)
+          << SDecl->getDeclName();
+        Diag(SDecl->getLocation(), diag::note_previous_decl)
+          << SDecl->getDeclName();
       }
     }
   }
@@ -30,6 +30,7 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Lex/LiteralSupport.h"
+#include "clang/Lex/PPCallbacks.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/AnalysisBasedWarnings.h"
 #include "clang/Sema/DeclSpec.h"
@@ -42,6 +43,9 @@
 #include "clang/Sema/ScopeInfo.h"
 #include "clang/Sema/SemaFixItUtils.h"
 #include "clang/Sema/Template.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
 using namespace clang;
 using namespace sema;
 
@@ -4544,6 +4548,81 @@ ExprResult Sema::ActOnConvertVectorExpr(Expr *E, ParsedType ParsedDestTy,
   return SemaConvertVectorExpr(E, TInfo, BuiltinLoc, RParenLoc);
 }
 
+/// ActOnBuiltinEmbed - Read the file named by \p PathExpr, found the way a
+/// quoted \#include would find it, and return its contents as a string
+/// literal.
+///
+/// __builtin_embed( string-literal )
+///
+/// The string literal has one element per byte of the file and no nul
+/// terminator, so that it can initialize an array of exactly the file's size.
+/// Its contents never pass through the lexer, which makes this much cheaper
+/// than an initializer list with a literal per byte.
+ExprResult Sema::ActOnBuiltinEmbed(SourceLocation BuiltinLoc, Expr *PathExpr,
+                                   SourceLocation RParenLoc) {
+  StringLiteral *Path = cast<StringLiteral>(PathExpr);
+  if (!Path->isAscii() && !Path->isUTF8())
+    return ExprError(Diag(Path->getLocStart(),
+                          diag::err_embed_path_not_narrow)
+                       << Path->getSourceRange());
+
+  StringRef Filename = Path->getString();
+  const DirectoryLookup *CurDir;
+  const FileEntry *File = PP.LookupFile(BuiltinLoc, Filename,
+                                        /*isAngled=*/false, /*FromDir=*/0,
+                                        CurDir, /*SearchPath=*/0,
+                                        /*RelativePath=*/0,
+                                        /*SuggestedModule=*/0);
+  if (!File)
+    return ExprError(Diag(Path->getLocStart(), diag::err_embed_file_not_found)
+                       << Filename << Path->getSourceRange());
+
+  // The embedded file is as much an input of the translation unit as any
+  // header, so let dependency file generation and friends know about it.
+  if (PPCallbacks *Callbacks = PP.getPPCallbacks())
+    Callbacks->FileEmbedded(BuiltinLoc, *File);
+
+  std::string ErrorStr;
+  OwningPtr<llvm::MemoryBuffer> Buffer(
+      PP.getFileManager().getBufferForFile(File, &ErrorStr));
+  if (!Buffer)
+    return ExprError(Diag(Path->getLocStart(), diag::err_embed_cannot_read)
+                       << Filename << ErrorStr << Path->getSourceRange());
+
+  StringRef Contents = Buffer->getBuffer();
+  if (Contents.empty())
+    return ExprError(Diag(Path->getLocStart(), diag::err_embed_empty_file)
+                       << Filename << Path->getSourceRange());
+
+  // String literals and their types count their elements in 32 bits.
+  if (!llvm::isUInt<32>(Contents.size()))
+    return ExprError(Diag(Path->getLocStart(), diag::err_embed_file_too_large)
+                       << Filename << Path->getSourceRange());
+
+  QualType CharTyConst = Context.CharTy;
+  // A C++ string literal has a const-qualified element type (C++ 2.13.4p1).
+  if (getLangOpts().CPlusPlus || getLangOpts().ConstStrings)
+    CharTyConst.addConst();
+
+  QualType StrTy = Context.getConstantArrayType(
+      CharTyConst, llvm::APInt(32, Contents.size()), ArrayType::Normal, 0);
+
+  // OpenCL v1.1 s6.5.3: a string literal is in the constant address space.
+  if (getLangOpts().OpenCL)
+    StrTy = Context.getAddrSpaceQualType(StrTy, LangAS::opencl_constant);
+
+  // The literal copies the contents into the ASTContext.  Its location is
+  // that of the file name, which is where diagnostics about it should point;
+  // marking it embedded keeps anyone from looking for its bytes there.
+  SourceLocation Loc = Path->getStrTokenLoc(0);
+  StringLiteral *Result = StringLiteral::Create(Context, Contents,
+                                                StringLiteral::Ascii,
+                                                /*Pascal=*/false, StrTy,
+                                                &Loc, 1);
+  Result->setEmbedded(true);
+  return Owned(Result);
+}
+
 /// BuildResolvedCallExpr - Build a call to a resolved expression,
 /// i.e. an expression not of \p OverloadTy.  The expression should
 /// unary-convert to an expression of function-pointer or
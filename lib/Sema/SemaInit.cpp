@@ -985,6 +985,40 @@ void InitListChecker::CheckComplexType(const InitializedEntity &Entity,
 }
 
 
+/// \brief Determine whether \p Init is an integer literal, possibly negated,
+/// whose value can be represented in the integer type \p DeclType.
+static bool isFittingIntegerLiteral(ASTContext &Context, Expr *Init,
+                                    QualType DeclType) {
+  const BuiltinType *BT = DeclType->getAs<BuiltinType>();
+  if (!BT || !BT->isInteger() || BT->getKind() == BuiltinType::Bool)
+    return false;
+
+  APValue Literal;
+  if (!Init->getLiteralValue(Literal, Context) || !Literal.isInt())
+    return false;
+
+  const llvm::APSInt &Value = Literal.getInt();
+  llvm::APSInt Converted = Value.extOrTrunc(Context.getIntWidth(DeclType));
+  Converted.setIsUnsigned(DeclType->isUnsignedIntegerType());
+  return llvm::APSInt::isSameValue(Value, Converted);
+}
+
+/// \brief Convert \p Init, for which isFittingIntegerLiteral holds, to
+/// \p DeclType, building the same expression a copy-initialization would.
+static Expr *convertFittingIntegerLiteral(Sema &S, Expr *Init,
+                                          QualType DeclType) {
+  QualType ToType = DeclType.getUnqualifiedType();
+  bool SameType = S.Context.hasSameUnqualifiedType(Init->getType(), ToType);
+  if (S.getLangOpts().CPlusPlus)
+    return SameType ? Init
+                    : S.ImpCastExprToType(Init, ToType, CK_IntegralCast).take();
+
+  if (Init->getType() == ToType)
+    return Init;
+  return S.ImpCastExprToType(Init, ToType,
+                             SameType ? CK_NoOp : CK_IntegralCast).take();
+}
+
 void InitListChecker::CheckScalarType(const InitializedEntity &Entity,
                                       InitListExpr *IList, QualType DeclType,
                                       unsigned &Index,
@@ -1026,6 +1060,24 @@ void InitListChecker::CheckScalarType(const InitializedEntity &Entity,
     return;
   }
 
+  // Large tables are mostly made of integer literals that fit in the element
+  // type.  Converting one of those can neither fail nor warn, so don't build
+  // an initialization sequence for each of them.  Bit-fields are narrower
+  // than their type, so their initializers still get checked for truncation.
+  bool IsBitField = Entity.getKind() == InitializedEntity::EK_Member &&
+                    cast<FieldDecl>(Entity.getDecl())->isBitField();
+  if (!IsBitField &&
+      isFittingIntegerLiteral(SemaRef.Context, expr, DeclType)) {
+    if (!VerifyOnly) {
+      Expr *ResultExpr = convertFittingIntegerLiteral(SemaRef, expr, DeclType);
+      if (ResultExpr != expr)
+        IList->setInit(Index, ResultExpr);
+      UpdateStructuredListElement(StructuredList, StructuredIndex, ResultExpr);
+    }
+    ++Index;
+    return;
+  }
+
   if (VerifyOnly) {
     if (!SemaRef.CanPerformCopyInitialization(Entity, SemaRef.Owned(expr)))
       hadError = true;
@@ -2285,6 +2337,11 @@ InitListChecker::getStructuredSubobjectInit(InitListExpr *IList, unsigned Index,
       // initializer with many empty entries at the end.
       if (GotNumInits && NumElements > NumInits)
         NumElements = 0;
+    } else if (GotNumInits) {
+      // The size of an incomplete array comes from its initializers, so
+      // allocate room for all of them up front instead of growing the list
+      // one reallocation at a time.
+      NumElements = NumInits;
     }
   } else if (const VectorType *VType = CurrentObjectType->getAs<VectorType>())
     NumElements = VType->getNumElements();
@@ -16,9 +16,12 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Sema/DelayedDiagnostic.h"
+#include "clang/Sema/LoopHint.h"
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/ScopeInfo.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSwitch.h"
 
 using namespace clang;
 using namespace sema;
@@ -77,3 +80,67 @@ StmtResult Sema::ProcessStmtAttributes(Stmt *S, AttributeList *AttrList,
 
   return ActOnAttributedStmt(Range.getBegin(), Attrs, S);
 }
+
+/// \brief Check one option of a '#pragma clang loop' and turn it into a
+/// LoopHintAttr, or diagnose it and return null.
+static Attr *handleLoopHint(Sema &S, const LoopHint &Hint) {
+  StringRef OptionName = Hint.Option->getName();
+  LoopHintAttr::OptionType Option =
+    llvm::StringSwitch<LoopHintAttr::OptionType>(OptionName)
+      .Case("vectorize", LoopHintAttr::Vectorize)
+      .Case("vectorize_width", LoopHintAttr::VectorizeWidth)
+      .Case("interleave_count", LoopHintAttr::InterleaveCount)
+      .Case("unroll", LoopHintAttr::Unroll)
+      .Default(LoopHintAttr::UnrollCount);
+
+  int Value;
+  if (LoopHintAttr::isEnableOption(Option)) {
+    // vectorize(enable|disable) and unroll(enable|disable).
+    StringRef State = Hint.State ? Hint.State->getName() : "";
+    if (State == "enable") {
+      Value = 1;
+    } else if (State == "disable") {
+      Value = 0;
+    } else {
+      S.Diag(Hint.ValueLoc, diag::err_pragma_loop_invalid_keyword)
+        << OptionName;
+      return 0;
+    }
+  } else {
+    // The widths and counts must be positive integer constants.
+    llvm::APSInt ValueAPS;
+    if (!Hint.ValueExpr ||
+        !Hint.ValueExpr->isIntegerConstantExpr(ValueAPS, S.Context) ||
+        ValueAPS.isNegative() || !ValueAPS || ValueAPS.getActiveBits() > 31) {
+      S.Diag(Hint.ValueLoc, diag::err_pragma_loop_invalid_value)
+        << OptionName;
+      return 0;
+    }
+    Value = int(ValueAPS.getZExtValue());
+  }
+
+  return ::new (S.Context) LoopHintAttr(Hint.OptionLoc, S.Context, Option,
+                                        Value);
+}
+
+StmtResult Sema::ActOnPragmaLoopHints(ArrayRef<LoopHint> Hints, Stmt *St) {
+  SmallVector<const Attr*, 4> Attrs;
+  // Each option may be given only once per loop, even across several
+  // directives.
+  llvm::SmallPtrSet<const IdentifierInfo*, 4> SeenOptions;
+  for (unsigned I = 0, N = Hints.size(); I != N; ++I) {
+    const LoopHint &Hint = Hints[I];
+    if (!SeenOptions.insert(Hint.Option)) {
+      Diag(Hint.OptionLoc, diag::err_pragma_loop_duplicate_option)
+        << Hint.Option->getName();
+      continue;
+    }
+    if (Attr *A = handleLoopHint(*this, Hint))
+      Attrs.push_back(A);
+  }
+
+  if (Attrs.empty())
+    return St;
+
+  return ActOnAttributedStmt(Hints[0].OptionLoc, Attrs, St);
+}
@@ -4469,7 +4469,7 @@ void ASTReader::ReadPragmaDiagnosticMappings(DiagnosticsEngine &Diag) {
       
       assert(DiagStateID == 0);
       // A new DiagState was created here.
-      Diag.DiagStates.push_back(*Diag.GetCurDiagState());
+      Diag.DiagStates.push_back(Diag.GetCurDiagState()->cloneForNewPoint());
       DiagnosticsEngine::DiagState *NewState = &Diag.DiagStates.back();
       DiagStates.push_back(NewState);
       Diag.DiagStatePoints.push_back(
@@ -484,6 +484,7 @@ void ASTStmtReader::VisitStringLiteral(StringLiteral *E) {
   StringLiteral::StringKind kind =
         static_cast<StringLiteral::StringKind>(Record[Idx++]);
   bool isPascal = Record[Idx++];
+  E->setEmbedded(Record[Idx++]);
 
   // Read string data
   SmallString<16> Str(&Record[Idx], &Record[Idx] + Len);
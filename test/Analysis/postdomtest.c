@@ -0,0 +1,15 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=debug.DumpPostDominators %s 2>&1 | FileCheck %s
+
+// Test the native post-dominator tree on a simple diamond.
+int test1(int x) {
+  if (x)
+    x = 1;
+  return x;
+}
+
+// CHECK: Immediate post dominance tree (Node#,IDom#):
+// CHECK-NEXT: (0,0)
+// CHECK-NEXT: (1,0)
+// CHECK-NEXT: (2,1)
+// CHECK-NEXT: (3,1)
+// CHECK-NEXT: (4,3)
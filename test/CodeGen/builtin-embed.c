@@ -0,0 +1,18 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -I %S/Inputs -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -I %S/Inputs -emit-llvm -o /dev/null -dependency-file %t.d -MT builtin-embed.o %s
+// RUN: FileCheck -check-prefix=DEP %s < %t.d
+
+// CHECK: @text = global [6 x i8] c"Hello\0A"
+char text[] = __builtin_embed("embed.txt");
+
+// CHECK: @bytes = constant [6 x i8] c"Hello\0A"
+const unsigned char bytes[] = __builtin_embed("embed.txt");
+
+// CHECK: @padded = global [8 x i8] c"Hello\0A\00\00"
+char padded[8] = __builtin_embed("embed.txt");
+
+// CHECK: @size = global i64 6
+unsigned long size = sizeof(__builtin_embed("embed.txt"));
+
+// DEP: builtin-embed.o:
+// DEP: Inputs{{[/\\]}}embed.txt
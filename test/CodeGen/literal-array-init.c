@@ -0,0 +1,47 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %s | FileCheck %s
+
+// Arrays initialized with literals are emitted straight from the literals.
+
+// CHECK: @bytes = global [8 x i8] c"\00\01\7F\80\FF\FFa\02"
+unsigned char bytes[] = { 0, 1, 0x7f, 0x80, 0xff, 255, 'a', (2) };
+
+// CHECK: @chars = global [3 x i8] c"a\FF\00"
+char chars[3] = { 'a', -1 };
+
+// CHECK: @shorts = global [6 x i16] [i16 -32768, i16 32767, i16 -1, i16 0, i16 0, i16 0]
+short shorts[6] = { -32768, 32767, -1 };
+
+// CHECK: @wide = global [3 x i64] [i64 1, i64 -1, i64 -9223372036854775807]
+long long wide[] = { 1, -1, -0x7fffffffffffffffLL };
+
+// CHECK: @floats = global [4 x float] [float 1.500000e+00, float -2.000000e+00, float 3.000000e+00, float 0.000000e+00]
+float floats[4] = { 1.5f, -2.0, 3 };
+
+// CHECK: @negzero = global [2 x float] [float -0.000000e+00, float 0.000000e+00]
+float negzero[2] = { -0.0f };
+
+// CHECK: @doubles = global [3 x double] [double 1.000000e-01, double -5.000000e+00, double 1.000000e+300]
+double doubles[] = { 0.1, -5, 1e300 };
+
+// CHECK: @holes = global [8 x i32] [i32 0, i32 0, i32 5, i32 0, i32 0, i32 0, i32 -7, i32 0]
+int holes[8] = { [2] = 5, [6] = -7 };
+
+// CHECK: @zeros = global [100 x i32] zeroinitializer
+int zeros[100] = { 0, 0 };
+
+// Arrays whose elements need evaluating are emitted from their values.
+
+// CHECK: @computed = global [3 x i32] [i32 2, i32 6, i32 0]
+int computed[3] = { 1 + 1, 2 * 3 };
+
+// CHECK: @f.table = internal constant [3 x i16] [i16 1, i16 2, i16 3]
+const unsigned short *f(void) {
+  static const unsigned short table[] = { 1, 2, 3 };
+  return table;
+}
+
+// CHECK: @g.local = private unnamed_addr constant [4 x i32] [i32 10, i32 20, i32 30, i32 40]
+void g(void) {
+  unsigned local[4] = { 10, 20, 30, 40 };
+  (void)local;
+}
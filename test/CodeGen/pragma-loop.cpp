@@ -0,0 +1,69 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -std=c++11 -emit-llvm -o - %s | FileCheck %s
+
+// CHECK-LABEL: define {{.*}} @_Z10while_testPii
+void while_test(int *List, int Length) {
+  int i = 0;
+
+#pragma clang loop vectorize(enable)
+#pragma clang loop interleave_count(4)
+  while (i < Length) {
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_1:.*]]
+    List[i] = i * 2;
+    i++;
+  }
+}
+
+// CHECK-LABEL: define {{.*}} @_Z7do_testPii
+void do_test(int *List, int Length) {
+  int i = 0;
+
+#pragma clang loop vectorize_width(8) unroll(disable)
+  do {
+    // CHECK: br i1 {{.*}}, label {{.*}}, label {{.*}}, !llvm.loop ![[LOOP_2:.*]]
+    List[i] = i * 2;
+    i++;
+  } while (i < Length);
+}
+
+// CHECK-LABEL: define {{.*}} @_Z8for_testPii
+void for_test(int *List, int Length) {
+#pragma clang loop vectorize(disable) unroll_count(4)
+  for (int i = 0; i < Length; i++) {
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_3:.*]]
+    List[i] = i * 2;
+  }
+}
+
+// CHECK-LABEL: define {{.*}} @_Z14for_range_testv
+void for_range_test() {
+  int List[100];
+
+#pragma clang loop vectorize_width(2) interleave_count(2)
+  for (int &x : List) {
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_4:.*]]
+    x = 0;
+  }
+}
+
+// Loops without hints get no loop ID.
+// CHECK-LABEL: define {{.*}} @_Z9no_hintsPii
+void no_hints(int *List, int Length) {
+  for (int i = 0; i < Length; i++) {
+    // CHECK-NOT: !llvm.loop
+    List[i] = i;
+  }
+  // CHECK: ret void
+}
+
+// CHECK: ![[LOOP_1]] = metadata !{metadata ![[LOOP_1]], metadata ![[ENABLE_VEC:.*]], metadata ![[UNROLL_4:.*]]}
+// CHECK: ![[ENABLE_VEC]] = metadata !{metadata !"llvm.vectorizer.enable", i1 true}
+// CHECK: ![[UNROLL_4]] = metadata !{metadata !"llvm.vectorizer.unroll", i32 4}
+// CHECK: ![[LOOP_2]] = metadata !{metadata ![[LOOP_2]], metadata ![[WIDTH_8:.*]], metadata ![[NO_UNROLL:.*]]}
+// CHECK: ![[WIDTH_8]] = metadata !{metadata !"llvm.vectorizer.width", i32 8}
+// CHECK: ![[NO_UNROLL]] = metadata !{metadata !"llvm.loop.unroll.enable", i1 false}
+// CHECK: ![[LOOP_3]] = metadata !{metadata ![[LOOP_3]], metadata ![[WIDTH_1:.*]], metadata ![[UNROLL_COUNT_4:.*]]}
+// CHECK: ![[WIDTH_1]] = metadata !{metadata !"llvm.vectorizer.width", i32 1}
+// CHECK: ![[UNROLL_COUNT_4]] = metadata !{metadata !"llvm.loop.unroll.count", i32 4}
+// CHECK: ![[LOOP_4]] = metadata !{metadata ![[LOOP_4]], metadata ![[WIDTH_2:.*]], metadata ![[UNROLL_2:.*]]}
+// CHECK: ![[WIDTH_2]] = metadata !{metadata !"llvm.vectorizer.width", i32 2}
+// CHECK: ![[UNROLL_2]] = metadata !{metadata !"llvm.vectorizer.unroll", i32 2}
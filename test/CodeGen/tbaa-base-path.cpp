@@ -0,0 +1,68 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -O1 -disable-llvm-optzns %s -emit-llvm -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -O1 -disable-llvm-optzns %s -emit-llvm -o /dev/null -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -O1 -disable-llvm-optzns -no-struct-path-tbaa %s -emit-llvm -o /dev/null -print-stats 2>&1 | FileCheck -check-prefix=SCALAR-STATS %s
+//
+// Accesses to members of non-virtual bases keep the derived class in their
+// struct-path TBAA tag.
+
+struct Base { int x; };
+struct B2 { float f; };
+struct Derived : Base, B2 { int y; };
+struct Virtual : virtual Base { int z; };
+
+void f0(int *i) {
+// CHECK-LABEL: define void @_Z2f0Pi(
+// CHECK: store i32 0, i32* %{{.*}}, align 4, !tbaa [[TAG_i32:!.*]]
+  *i = 0;
+}
+
+int f1(Derived *d, Base *b) {
+// CHECK-LABEL: define i32 @_Z2f1P7DerivedP4Base(
+// CHECK: store i32 1, i32* %{{.*}}, align 4, !tbaa [[TAG_Base_x:!.*]]
+// CHECK: store i32 2, i32* %{{.*}}, align 4, !tbaa [[TAG_Derived_x:!.*]]
+// CHECK: load i32* %{{.*}}, align 4, !tbaa [[TAG_Base_x]]
+  b->x = 1;
+  d->x = 2;
+  return b->x;
+}
+
+void f2(Derived &d) {
+// CHECK-LABEL: define void @_Z2f2R7Derived(
+// CHECK: store float 1.000000e+00, float* %{{.*}}, align 4, !tbaa [[TAG_Derived_f:!.*]]
+// CHECK: store float 2.000000e+00, float* %{{.*}}, align 4, !tbaa [[TAG_Derived_f]]
+  d.f = 1.0f;
+  static_cast<B2 &>(d).f = 2.0f;
+}
+
+void f3(Virtual *v) {
+// CHECK-LABEL: define void @_Z2f3P7Virtual(
+// CHECK: store i32 3, i32* %{{.*}}, align 4, !tbaa [[TAG_Base_x]]
+  v->x = 3;
+}
+
+// An enum we can't name across the program aliases its integer type.
+namespace { enum E { E0, E1 }; }
+void f4(void *p) {
+// CHECK-LABEL: define void @_Z2f4Pv(
+// CHECK: store i32 1, i32* %{{.*}}, align 4, !tbaa [[TAG_i32]]
+  *static_cast<E *>(p) = E1;
+}
+
+void f5(char *c) {
+  *c = 0;
+}
+
+// CHECK-DAG: [[TAG_i32]] = metadata !{metadata [[TYPE_INT:!.*]], metadata [[TYPE_INT]], i64 0}
+// CHECK-DAG: [[TAG_Base_x]] = metadata !{metadata [[TYPE_Base:!.*]], metadata [[TYPE_INT]], i64 0}
+// CHECK-DAG: [[TAG_Derived_x]] = metadata !{metadata [[TYPE_Derived:!.*]], metadata [[TYPE_INT]], i64 0}
+// CHECK-DAG: [[TAG_Derived_f]] = metadata !{metadata [[TYPE_Derived]], metadata [[TYPE_FLOAT:!.*]], i64 4}
+// CHECK-DAG: [[TYPE_Base]] = metadata !{metadata !"_ZTS4Base", metadata [[TYPE_INT]], i64 0}
+// CHECK-DAG: [[TYPE_Derived]] = metadata !{metadata !"_ZTS7Derived", metadata [[TYPE_Base]], i64 0, metadata [[TYPE_B2:!.*]], i64 4, metadata [[TYPE_INT]], i64 8}
+// CHECK-DAG: [[TYPE_B2]] = metadata !{metadata !"_ZTS2B2", metadata [[TYPE_FLOAT]], i64 0}
+
+// STATS: *** IR Generation Stats:
+// STATS: {{[0-9]+}} loads and stores with TBAA tags, 6 through an aggregate, 1 conservatively tagged as char
+
+// Scalar tags have no path, and only the char access is tagged as char.
+// SCALAR-STATS: *** IR Generation Stats:
+// SCALAR-STATS: {{[0-9]+}} loads and stores with TBAA tags, 0 through an aggregate, 1 conservatively tagged as char
@@ -0,0 +1,28 @@
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -fblocks -fcxx-exceptions -fexceptions -emit-llvm -o - | FileCheck %s
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -fblocks -fcxx-exceptions -fexceptions -emit-llvm -o /dev/null -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+struct A { A(); A(const A &); ~A(); };
+void g();
+void use(void (^)());
+
+// The cleanup for the block's copy of 'a' is pushed inactive at the start of
+// the full-expression and is only activated where the block literal is
+// emitted, which never happens here.  g() unwinds through it anyway, and must
+// go straight to the cleanup for 'a' itself, without a block in between that
+// only forwards to it.
+// CHECK-LABEL: define void @_Z1fv()
+// CHECK: invoke void @_Z1gv()
+// CHECK-NEXT: to label %{{.*}} unwind label %[[LPAD:.*]]
+// CHECK: [[LPAD]]:
+// CHECK-NEXT: landingpad
+// CHECK-NOT: br label
+// CHECK: call void @_ZN1AD1Ev(%struct.A* %a)
+// CHECK: {{^}}}
+void f() {
+  A a;
+  g(), 0 ? use(^{ (void)&a; }) : (void)0;
+}
+
+// STATS: *** IR Generation Stats:
+// STATS: 2 cleanup scopes, 1 EH cleanup blocks emitted, 1 skipped as inactive
+// STATS: 1 landing pads emitted, 0 shared between invokes
@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -fcxx-exceptions -fexceptions -emit-llvm -o - | FileCheck %s
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -fcxx-exceptions -fexceptions -emit-llvm -o /dev/null -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+struct A { A(); ~A(); };
+void g();
+
+// Both calls unwind through the same cleanup, so they share a landing pad.
+// CHECK-LABEL: define void @_Z1fv()
+// CHECK: invoke void @_Z1gv()
+// CHECK-NEXT: to label %{{.*}} unwind label %[[LPAD:.*]]
+// CHECK: [[LPAD]]:
+// CHECK-NEXT: landingpad
+// CHECK-NOT: landingpad
+// CHECK: invoke void @_Z1gv()
+// CHECK-NEXT: to label %{{.*}} unwind label %[[LPAD]]
+// CHECK-NOT: landingpad
+// CHECK: {{^}}}
+void f() {
+  A a;
+  g();
+  g();
+}
+
+// STATS: *** IR Generation Stats:
+// STATS: 1 cleanup scopes, 1 EH cleanup blocks emitted, 0 skipped as inactive
+// STATS: 1 landing pads emitted, 1 shared between invokes
+// STATS: 1 landing pads in '_Z1fv', the most of any function
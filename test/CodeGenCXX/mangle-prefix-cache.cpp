@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -emit-llvm %s -o - -triple=x86_64-apple-darwin9 | FileCheck %s
+// RUN: %clang_cc1 -emit-llvm %s -o /dev/null -triple=x86_64-apple-darwin9 -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+// The prefix of a name is mangled once and reused for the other names it
+// starts, together with the substitutions it introduces.
+
+namespace ns {
+  template <typename T> struct A {
+    struct B {
+      void f(B *);
+      void g(A *, B *);
+      void k() const;
+    };
+  };
+}
+
+// CHECK-DAG: define weak_odr void @_ZN2ns1AIiE1B1fEPS2_
+template <typename T> void ns::A<T>::B::f(B *) { }
+// CHECK-DAG: define weak_odr void @_ZN2ns1AIiE1B1gEPS1_PS2_
+template <typename T> void ns::A<T>::B::g(A *, B *) { }
+// CHECK-DAG: define weak_odr void @_ZNK2ns1AIiE1B1kEv
+template <typename T> void ns::A<T>::B::k() const { }
+
+template struct ns::A<int>::B;
+
+// A prefix that does not start the name is mangled in place.
+// CHECK-DAG: define void @_Z1hPN2ns1AIiE1BE
+void h(ns::A<int>::B *) { }
+// CHECK-DAG: define void @_Z2h2PN2ns1AIiE1BES3_
+void h2(ns::A<int>::B *, ns::A<int>::B *) { }
+
+// STATS: *** Itanium Name Mangling Stats:
+// STATS: names mangled, {{[0-9]+}} bytes produced
+// STATS: prefixes cached, {{[1-9][0-9]*}} prefix cache hits
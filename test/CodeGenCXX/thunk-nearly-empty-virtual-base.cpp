@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -emit-llvm -o - | FileCheck %s
+
+// D::f overrides nothing, but D is a nearly empty virtual base that is
+// primary in X and not in Y, so the Y-in-M vtable calls it through a
+// virtual this-adjusting thunk, which has to be emitted along with D::f.
+
+struct D { virtual void f() { } };
+struct X : virtual D { virtual void g(); };
+struct Y : virtual D { virtual void h(); };
+struct M : X, Y { virtual void k(); };
+
+void M::k() { }
+
+// CHECK: @_ZTV1M = {{.*}}@_ZTv0_n24_N1D1fEv
+// CHECK-DAG: define linkonce_odr void @_ZN1D1fEv(
+// CHECK-DAG: define linkonce_odr void @_ZTv0_n24_N1D1fEv(
@@ -0,0 +1,38 @@
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -emit-llvm -o - | FileCheck %s
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -emit-llvm -o /dev/null -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+struct A {
+  virtual void f();
+  virtual void g();
+};
+
+struct B : virtual A {
+  virtual void f();
+};
+
+struct C : virtual A {
+  virtual void g();
+};
+
+struct D : B, C {
+  virtual void h();
+};
+
+void A::f() { }
+void A::g() { }
+void D::h() { }
+
+// CHECK-DAG: define void @_ZTv0_n{{[0-9]+}}_N1B1fEv
+void B::f() { }
+// CHECK-DAG: define void @_ZTv0_n{{[0-9]+}}_N1C1gEv
+void C::g() { }
+
+// The construction vtables reuse the final overriders of B and C.
+// CHECK-DAG: @_ZTV1D = {{.*}}constant
+// CHECK-DAG: @_ZTC1D0_1B = {{.*}}constant
+// CHECK-DAG: @_ZTC1D{{[0-9]+}}_1C = {{.*}}constant
+
+// STATS: *** VTable Layout Stats:
+// STATS: vtable layouts computed in
+// STATS: final overrider maps computed, {{[1-9][0-9]*}} reused
+// STATS: {{[1-9][0-9]*}} thunk queries
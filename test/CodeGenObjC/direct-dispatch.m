@@ -0,0 +1,79 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -emit-llvm -fobjc-direct-dispatch -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -emit-llvm -o - %s | FileCheck -check-prefix=SEND %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -fobjc-runtime=macosx-fragile-10.5 -emit-llvm -fobjc-direct-dispatch -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -emit-llvm -fobjc-direct-dispatch -o /dev/null -print-stats %s 2>&1 | FileCheck -check-prefix=STATS %s
+
+__attribute__((objc_root_class))
+@interface Base
+- (int)value;
+@end
+
+__attribute__((objc_subclassing_restricted))
+@interface Leaf : Base
+- (int)value;
+- (void)reset;
+- (int)count;
+@end
+
+@interface Leaf (Extra)
+- (void)reset;
+@end
+
+@implementation Base
+- (int)value { return 0; }
+@end
+
+@implementation Leaf
+- (int)value { return 42; }
+- (void)reset { }
+- (int)count { return 1; }
+@end
+
+// A message to a class that cannot be subclassed calls its implementation,
+// after checking for a null receiver.
+// CHECK-LABEL: define i32 @useLeaf(
+// CHECK: [[RECV:%.*]] = bitcast {{.*}} to i8*
+// CHECK: [[ISNULL:%.*]] = icmp eq i8* [[RECV]], null
+// CHECK-NEXT: br i1 [[ISNULL]], label %[[NULLBB:.*]], label %[[CALLBB:.*]]
+// CHECK: [[RESULT:%.*]] = call i32 bitcast ({{.*}} @"\01-[Leaf value]" to i32 (i8*, i8*)*)(i8* [[RECV]], i8* {{.*}})
+// CHECK: phi i32 [ [[RESULT]], %[[CALLBB]] ], [ 0, %[[NULLBB]] ]
+// SEND-LABEL: define i32 @useLeaf(
+// SEND: call i32 bitcast ({{.*}} @objc_msgSend to
+int useLeaf(Leaf *l) {
+  return [l value];
+}
+
+// CHECK-LABEL: define i32 @useBase(
+// CHECK: call i32 bitcast ({{.*}} @objc_msgSend to
+int useBase(Base *b) {
+  return [b value];
+}
+
+// A category could replace the method.
+// CHECK-LABEL: define void @useCategory(
+// CHECK: call void bitcast ({{.*}} @objc_msgSend to
+void useCategory(Leaf *l) {
+  [l reset];
+}
+
+// A category that comes after the message replaces the method just the same.
+// CHECK-LABEL: define i32 @useLaterCategory(
+// CHECK-NOT: @"\01-[Leaf count]"
+// CHECK: call i32 bitcast ({{.*}} @objc_msgSend to
+// CHECK-NOT: @"\01-[Leaf count]"
+// CHECK: {{^}}}
+int useLaterCategory(Leaf *l) {
+  return [l count];
+}
+
+@interface Leaf (Counting)
+- (int)count;
+@end
+
+@implementation Leaf (Counting)
+- (int)count { return 2; }
+@end
+
+// STATS: *** IR Generation Stats:
+// STATS: 3 messages sent through the runtime, 1 dispatched directly
+// STATS: 1 message sends in 'useBase', the most of any function
@@ -0,0 +1,43 @@
+// REQUIRES: shell
+
+// Without a server listening on the socket, -cc1 compiles locally.
+// RUN: rm -f %t.sock
+// RUN: env CLANG_CC1_SERVER=%t.sock %clang_cc1 -fsyntax-only -verify %s
+
+// RUN: not %clang -cc1server 2>&1 | FileCheck -check-prefix=USAGE %s
+// USAGE: usage: clang -cc1server <socket-path>
+
+// Start a server and wait for it to listen.
+// RUN: rm -f %t.ll %t.pid
+// RUN: %clang -cc1server %t.sock > %t.server-log 2>&1 < /dev/null & echo $! > %t.pid
+// RUN: for i in 1 2 3 4 5 6 7 8 9 10; do test -S %t.sock && break; sleep 1; done
+//
+// A request that fails gets its diagnostics, once, and its exit status.
+// RUN: not env CLANG_CC1_SERVER=%t.sock %clang_cc1 -fsyntax-only %s 2> %t.err
+// RUN: FileCheck -check-prefix=ERR %s < %t.err
+//
+// The server is still there for the next request.  The client may not write
+// to files, so the output can only come from the server.
+// RUN: (ulimit -f 0; env CLANG_CC1_SERVER=%t.sock %clang_cc1 -emit-llvm -DNO_ERRORS %s -o %t.ll 2> %t.warn)
+// RUN: FileCheck -check-prefix=IR %s < %t.ll
+// RUN: FileCheck -check-prefix=WARN %s < %t.warn
+//
+// RUN: kill `cat %t.pid`
+
+#ifdef NO_ERRORS
+#warning compiled by the server
+int f(void) { return 42; }
+#else
+int f(void) { return undeclared; } // expected-error {{use of undeclared identifier 'undeclared'}}
+#endif
+
+// ERR: cc1-server.c:[[@LINE-3]]:22: error: use of undeclared identifier 'undeclared'
+// ERR-NOT: error:
+// ERR: 1 error generated.
+// ERR-NOT: error
+
+// IR: define i32 @f()
+// IR: ret i32 42
+
+// WARN: cc1-server.c:{{[0-9]+}}:2: warning: compiled by the server
+// WARN-NOT: warning
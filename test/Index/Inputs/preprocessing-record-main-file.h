@@ -0,0 +1,2 @@
+#define HDR_INT int
+HDR_INT header_var;
@@ -0,0 +1,23 @@
+#include "Inputs/preprocessing-record-main-file.h"
+#define MAIN_INT HDR_INT
+MAIN_INT main_var;
+
+// RUN: c-index-test -test-load-source all %s | FileCheck %s -check-prefix=ALL
+// ALL: preprocessing-record-main-file.c:1:1: inclusion directive=Inputs/preprocessing-record-main-file.h
+// ALL: preprocessing-record-main-file.h:1:9: macro definition=HDR_INT
+// ALL: preprocessing-record-main-file.h:2:1: macro expansion=HDR_INT:1:9
+// ALL: preprocessing-record-main-file.c:3:1: macro expansion=MAIN_INT:2:9
+
+// RUN: c-index-test -test-load-source all %s \
+// RUN:     -Xclang -detailed-preprocessing-record-main-file \
+// RUN:   | FileCheck %s -check-prefix=MAIN
+// MAIN: preprocessing-record-main-file.c:1:1: inclusion directive=Inputs/preprocessing-record-main-file.h
+// MAIN: preprocessing-record-main-file.h:1:9: macro definition=HDR_INT
+// MAIN-NOT: macro expansion=HDR_INT
+// MAIN: preprocessing-record-main-file.c:3:1: macro expansion=MAIN_INT:2:9
+
+// RUN: c-index-test -test-load-source all %s \
+// RUN:     -Xclang -detailed-preprocessing-record-main-file \
+// RUN:     -Xclang -detailed-preprocessing-record-file \
+// RUN:     -Xclang %S/Inputs/preprocessing-record-main-file.h \
+// RUN:   | FileCheck %s -check-prefix=ALL
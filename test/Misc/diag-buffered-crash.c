@@ -0,0 +1,13 @@
+// RUN: not --crash %clang_cc1 -fsyntax-only -fdiagnostics-buffered %s 2>&1 | FileCheck %s
+// REQUIRES: crash-recovery
+
+// Diagnostics held back by -fdiagnostics-buffered are written out when the
+// compiler crashes.
+
+void f(int *p) {
+  int x = p;
+}
+
+#pragma clang __debug crash
+
+// CHECK: diag-buffered-crash.c:8:11: warning: incompatible pointer to integer conversion
@@ -0,0 +1,28 @@
+// RUN: %clang_cc1 -fsyntax-only -fdiagnostics-buffered -print-stats %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s -check-prefix=UNBUFFERED
+// RUN: %clang -fsyntax-only -fdiagnostics-buffered %s -### 2>&1 | FileCheck %s -check-prefix=DRIVER
+
+// Buffered diagnostics are held back until the end of the source file, so
+// they come after the parser statistics, which are written to the same
+// stream directly; they are still emitted in order, with full source context.
+
+void f(int *p) {
+  int x = p;
+  int y = *p + "";
+  return 1;
+}
+
+#error done
+
+// CHECK: STATISTICS:
+// CHECK: diag-buffered.c:10:11: warning: incompatible pointer to integer conversion
+// CHECK-NEXT: int x = p;
+// CHECK-NEXT: ^
+// CHECK: diag-buffered.c:11:11: warning: incompatible pointer to integer conversion
+// CHECK: diag-buffered.c:12:3: {{.*}}void function 'f' should not return a value
+// CHECK: diag-buffered.c:15:2: error: done
+
+// UNBUFFERED: diag-buffered.c:15:2: error: done
+// UNBUFFERED: STATISTICS:
+
+// DRIVER: "-fdiagnostics-buffered"
@@ -0,0 +1 @@
+int indexed_function(void);
@@ -0,0 +1,38 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/a/Dup %t/b
+// RUN: cp %S/Inputs/module-map-index-order/b/* %t/b
+// RUN: touch -m -t 201101010000 %t/a %t/a/Dup
+// Only the second directory defines Dup; the index records that.
+// RUN: %clang_cc1 -fmodules -fmodules-cache-path=%t/cache -fdisable-module-hash -fmodules-cache-module-maps -I %t/a -I %t/b %s -verify -DUSE_B
+// RUN: %clang_cc1 -fmodules -fmodules-cache-path=%t/cache -fdisable-module-hash -fmodules-cache-module-maps -I %t/a -I %t/b %s -verify -DUSE_B -print-stats 2>&1 | FileCheck -check-prefix=CHECK-HIT %s
+//
+// A module map added to the subdirectory of the first directory that is
+// named after the module must be found instead.
+// RUN: cp %S/Inputs/module-map-index-order/a/* %t/a/Dup
+// RUN: rm -f %t/cache/Dup.pcm
+// RUN: %clang_cc1 -fmodules -fmodules-cache-path=%t/cache -fdisable-module-hash -fmodules-cache-module-maps -I %t/a -I %t/b %s -verify -print-stats 2>&1 | FileCheck -check-prefix=CHECK-MISS %s
+//
+// Start over with the second directory in the index, then add a module map to
+// the first directory itself.
+// RUN: rm -rf %t/a
+// RUN: mkdir -p %t/a
+// RUN: touch -m -t 201101010000 %t/a
+// RUN: rm -f %t/cache/Dup.pcm
+// RUN: %clang_cc1 -fmodules -fmodules-cache-path=%t/cache -fdisable-module-hash -fmodules-cache-module-maps -I %t/a -I %t/b %s -verify -DUSE_B
+// RUN: cp %S/Inputs/module-map-index-order/a/* %t/a
+// RUN: rm -f %t/cache/Dup.pcm
+// RUN: %clang_cc1 -fmodules -fmodules-cache-path=%t/cache -fdisable-module-hash -fmodules-cache-module-maps -I %t/a -I %t/b %s -verify -print-stats 2>&1 | FileCheck -check-prefix=CHECK-MISS %s
+
+// expected-no-diagnostics
+@import Dup;
+
+int test() {
+#ifdef USE_B
+  return from_b();
+#else
+  return from_a();
+#endif
+}
+
+// CHECK-HIT: 1 modules found through the module map index.
+// CHECK-MISS: 0 modules found through the module map index.
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t
+// Both directories define Dup; the first one on the search path wins.
+// RUN: %clang_cc1 -fmodules -fmodules-cache-path=%t -fdisable-module-hash -fmodules-cache-module-maps -I %S/Inputs/module-map-index-order/a -I %S/Inputs/module-map-index-order/b %s -verify
+// RUN: rm -f %t/Dup.pcm
+// The index written by the first run must not override the new search order.
+// RUN: %clang_cc1 -fmodules -fmodules-cache-path=%t -fdisable-module-hash -fmodules-cache-module-maps -I %S/Inputs/module-map-index-order/b -I %S/Inputs/module-map-index-order/a %s -verify -DUSE_B
+
+// expected-no-diagnostics
+@import Dup;
+
+int test() {
+#ifdef USE_B
+  return from_b();
+#else
+  return from_a();
+#endif
+}
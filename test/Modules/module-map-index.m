@@ -0,0 +1,18 @@
+// RUN: rm -rf %t
+// Run once to build the module and write the module map index.
+// RUN: %clang_cc1 -fmodules -fmodules-cache-path=%t -fdisable-module-hash -fmodules-cache-module-maps -I %S/Inputs/module-map-index %s -verify
+// RUN: FileCheck -check-prefix=CHECK-INDEX %s < %t/modulemaps.idx
+// Run again and find the module map through the index.
+// RUN: %clang_cc1 -fmodules -fmodules-cache-path=%t -fdisable-module-hash -fmodules-cache-module-maps -I %S/Inputs/module-map-index %s -verify -print-stats 2>&1 | FileCheck %s
+
+// expected-no-diagnostics
+@import IndexedModule;
+
+int test() {
+  return indexed_function();
+}
+
+// CHECK-INDEX: module-map-index 2
+// CHECK-INDEX: M{{.*}}module.map{{.*}}IndexedModule
+// CHECK-INDEX: N{{.*}}module-map-index
+// CHECK: 1 modules found through the module map index.
@@ -0,0 +1,50 @@
+// RUN: %clang_cc1 -verify -fopenmp -triple x86_64-unknown-unknown -emit-llvm %s -o - | FileCheck %s
+// expected-no-diagnostics
+
+void foo(int);
+int global;
+
+// CHECK-LABEL: define void @test_shared(i32 %n)
+void test_shared(int n) {
+  int sum = 0;
+// CHECK: [[CAP:%.+]] = alloca %struct.anon
+// CHECK: store i32* %sum, i32** {{%.+}}
+// CHECK: call void @GOMP_parallel_start(void (i8*)* bitcast (void (%struct.anon*)* @[[FN:__omp_parallel[0-9]*]] to void (i8*)*), i8* {{%.+}}, i32 0)
+// CHECK: call void @[[FN]](%struct.anon* [[CAP]])
+// CHECK: call void @GOMP_parallel_end()
+#pragma omp parallel shared(sum)
+  sum += n;
+  foo(sum);
+}
+
+// CHECK-LABEL: define internal void @__omp_parallel(%struct.anon*
+// CHECK: load i32**
+// CHECK: add nsw i32
+// CHECK: ret void
+
+// CHECK-LABEL: define void @test_private(i32 %a, i32 %b)
+// CHECK: call void @GOMP_parallel_start(
+// CHECK: call void @[[FN2:__omp_parallel[0-9]+]](
+// CHECK: call void @GOMP_parallel_end()
+void test_private(int a, int b) {
+  int p = 0;
+#pragma omp parallel private(p, global) firstprivate(b)
+  {
+    p = a + b;
+    global = p;
+    foo(p);
+  }
+}
+
+// CHECK-LABEL: define internal void @[[FN2]](
+// CHECK-DAG: %p.private = alloca i32
+// CHECK-DAG: %global.private = alloca i32
+// CHECK-DAG: %b.firstprivate = alloca i32
+// CHECK: [[BORIG:%.+]] = load i32** {{%.+}}
+// CHECK: [[BVAL:%.+]] = load i32* [[BORIG]]
+// CHECK: store i32 [[BVAL]], i32* %b.firstprivate
+// CHECK: load i32* %b.firstprivate
+// CHECK: store i32 {{%.+}}, i32* %p.private
+// CHECK: store i32 {{%.+}}, i32* %global.private
+// CHECK-NOT: @global
+// CHECK: ret void
@@ -0,0 +1,72 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+
+// Note that this puts the expected lines before the directives to work around
+// limitations in the -verify mode.
+
+void test(int *List, int Length) {
+  int i = 0;
+
+#pragma clang loop vectorize(enable)
+#pragma clang loop interleave_count(4)
+  while (i + 1 < Length) {
+    List[i] = i;
+  }
+
+#pragma clang loop vectorize_width(4) interleave_count(8)
+#pragma clang loop unroll(disable)
+  do {
+    List[i] = i * 2;
+  } while (i < Length);
+
+#pragma clang loop unroll_count(4)
+  for (int j = 0; j < Length; j++) {
+    List[j] = j;
+  }
+
+  int Array[3];
+#pragma clang loop vectorize(disable)
+  for (int &x : Array) {
+    x = 0;
+  }
+
+/* expected-error {{missing option; expected vectorize}} */ #pragma clang loop
+/* expected-error {{invalid option 'vectorise'; expected vectorize}} */ #pragma clang loop vectorise(enable)
+/* expected-error {{expected '('}} */ #pragma clang loop vectorize enable
+/* expected-error {{missing argument to '#pragma clang loop vectorize'}} */ #pragma clang loop vectorize()
+/* expected-error {{expected ')'}} */ #pragma clang loop vectorize(enable
+/* expected-warning {{extra tokens at end of '#pragma clang loop'}} */ #pragma clang loop vectorize(enable) ;
+  while (i < Length) {
+    List[i] = i;
+  }
+
+// expected-error@+2 {{invalid argument to '#pragma clang loop vectorize'; expected 'enable' or 'disable'}}
+// expected-error@+2 {{invalid argument to '#pragma clang loop unroll'; expected 'enable' or 'disable'}}
+#pragma clang loop vectorize(maybe)
+#pragma clang loop unroll(4)
+  while (i < Length) {
+    List[i] = i;
+  }
+
+// expected-error@+3 {{invalid argument to '#pragma clang loop vectorize_width'; expected a positive integer constant}}
+// expected-error@+3 {{invalid argument to '#pragma clang loop interleave_count'; expected a positive integer constant}}
+// expected-error@+3 {{invalid argument to '#pragma clang loop unroll_count'; expected a positive integer constant}}
+#pragma clang loop vectorize_width(0)
+#pragma clang loop interleave_count(enable)
+#pragma clang loop unroll_count(10000000000)
+  while (i < Length) {
+    List[i] = i;
+  }
+
+// expected-error@+2 {{duplicate 'vectorize_width' option in '#pragma clang loop'}}
+#pragma clang loop vectorize_width(4)
+#pragma clang loop vectorize_width(8)
+  while (i < Length) {
+    List[i] = i;
+  }
+
+#pragma clang loop unroll(enable)
+  List[0] = 0; // expected-error {{expected a for, while, or do-while loop to follow '#pragma clang loop'}}
+}
+
+#pragma clang loop vectorize(enable) // expected-error {{expected a for, while, or do-while loop to follow '#pragma clang loop'}}
+int global;
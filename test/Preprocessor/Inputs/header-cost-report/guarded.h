@@ -0,0 +1,6 @@
+#ifndef GUARDED_H
+#define GUARDED_H
+#define ONE 1
+#define TWO 2
+int guarded_var = ONE + TWO;
+#endif
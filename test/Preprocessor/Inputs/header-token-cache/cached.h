@@ -0,0 +1,13 @@
+#ifndef CACHED_H
+#define CACHED_H
+
+#define CACHED_VALUE 42
+#if CACHED_VALUE > 40
+static const char *cached_name = "cached";
+#else
+#error should not be reached
+#endif
+
+int cached_function(int);
+
+#endif
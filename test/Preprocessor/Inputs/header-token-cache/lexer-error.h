@@ -0,0 +1,3 @@
+int lexer_error_value;
+
+/* The lexer reports this comment as unterminated.
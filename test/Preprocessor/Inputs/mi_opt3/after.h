@@ -0,0 +1,5 @@
+#ifndef AFTER_H
+#define AFTER_H
+#endif
+
+extern int after;
@@ -0,0 +1,5 @@
+extern int before;
+
+#ifndef BEFORE_H
+#define BEFORE_H
+#endif
@@ -0,0 +1,4 @@
+#if !defined(CONJ_H) && !defined(NO_CONJ) && ENABLE_CONJ
+#define CONJ_H
+int conj;
+#endif /* CONJ_H */
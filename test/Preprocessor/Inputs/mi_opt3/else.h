@@ -0,0 +1,4 @@
+#ifndef ELSE_H
+#define ELSE_H
+#else
+#endif
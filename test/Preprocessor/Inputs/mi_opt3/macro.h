@@ -0,0 +1,3 @@
+#if NOT_DEFINED_MACRO_H
+#define MACRO_H
+#endif
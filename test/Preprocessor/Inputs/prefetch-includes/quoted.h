@@ -0,0 +1,2 @@
+int quoted;
+#include <angled.h>
@@ -0,0 +1,11 @@
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs/header-cost-report -header-cost-report %t %s
+// RUN: FileCheck %s < %t
+
+#include "guarded.h"
+#include "guarded.h"
+
+int main_var = ONE;
+
+// CHECK: # file entered skipped tokens macros pp-ms parse-ms inclusive-ms
+// CHECK-DAG: header-cost-report.c 1 0 5 0
+// CHECK-DAG: guarded.h 1 1 7 3
@@ -0,0 +1,13 @@
+// RUN: rm -rf %t
+// RUN: not %clang_cc1 -fsyntax-only -isystem %S/Inputs/header-token-cache -fheader-token-cache=%t -print-stats %s 2>&1 | FileCheck %s
+// RUN: not %clang_cc1 -fsyntax-only -isystem %S/Inputs/header-token-cache -fheader-token-cache=%t -print-stats %s 2>&1 | FileCheck %s
+
+// Headers whose lexing reports errors are not cached, so the errors are
+// reported every time.
+
+#include <lexer-error.h>
+
+// CHECK: lexer-error.h:3:1: error: unterminated /* comment
+// CHECK: 0 headers lexed from the cache.
+// CHECK: 0 new cache entries needed.
+// CHECK: 1 headers not cached because of lexer diagnostics.
@@ -0,0 +1,26 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fsyntax-only -verify -isystem %S/Inputs/header-token-cache -fheader-token-cache=%t -print-stats %s 2>&1 | FileCheck -check-prefix=FIRST %s
+// RUN: %clang_cc1 -fsyntax-only -verify -isystem %S/Inputs/header-token-cache -fheader-token-cache=%t -print-stats %s 2>&1 | FileCheck -check-prefix=SECOND %s
+// RUN: %clang_cc1 -E -isystem %S/Inputs/header-token-cache -fheader-token-cache=%t %s | FileCheck -check-prefix=PP %s
+
+// Headers included as user headers are always lexed from source.
+// RUN: %clang_cc1 -fsyntax-only -verify -I %S/Inputs/header-token-cache -fheader-token-cache=%t -print-stats %s 2>&1 | FileCheck -check-prefix=USER %s
+
+// expected-no-diagnostics
+
+#include <cached.h>
+
+int use(void) {
+  return cached_function(CACHED_VALUE) + cached_name[0];
+}
+
+// FIRST: 0 headers lexed from the cache.
+// FIRST: 1 new cache entries needed.
+// SECOND: 1 headers lexed from the cache.
+// SECOND: 0 new cache entries needed.
+// USER: 0 headers lexed from the cache.
+// USER: 0 new cache entries needed.
+
+// PP: static const char *cached_name = "cached";
+// PP: int cached_function(int);
+// PP: return cached_function(42) + cached_name[0];
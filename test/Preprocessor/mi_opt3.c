@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -fsyntax-only -print-stats -I %S/Inputs/mi_opt3 %s 2>&1 \
+// RUN:   | FileCheck %s
+// Check that "#if !defined(X) && ..." is treated as an include guard, and
+// that -print-stats explains why other headers could not be skipped.
+
+#define NOT_DEFINED_MACRO_H !defined(MACRO_H)
+#define ENABLE_CONJ 1
+
+#include "before.h"
+#include "before.h"
+#include "after.h"
+#include "after.h"
+#include "else.h"
+#include "else.h"
+#include "macro.h"
+#include "macro.h"
+#include "conj.h"
+#include "conj.h"
+
+// CHECK: *** HeaderSearch Stats:
+// CHECK: 1 #includes skipped due to the multi-include optimization.
+// CHECK-NEXT: Headers lexed more than once:
+// CHECK-NEXT: before.h: 2 times, tokens before the guard.
+// CHECK-NEXT: after.h: 2 times, tokens after the guard's #endif.
+// CHECK-NEXT: else.h: 2 times, top-level #else or #elif.
+// CHECK-NEXT: macro.h: 2 times, macro expanded in the guard condition.
+// CHECK-NEXT: 4 headers lexed more than once.
@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -Wunused-function %s
+
+// Unused function warnings are emitted at the end of the translation unit,
+// so each lookup of the diagnostic state goes back to an earlier region.
+
+static void f1(void) {} // expected-warning {{unused function 'f1'}}
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+static void f2(void) {}
+#pragma clang diagnostic pop
+static void f3(void) {} // expected-warning {{unused function 'f3'}}
+static void f4(void) {} // expected-warning {{unused function 'f4'}}
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+static void f5(void) {}
+static void f6(void) {}
+#pragma clang diagnostic push
+#pragma clang diagnostic warning "-Wunused-function"
+static void f7(void) {} // expected-warning {{unused function 'f7'}}
+#pragma clang diagnostic pop
+static void f8(void) {}
+#pragma clang diagnostic pop
+static void f9(void) {} // expected-warning {{unused function 'f9'}}
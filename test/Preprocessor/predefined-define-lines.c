@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -E -DSIMPLE=1+2 -DSLASH=4/2 -DFUNC(x)=x*2 -DSTR=\"s\" -DEMPTY= %s | FileCheck %s
+// RUN: %clang_cc1 -E -dM -DSIMPLE=1+2 %s | FileCheck %s --check-prefix=DUMP
+// RUN: %clang_cc1 -E -pedantic '-DUNTERMINATED="abc' -DVAARGS=__VA_ARGS__ %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=DIAG
+
+// Definitions coming from the predefines buffer must expand exactly like
+// user-written ones, whichever path handled them.
+
+// CHECK: a: 1+2
+a: SIMPLE
+// CHECK: b: 4/2
+b: SLASH
+// CHECK: c: 3*2
+c: FUNC(3)
+// CHECK: d: "s"
+d: STR
+// CHECK: e:{{ *}}.
+e: EMPTY.
+// CHECK: f: 1
+f: __STDC__
+
+// DUMP: #define SIMPLE 1+2
+// DUMP: #define __STDC__ 1
+
+// Whatever would be diagnosed in a user-written definition is diagnosed in a
+// command-line one too.
+// DIAG-DAG: warning: missing terminating '"' character
+// DIAG-DAG: warning: __VA_ARGS__ can only appear in the expansion of a C99 variadic macro
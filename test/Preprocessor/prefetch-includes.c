@@ -0,0 +1,24 @@
+// RUN: %clang_cc1 -E -fprefetch-includes=2 -I%S/Inputs/prefetch-includes \
+// RUN:   -isystem %S/Inputs/prefetch-includes/sys %s | FileCheck %s
+// RUN: %clang_cc1 -E -fprefetch-includes=2 -I%S/Inputs/prefetch-includes \
+// RUN:   -isystem %S/Inputs/prefetch-includes/sys %s -o /dev/null \
+// RUN:   -print-stats 2>&1 | FileCheck %s -check-prefix=STATS
+
+// Prefetching must not change which files are found or what they contain.
+// Each header is requested once, however often it is included, and the
+// FileManager reads both of them from the prefetched buffers.
+
+#include "quoted.h"
+#include <angled.h>
+# include"quoted.h"
+#if 0
+#include "does-not-exist.h"
+#endif
+
+// CHECK: int quoted;
+// CHECK: int angled;
+// CHECK: int quoted;
+// CHECK-NOT: int angled;
+
+// STATS: 3 prefetch requests,
+// STATS: {{[1-9][0-9]*}} prefetched stats used, 2 prefetched buffers used, 0 stale buffers dropped.
@@ -0,0 +1,7 @@
+// RUN: %clang_cc1 -E -trigraphs %s | FileCheck -strict-whitespace %s
+// Tokens are copied from the file as written unless they need cleaning.
+
+#define X(a) a
+      <: %> ??( a\
+b X(+) "str" 'c' 1.5e3
+// CHECK: {{^}}      <: %> [ ab + "str" 'c' 1.5e3{{$}}
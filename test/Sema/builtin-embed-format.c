@@ -0,0 +1,11 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -Wformat -Wformat-nonliteral -Wformat-security -I %S/Inputs %s
+// expected-no-diagnostics
+
+int printf(const char *, ...);
+
+// The contents of an embedded file have no spelling to point into, so
+// format checking leaves them alone.
+void f(void) {
+  printf(__builtin_embed("embed-format.txt"));
+  printf(__builtin_embed("embed-format.txt"), 1, "two");
+}
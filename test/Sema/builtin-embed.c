@@ -0,0 +1,9 @@
+// RUN: rm -rf %t && mkdir -p %t && touch %t/empty.bin
+// RUN: %clang_cc1 -fsyntax-only -verify -I %t %s
+
+_Static_assert(sizeof(__builtin_embed(__FILE__)) > 0, "");
+
+char a[] = __builtin_embed("does-not-exist.bin"); // expected-error {{cannot find file 'does-not-exist.bin' to embed}}
+char b[] = __builtin_embed("empty.bin"); // expected-error {{cannot embed empty file 'empty.bin'}}
+char c[] = __builtin_embed(L"empty.bin"); // expected-error {{file name for __builtin_embed must be a narrow string literal}}
+char d[] = __builtin_embed(42); // expected-error {{expected string literal in '__builtin_embed'}}
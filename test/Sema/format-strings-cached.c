@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+// Format strings are parsed once and the result is reused at every call
+// site with the same literal; make sure each call site is still checked
+// against its own arguments and diagnosed at its own location.
+
+int printf(const char *restrict, ...);
+int scanf(const char *restrict, ...);
+
+void test(int i, long l, char *s) {
+  printf("%d %s\n", i, s);
+  printf("%d %s\n", l, s); // expected-warning{{format specifies type 'int' but the argument has type 'long'}}
+  printf("%d %s\n", i, i); // expected-warning{{format specifies type 'char *' but the argument has type 'int'}}
+  printf("%d %s\n", i); // expected-warning{{more '%' conversions than data arguments}}
+  printf("%d %s\n", i, s);
+
+  // The same bytes used as a scanf format are parsed separately.
+  scanf("%d %s\n", &i, s);
+  scanf("%d %s\n", i, s); // expected-warning{{format specifies type 'int *' but the argument has type 'int'}}
+
+  printf("%y", i); // expected-warning{{invalid conversion specifier 'y'}}
+  printf("%y", i); // expected-warning{{invalid conversion specifier 'y'}}
+}
@@ -0,0 +1,12 @@
+// RUN: %clang_cc1 -fsyntax-only -ast-dump %s | FileCheck %s
+
+// Literals converted to a qualified element type become prvalues of the
+// unqualified type, as a copy-initialization would make them.
+
+// CHECK: VarDecl {{.*}} shorts 'const short [2]'
+// CHECK-NEXT: InitListExpr {{.*}} 'const short [2]'
+// CHECK-NEXT: ImplicitCastExpr {{.*}} 'short' <IntegralCast>
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 1
+// CHECK-NEXT: ImplicitCastExpr {{.*}} 'short' <IntegralCast>
+// CHECK-NEXT: UnaryOperator {{.*}} 'int' prefix '-'
+const short shorts[] = { 1, -2 };
@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+__attribute__((objc_root_class))
+@interface Root
+@end
+
+__attribute__((objc_subclassing_restricted))
+@interface Leaf : Root // expected-note 2 {{'Leaf' declared here}}
+@end
+
+@interface Twig : Leaf // expected-error {{cannot subclass 'Leaf', which was declared with the objc_subclassing_restricted attribute}}
+@end
+
+@interface Branch : Root
+@end
+
+@implementation Offshoot : Leaf // expected-warning {{cannot find interface declaration for 'Offshoot'}} expected-error {{cannot subclass 'Leaf', which was declared with the objc_subclassing_restricted attribute}}
+@end
+
+int x __attribute__((objc_subclassing_restricted)); // expected-error {{'objc_subclassing_restricted' attribute only applies to Objective-C interfaces}}
@@ -34,6 +34,7 @@
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
+#include <cstdlib>
 using namespace clang;
 using namespace llvm::opt;
 
@@ -47,6 +48,9 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
 
   Diags.Report(diag::err_fe_error_backend) << Message;
 
+  // Write out diagnostics the client may be holding back; exit() won't.
+  Diags.getClient()->finish();
+
   // Run the interrupt handlers to make sure any special cleanups get done, in
   // particular that we remove files registered with RemoveFileOnSignal.
   llvm::sys::RunInterruptHandlers();
@@ -57,8 +61,19 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
   exit(GenCrashDiag ? 70 : 1);
 }
 
+extern bool cc1_server_request(const char *SocketPath, const char **ArgBegin,
+                               const char **ArgEnd, int &Result);
+
 int cc1_main(const char **ArgBegin, const char **ArgEnd,
              const char *Argv0, void *MainAddr) {
+  // Hand the compilation over to a compile server if one is running; this
+  // skips all of the startup work below.
+  if (const char *Server = ::getenv("CLANG_CC1_SERVER")) {
+    int Result;
+    if (cc1_server_request(Server, ArgBegin, ArgEnd, Result))
+      return Result;
+  }
+
   OwningPtr<CompilerInstance> Clang(new CompilerInstance());
   IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
 
@@ -0,0 +1,544 @@
+//===-- cc1_server.cpp - Clang CC1 Compile Server -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This implements "clang -cc1server <socket>", a long-lived process that runs
+// -cc1 compilations on behalf of short-lived clients, and the client side used
+// by "clang -cc1" when the CLANG_CC1_SERVER environment variable names the
+// socket of a running server.
+//
+// The server keeps the state that every -cc1 process would otherwise rebuild
+// from scratch: targets are initialized once, and a FileManager (with its
+// cache of found and missing headers) is shared by all the requests coming
+// from the same working directory, until a change on disk is detected.  Each
+// request still gets its own CompilerInstance.
+//
+// The client passes its standard file descriptors along with the request, so
+// that diagnostics and output written to stdout end up where they would with
+// a local compilation.  When the server can't be reached, or declines the
+// request because it depends on process-wide state (-mllvm, plugins, remapped
+// files), the client simply compiles locally.
+//
+// A request that runs into an LLVM fatal error fails with the same status and
+// diagnostic as a local compilation would, and the server carries on with the
+// next request.  A request that crashes the compiler is abandoned instead, so
+// that the client reproduces the crash locally.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/Version.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/TextDiagnosticBuffer.h"
+#include "clang/FrontendTool/Utils.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(LLVM_ON_UNIX)
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace clang;
+
+#if defined(LLVM_ON_UNIX)
+
+//===----------------------------------------------------------------------===//
+// Wire protocol
+//===----------------------------------------------------------------------===//
+//
+// A request is a 4-byte magic carrying the client's stdin, stdout and stderr
+// as SCM_RIGHTS ancillary data, followed by a string count and that many
+// length-prefixed strings: the client's version, its working directory and
+// the -cc1 arguments.  The reply is a single 32-bit status, either the exit
+// code of the compilation or DeclinedStatus.
+
+static const char RequestMagic[4] = { 'C', 'C', '1', 'S' };
+static const int32_t DeclinedStatus = -1;
+static const unsigned NumPassedFDs = 3;
+
+/// \brief The maximum number of working directories whose FileManager is
+/// kept alive at once.
+static const unsigned MaxCachedFileManagers = 32;
+
+static bool WriteAll(int FD, const void *Data, size_t Size) {
+  const char *Ptr = static_cast<const char *>(Data);
+  while (Size) {
+    ssize_t Written = ::write(FD, Ptr, Size);
+    if (Written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    Ptr += Written;
+    Size -= Written;
+  }
+  return true;
+}
+
+static bool ReadAll(int FD, void *Data, size_t Size) {
+  char *Ptr = static_cast<char *>(Data);
+  while (Size) {
+    ssize_t Read = ::read(FD, Ptr, Size);
+    if (Read < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    if (Read == 0)
+      return false;
+    Ptr += Read;
+    Size -= Read;
+  }
+  return true;
+}
+
+static bool WriteString(int FD, StringRef Str) {
+  uint32_t Length = Str.size();
+  return WriteAll(FD, &Length, sizeof(Length)) &&
+         WriteAll(FD, Str.data(), Str.size());
+}
+
+static bool ReadString(int FD, std::string &Str) {
+  uint32_t Length;
+  if (!ReadAll(FD, &Length, sizeof(Length)))
+    return false;
+  Str.resize(Length);
+  return Length == 0 || ReadAll(FD, &Str[0], Length);
+}
+
+static bool FillSocketAddress(StringRef Path, sockaddr_un &Addr) {
+  memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (Path.size() >= sizeof(Addr.sun_path))
+    return false;
+  memcpy(Addr.sun_path, Path.data(), Path.size());
+  return true;
+}
+
+static bool SendRequestHeader(int Sock) {
+  struct iovec IOV;
+  IOV.iov_base = const_cast<char *>(RequestMagic);
+  IOV.iov_len = sizeof(RequestMagic);
+
+  union {
+    struct cmsghdr Align;
+    char Buf[CMSG_SPACE(NumPassedFDs * sizeof(int))];
+  } Control;
+  memset(&Control, 0, sizeof(Control));
+
+  struct msghdr Msg;
+  memset(&Msg, 0, sizeof(Msg));
+  Msg.msg_iov = &IOV;
+  Msg.msg_iovlen = 1;
+  Msg.msg_control = Control.Buf;
+  Msg.msg_controllen = sizeof(Control.Buf);
+
+  struct cmsghdr *CMsg = CMSG_FIRSTHDR(&Msg);
+  CMsg->cmsg_level = SOL_SOCKET;
+  CMsg->cmsg_type = SCM_RIGHTS;
+  CMsg->cmsg_len = CMSG_LEN(NumPassedFDs * sizeof(int));
+  int FDs[NumPassedFDs] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+  memcpy(CMSG_DATA(CMsg), FDs, sizeof(FDs));
+
+  ssize_t Sent;
+  do {
+    Sent = ::sendmsg(Sock, &Msg, 0);
+  } while (Sent < 0 && errno == EINTR);
+  return Sent == ssize_t(sizeof(RequestMagic));
+}
+
+static bool ReceiveRequestHeader(int Sock, int (&FDs)[NumPassedFDs]) {
+  char Magic[sizeof(RequestMagic)];
+  struct iovec IOV;
+  IOV.iov_base = Magic;
+  IOV.iov_len = sizeof(Magic);
+
+  union {
+    struct cmsghdr Align;
+    char Buf[CMSG_SPACE(NumPassedFDs * sizeof(int))];
+  } Control;
+
+  struct msghdr Msg;
+  memset(&Msg, 0, sizeof(Msg));
+  Msg.msg_iov = &IOV;
+  Msg.msg_iovlen = 1;
+  Msg.msg_control = Control.Buf;
+  Msg.msg_controllen = sizeof(Control.Buf);
+
+  ssize_t Received;
+  do {
+    Received = ::recvmsg(Sock, &Msg, 0);
+  } while (Received < 0 && errno == EINTR);
+  if (Received != ssize_t(sizeof(Magic)))
+    return false;
+
+  struct cmsghdr *CMsg = CMSG_FIRSTHDR(&Msg);
+  if (!CMsg || CMsg->cmsg_level != SOL_SOCKET ||
+      CMsg->cmsg_type != SCM_RIGHTS ||
+      CMsg->cmsg_len != CMSG_LEN(NumPassedFDs * sizeof(int)))
+    return false;
+  memcpy(FDs, CMSG_DATA(CMsg), sizeof(FDs));
+
+  if (memcmp(Magic, RequestMagic, sizeof(Magic)) != 0) {
+    for (unsigned I = 0; I != NumPassedFDs; ++I)
+      ::close(FDs[I]);
+    return false;
+  }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Client
+//===----------------------------------------------------------------------===//
+
+/// \brief Try to run the -cc1 invocation [ArgBegin, ArgEnd) on the compile
+/// server listening at \p SocketPath.
+///
+/// \returns true if the server ran the compilation, in which case \p Result
+/// holds its exit code; false if the caller should compile locally.
+bool cc1_server_request(const char *SocketPath, const char **ArgBegin,
+                        const char **ArgEnd, int &Result) {
+  sockaddr_un Addr;
+  if (!FillSocketAddress(SocketPath, Addr))
+    return false;
+
+  SmallString<256> CWD;
+  if (llvm::sys::fs::current_path(CWD))
+    return false;
+
+  int Sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Sock < 0)
+    return false;
+
+  bool Sent = false;
+  if (::connect(Sock, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) == 0
+      && SendRequestHeader(Sock)) {
+    uint32_t NumStrings = 2 + (ArgEnd - ArgBegin);
+    Sent = WriteAll(Sock, &NumStrings, sizeof(NumStrings)) &&
+           WriteString(Sock, getClangFullVersion()) &&
+           WriteString(Sock, CWD.str());
+    for (const char **Arg = ArgBegin; Sent && Arg != ArgEnd; ++Arg)
+      Sent = WriteString(Sock, *Arg);
+  }
+
+  // If the server declines the request, for instance because the compiler
+  // crashed on this input, or goes away before replying, fall back to a local
+  // compilation.
+  int32_t Status;
+  bool Handled = Sent && ReadAll(Sock, &Status, sizeof(Status)) &&
+                 Status != DeclinedStatus;
+  ::close(Sock);
+
+  if (Handled)
+    Result = Status;
+  return Handled;
+}
+
+//===----------------------------------------------------------------------===//
+// Server
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// \brief The state that outlives the individual requests.
+class ServerState {
+  const char *Argv0;
+  void *MainAddr;
+
+  /// \brief The warm FileManagers, keyed by the request's working directory
+  /// and -working-directory option.
+  llvm::StringMap<IntrusiveRefCntPtr<FileManager> > FileManagers;
+
+public:
+  ServerState(const char *Argv0, void *MainAddr)
+    : Argv0(Argv0), MainAddr(MainAddr) {}
+
+  /// \brief Run a single -cc1 invocation from the directory \p CWD.
+  int32_t runRequest(StringRef CWD, const std::vector<const char *> &Args);
+
+private:
+  FileManager *getFileManager(StringRef CWD, const FileSystemOptions &Opts);
+};
+}
+
+namespace {
+/// \brief What the fatal error handler needs to know about the request being
+/// run.
+struct RequestContext {
+  DiagnosticsEngine *Diags;
+  CompilerInstance *Clang;
+  bool Success;
+
+  /// \brief The exit status after an LLVM fatal error, or 0.
+  int32_t FatalErrorStatus;
+};
+}
+
+static void ServerErrorHandler(void *UserData, const std::string &Message,
+                               bool GenCrashDiag) {
+  RequestContext &Context = *static_cast<RequestContext*>(UserData);
+
+  Context.Diags->Report(diag::err_fe_error_backend) << Message;
+  Context.Diags->getClient()->finish();
+
+  // Run the interrupt handlers to make sure any special cleanups get done, in
+  // particular that we remove files registered with RemoveFileOnSignal.
+  llvm::sys::RunInterruptHandlers();
+
+  // As in cc1_main, LLVM errors are not recoverable, but only this request
+  // has to stop: fail it with the status a local compilation would exit with.
+  Context.FatalErrorStatus = GenCrashDiag ? 70 : 1;
+  if (llvm::CrashRecoveryContext *CRC
+        = llvm::CrashRecoveryContext::GetCurrent())
+    CRC->HandleCrash();
+  exit(Context.FatalErrorStatus);
+}
+
+static void RunCompilerInvocation(void *UserData) {
+  RequestContext &Context = *static_cast<RequestContext*>(UserData);
+  Context.Success = ExecuteCompilerInvocation(Context.Clang);
+}
+
+FileManager *ServerState::getFileManager(StringRef CWD,
+                                         const FileSystemOptions &Opts) {
+  std::string Key = CWD.str();
+  Key += '\0';
+  Key += Opts.WorkingDir;
+
+  IntrusiveRefCntPtr<FileManager> &FM = FileManagers[Key];
+  if (FM && FM->hasFileSystemChanged())
+    FM = 0;
+  if (!FM) {
+    if (FileManagers.size() > MaxCachedFileManagers) {
+      FileManagers.clear();
+      return getFileManager(CWD, Opts);
+    }
+    FM = new FileManager(Opts);
+    FM->trackUsedEntries();
+  }
+  return FM.getPtr();
+}
+
+int32_t ServerState::runRequest(StringRef CWD,
+                                const std::vector<const char *> &Args) {
+  if (::chdir(CWD.str().c_str()) != 0)
+    return DeclinedStatus;
+
+  OwningPtr<CompilerInstance> Clang(new CompilerInstance());
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticBuffer *DiagsBuffer = new TextDiagnosticBuffer;
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagsBuffer);
+  bool Success = CompilerInvocation::CreateFromArgs(Clang->getInvocation(),
+                                                    Args.data(),
+                                                    Args.data() + Args.size(),
+                                                    Diags);
+
+  // Options that change process-wide state can't be honored per request.
+  FrontendOptions &FrontendOpts = Clang->getFrontendOpts();
+  PreprocessorOptions &PPOpts = Clang->getPreprocessorOpts();
+  if (!FrontendOpts.LLVMArgs.empty() || !FrontendOpts.Plugins.empty() ||
+      !PPOpts.RemappedFiles.empty() || !PPOpts.RemappedFileBuffers.empty())
+    return DeclinedStatus;
+
+  // The server is going to run more compilations, so everything has to be
+  // released.
+  FrontendOpts.DisableFree = false;
+
+  if (Clang->getHeaderSearchOpts().UseBuiltinIncludes &&
+      Clang->getHeaderSearchOpts().ResourceDir.empty())
+    Clang->getHeaderSearchOpts().ResourceDir =
+      CompilerInvocation::GetResourcesPath(Argv0, MainAddr);
+
+  Clang->createDiagnostics();
+  if (!Clang->hasDiagnostics())
+    return 1;
+
+  RequestContext Context;
+  Context.Diags = &Clang->getDiagnostics();
+  Context.Clang = Clang.get();
+  Context.Success = Success;
+  Context.FatalErrorStatus = 0;
+  llvm::install_fatal_error_handler(ServerErrorHandler,
+                                    static_cast<void*>(&Context));
+
+  DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
+  if (Success) {
+    FileManager *FM = getFileManager(CWD, Clang->getFileSystemOpts());
+    Clang->setFileManager(FM);
+
+    llvm::CrashRecoveryContext CRC;
+    if (!CRC.RunSafely(RunCompilerInvocation, &Context)) {
+      llvm::remove_fatal_error_handler();
+
+      // The compiler was stopped half-way, so none of its state can be
+      // trusted, or even safely destroyed.
+      Clang.take();
+      FileManagers.clear();
+      return Context.FatalErrorStatus ? Context.FatalErrorStatus
+                                      : DeclinedStatus;
+    }
+    Success = Context.Success;
+
+    // Stat caches installed for PCH or PTH files belong to this request, and
+    // only what it looked up is worth checking before the next one.
+    FM->clearStatCaches();
+    FM->discardUnusedEntries();
+  }
+
+  llvm::TimerGroup::printAll(llvm::errs());
+  llvm::remove_fatal_error_handler();
+
+  Clang.reset();
+  return !Success;
+}
+
+/// \brief Read one request from \p Conn, run it and send back its status.
+static void HandleConnection(ServerState &State, int Conn,
+                             const int (&SavedFDs)[NumPassedFDs]) {
+  int FDs[NumPassedFDs];
+  if (!ReceiveRequestHeader(Conn, FDs))
+    return;
+
+  uint32_t NumStrings;
+  std::vector<std::string> Strings;
+  bool Valid = ReadAll(Conn, &NumStrings, sizeof(NumStrings)) &&
+               NumStrings >= 2;
+  if (Valid) {
+    Strings.resize(NumStrings);
+    for (unsigned I = 0; Valid && I != NumStrings; ++I)
+      Valid = ReadString(Conn, Strings[I]);
+  }
+
+  int32_t Status = DeclinedStatus;
+  if (Valid && Strings[0] == getClangFullVersion()) {
+    std::vector<const char *> Args;
+    for (unsigned I = 2; I != NumStrings; ++I)
+      Args.push_back(Strings[I].c_str());
+
+    // Compile with the client's standard streams.
+    llvm::outs().flush();
+    for (unsigned I = 0; I != NumPassedFDs; ++I)
+      ::dup2(FDs[I], I);
+
+    Status = State.runRequest(Strings[1], Args);
+
+    llvm::outs().flush();
+    fflush(stdout);
+    fflush(stderr);
+    for (unsigned I = 0; I != NumPassedFDs; ++I)
+      ::dup2(SavedFDs[I], I);
+  }
+
+  for (unsigned I = 0; I != NumPassedFDs; ++I)
+    ::close(FDs[I]);
+
+  WriteAll(Conn, &Status, sizeof(Status));
+}
+
+int cc1server_main(const char **ArgBegin, const char **ArgEnd,
+                   const char *Argv0, void *MainAddr) {
+  if (ArgEnd - ArgBegin != 1) {
+    llvm::errs() << "usage: clang -cc1server <socket-path>\n";
+    return 1;
+  }
+
+  StringRef SocketPath = ArgBegin[0];
+  sockaddr_un Addr;
+  if (!FillSocketAddress(SocketPath, Addr)) {
+    llvm::errs() << "error: socket path '" << SocketPath << "' is too long\n";
+    return 1;
+  }
+
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+
+  // Writing to the stdout of a client that went away must not kill the
+  // server.
+  ::signal(SIGPIPE, SIG_IGN);
+
+  // Let a request that fails or crashes return control to the server.
+  llvm::CrashRecoveryContext::Enable();
+
+  int Listen = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Listen < 0) {
+    llvm::errs() << "error: unable to create socket: " << strerror(errno)
+                 << '\n';
+    return 1;
+  }
+
+  ::unlink(Addr.sun_path);
+  if (::bind(Listen, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) != 0 ||
+      ::listen(Listen, SOMAXCONN) != 0) {
+    llvm::errs() << "error: unable to listen on '" << SocketPath << "': "
+                 << strerror(errno) << '\n';
+    ::close(Listen);
+    return 1;
+  }
+
+  int SavedFDs[NumPassedFDs];
+  for (unsigned I = 0; I != NumPassedFDs; ++I)
+    SavedFDs[I] = ::dup(I);
+
+  // Requests are served one at a time; concurrent clients wait in the listen
+  // queue.
+  ServerState State(Argv0, MainAddr);
+  while (true) {
+    int Conn = ::accept(Listen, 0, 0);
+    if (Conn < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      llvm::errs() << "error: accept failed: " << strerror(errno) << '\n';
+      break;
+    }
+    HandleConnection(State, Conn, SavedFDs);
+    ::close(Conn);
+  }
+
+  ::close(Listen);
+  ::unlink(Addr.sun_path);
+  return 1;
+}
+
+#else
+
+bool cc1_server_request(const char *SocketPath, const char **ArgBegin,
+                        const char **ArgEnd, int &Result) {
+  return false;
+}
+
+int cc1server_main(const char **ArgBegin, const char **ArgEnd,
+                   const char *Argv0, void *MainAddr) {
+  llvm::errs() << "error: -cc1server is not supported on this platform\n";
+  return 1;
+}
+
+#endif
@@ -8,8 +8,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileOverlay.h"
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -199,6 +202,118 @@ TEST_F(FileManagerTest, getFileReturnsNULLForNonexistentFile) {
   EXPECT_EQ(NULL, file);
 }
 
+// Files in an overlay are found, along with their directories, and their
+// contents are shared by all FileManagers using the overlay.
+TEST_F(FileManagerTest, getFileFindsOverlayFiles) {
+  InMemoryFileOverlay *Overlay = new InMemoryFileOverlay;
+  Overlay->addFile("gen/dir/gen.h",
+                   MemoryBuffer::getMemBufferCopy("int gen;\n"), 100);
+  options.Overlay = Overlay;
+
+  FileManager first(options), second(options);
+  first.addStatCache(new FakeStatCache);
+  second.addStatCache(new FakeStatCache);
+
+  const FileEntry *file = first.getFile("gen/dir/gen.h");
+  ASSERT_TRUE(file != NULL);
+  EXPECT_EQ(9, file->getSize());
+  EXPECT_EQ(100, file->getModificationTime());
+  ASSERT_TRUE(file->getDir() != NULL);
+  EXPECT_STREQ("gen/dir", file->getDir()->getName());
+  EXPECT_TRUE(first.getDirectory("gen") != NULL);
+  EXPECT_EQ(NULL, first.getFile("gen/dir/other.h"));
+
+  OwningPtr<MemoryBuffer> firstBuffer(first.getBufferForFile(file));
+  ASSERT_TRUE(firstBuffer.get() != NULL);
+  EXPECT_EQ("int gen;\n", firstBuffer->getBuffer());
+
+  const FileEntry *secondFile = second.getFile("gen/dir/gen.h");
+  ASSERT_TRUE(secondFile != NULL);
+  OwningPtr<MemoryBuffer> secondBuffer(second.getBufferForFile(secondFile));
+  ASSERT_TRUE(secondBuffer.get() != NULL);
+  EXPECT_EQ(firstBuffer->getBufferStart(), secondBuffer->getBufferStart());
+}
+
+// Overlay files hide real files, but real directories hide overlay
+// directories.
+TEST_F(FileManagerTest, overlayFilesHideRealFiles) {
+  InMemoryFileOverlay *Overlay = new InMemoryFileOverlay;
+  Overlay->addFile("abc/foo.h", MemoryBuffer::getMemBufferCopy("foo"));
+  options.Overlay = Overlay;
+  FileManager overlaid(options);
+
+  FakeStatCache *statCache = new FakeStatCache;
+  statCache->InjectDirectory("abc", 41);
+  statCache->InjectFile("abc/foo.h", 42);
+  statCache->InjectFile("abc/bar.h", 43);
+  overlaid.addStatCache(statCache);
+
+  const FileEntry *foo = overlaid.getFile("abc/foo.h");
+  ASSERT_TRUE(foo != NULL);
+  EXPECT_EQ(3, foo->getSize());
+  EXPECT_FALSE(foo->getUniqueID() == llvm::sys::fs::UniqueID(1, 42));
+
+  const FileEntry *bar = overlaid.getFile("abc/bar.h");
+  ASSERT_TRUE(bar != NULL);
+  EXPECT_TRUE(bar->getUniqueID() == llvm::sys::fs::UniqueID(1, 43));
+  EXPECT_EQ(foo->getDir(), bar->getDir());
+}
+
+// Stat caches installed at the beginning of the chain, like the ones that
+// record stat calls, see overlay files, and so do non-cached lookups.
+TEST_F(FileManagerTest, overlayFilesAreSeenByAllStatLookups) {
+  InMemoryFileOverlay *Overlay = new InMemoryFileOverlay;
+  Overlay->addFile("gen/gen.h", MemoryBuffer::getMemBufferCopy("gen"), 100);
+  Overlay->addFile("more/more.h", MemoryBuffer::getMemBufferCopy("more"));
+  options.Overlay = Overlay;
+  FileManager overlaid(options);
+  overlaid.addStatCache(new FakeStatCache);
+  MemorizeStatCalls *recorder = new MemorizeStatCalls;
+  overlaid.addStatCache(recorder, /*AtBeginning=*/true);
+
+  ASSERT_TRUE(overlaid.getFile("gen/gen.h") != NULL);
+  EXPECT_EQ(1U, recorder->StatCalls.count("gen/gen.h"));
+
+  FileData Data;
+  EXPECT_FALSE(overlaid.getNoncachedStatValue("gen/gen.h", Data,
+                                              /*isFile=*/true));
+  EXPECT_EQ(3U, Data.Size);
+  EXPECT_EQ(100, Data.ModTime);
+  EXPECT_FALSE(overlaid.getNoncachedStatValue("gen", Data,
+                                              /*isFile=*/false));
+  EXPECT_TRUE(overlaid.getNoncachedStatValue("gen/gen.h", Data,
+                                             /*isFile=*/false));
+
+  // The overlay outlives the stat caches.
+  overlaid.clearStatCaches();
+  overlaid.addStatCache(new FakeStatCache);
+  EXPECT_TRUE(overlaid.getFile("more/more.h") != NULL);
+}
+
+// Overlays can be layered on top of each other.
+TEST_F(FileManagerTest, overlaysCanBeLayered) {
+  InMemoryFileOverlay *Lower = new InMemoryFileOverlay;
+  Lower->addFile("gen/a.h", MemoryBuffer::getMemBufferCopy("lower a"));
+  Lower->addFile("gen/b.h", MemoryBuffer::getMemBufferCopy("lower b"));
+  InMemoryFileOverlay *Upper = new InMemoryFileOverlay(Lower);
+  Upper->addFile("gen/a.h", MemoryBuffer::getMemBufferCopy("upper a"));
+  options.Overlay = Upper;
+  FileManager overlaid(options);
+  overlaid.addStatCache(new FakeStatCache);
+
+  const FileEntry *a = overlaid.getFile("gen/a.h");
+  const FileEntry *b = overlaid.getFile("gen/b.h");
+  ASSERT_TRUE(a != NULL);
+  ASSERT_TRUE(b != NULL);
+
+  OwningPtr<MemoryBuffer> aBuffer(overlaid.getBufferForFile(a));
+  OwningPtr<MemoryBuffer> bBuffer(overlaid.getBufferForFile(b));
+  ASSERT_TRUE(aBuffer.get() != NULL);
+  ASSERT_TRUE(bBuffer.get() != NULL);
+  EXPECT_EQ("upper a", aBuffer->getBuffer());
+  EXPECT_EQ("lower b", bBuffer->getBuffer());
+}
+
 // The following tests apply to Unix-like system only.
 
 #ifndef _WIN32
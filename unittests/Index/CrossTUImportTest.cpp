@@ -0,0 +1,165 @@
+//===- unittest/Index/CrossTUImportTest.cpp - Cross-TU import tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Index/CrossTUImport.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <iterator>
+#include <string>
+
+namespace clang {
+namespace index {
+
+namespace {
+
+FunctionDecl *findFunction(ASTUnit &Unit, StringRef Name) {
+  TranslationUnitDecl *TU = Unit.getASTContext().getTranslationUnitDecl();
+  for (DeclContext::decl_iterator D = TU->decls_begin(),
+                               DEnd = TU->decls_end();
+       D != DEnd; ++D)
+    if (FunctionDecl *FD = dyn_cast<FunctionDecl>(*D))
+      if (FD->getIdentifier() && FD->getName() == Name)
+        return FD;
+  return 0;
+}
+
+/// \brief Builds the AST for \p Code and saves it to a temporary file.
+bool saveAST(StringRef Code, StringRef FileName, SmallVectorImpl<char> &Path) {
+  llvm::OwningPtr<ASTUnit> Unit(tooling::buildASTFromCode(Code, FileName));
+  if (!Unit.get())
+    return false;
+  if (llvm::sys::fs::createTemporaryFile("cross-tu", "ast", Path))
+    return false;
+  return !Unit->Save(StringRef(Path.data(), Path.size()));
+}
+
+} // end namespace
+
+TEST(CrossTUImporter, ImportsDefinitionOnDemand) {
+  SmallString<128> ASTFile;
+  ASSERT_TRUE(saveAST("int g(int x) { return x * 2; }\n"
+                      "int f(int x) {\n"
+                      "  int y = 0;\n"
+                      "  for (int i = 0; i < x; ++i)\n"
+                      "    y += g(i);\n"
+                      "  return y;\n"
+                      "}\n",
+                      "def.cc", ASTFile));
+
+  llvm::OwningPtr<ASTUnit> Unit(tooling::buildASTFromCode(
+      "int f(int x);\n"
+      "int h() { return f(3); }\n", "use.cc"));
+  ASSERT_TRUE(Unit.get() != 0);
+  FunctionDecl *F = findFunction(*Unit, "f");
+  ASSERT_TRUE(F != 0);
+  EXPECT_FALSE(F->hasBody());
+
+  SmallString<128> USR;
+  ASSERT_FALSE(generateUSRForDecl(F, USR));
+
+  CrossTUImporter Importer(Unit->getASTContext(), Unit->getFileManager(),
+                           Unit->getDiagnostics());
+  Importer.addDefinitionFile(USR, ASTFile);
+  const FunctionDecl *Def = Importer.getCrossTUDefinition(F);
+  ASSERT_TRUE(Def != 0);
+  EXPECT_TRUE(Def->hasBody());
+  EXPECT_EQ(F->getCanonicalDecl(), Def->getCanonicalDecl());
+  EXPECT_EQ(&Unit->getASTContext(), &Def->getASTContext());
+
+  // The definition of g was not asked for, so only its declaration came along.
+  FunctionDecl *G = findFunction(*Unit, "g");
+  ASSERT_TRUE(G != 0);
+  EXPECT_FALSE(G->hasBody());
+  EXPECT_TRUE(Importer.getCrossTUDefinition(G) == 0);
+
+  llvm::sys::fs::remove(ASTFile.str());
+}
+
+TEST(CrossTUImporter, UnimportableBodyLeavesNoTrace) {
+  SmallString<128> ASTFile;
+  ASSERT_TRUE(saveAST("int f(int x) {\n"
+                      "  int y = x;\n"
+                      "  switch (y) {\n"
+                      "  case 1: return 2;\n"
+                      "  }\n"
+                      "  return y;\n"
+                      "}\n",
+                      "def.cc", ASTFile));
+
+  llvm::OwningPtr<ASTUnit> Unit(tooling::buildASTFromCode("int f(int x);\n",
+                                                          "use.cc"));
+  ASSERT_TRUE(Unit.get() != 0);
+  FunctionDecl *F = findFunction(*Unit, "f");
+  ASSERT_TRUE(F != 0);
+  unsigned NumDecls = std::distance(F->decls_begin(), F->decls_end());
+
+  SmallString<128> USR;
+  ASSERT_FALSE(generateUSRForDecl(F, USR));
+
+  CrossTUImporter Importer(Unit->getASTContext(), Unit->getFileManager(),
+                           Unit->getDiagnostics());
+  Importer.addDefinitionFile(USR, ASTFile);
+  EXPECT_TRUE(Importer.getCrossTUDefinition(F) == 0);
+  EXPECT_FALSE(F->hasBody());
+
+  // The local variable imported before the switch was given up on is gone,
+  // and the failure was not reported.
+  EXPECT_EQ(NumDecls, unsigned(std::distance(F->decls_begin(),
+                                             F->decls_end())));
+  EXPECT_FALSE(Unit->getDiagnostics().hasErrorOccurred());
+  EXPECT_EQ(0u, Unit->getDiagnostics().getClient()->getNumErrors());
+
+  llvm::sys::fs::remove(ASTFile.str());
+}
+
+TEST(CrossTUImporter, NoDefinitionWithoutIndexEntry) {
+  llvm::OwningPtr<ASTUnit> Unit(tooling::buildASTFromCode("int f(int x);\n"));
+  ASSERT_TRUE(Unit.get() != 0);
+  FunctionDecl *F = findFunction(*Unit, "f");
+  ASSERT_TRUE(F != 0);
+
+  CrossTUImporter Importer(Unit->getASTContext(), Unit->getFileManager(),
+                           Unit->getDiagnostics());
+  EXPECT_TRUE(Importer.getCrossTUDefinition(F) == 0);
+  EXPECT_FALSE(F->hasBody());
+}
+
+TEST(CrossTUImporter, RejectsMalformedIndex) {
+  SmallString<128> IndexFile;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("cross-tu", "txt",
+                                                  IndexFile));
+  {
+    std::string ErrorInfo;
+    llvm::raw_fd_ostream OS(IndexFile.c_str(), ErrorInfo);
+    ASSERT_TRUE(ErrorInfo.empty());
+    OS << "c:@F@f#I# f.ast\n"
+       << "c:@F@g#I#\n";
+  }
+
+  llvm::OwningPtr<ASTUnit> Unit(tooling::buildASTFromCode(""));
+  ASSERT_TRUE(Unit.get() != 0);
+  CrossTUImporter Importer(Unit->getASTContext(), Unit->getFileManager(),
+                           Unit->getDiagnostics());
+  std::string ErrorMessage;
+  EXPECT_FALSE(Importer.loadIndex(IndexFile, ErrorMessage));
+  EXPECT_NE(std::string::npos, ErrorMessage.find(":2: "));
+
+  llvm::sys::fs::remove(IndexFile.str());
+}
+
+} // end namespace index
+} // end namespace clang
@@ -0,0 +1,65 @@
+#!/usr/bin/env python
+
+"""
+Measure the throughput of preprocessing with -E: run 'clang -cc1 -E' on each
+input file a number of times and report the preprocessed output produced per
+second.
+
+This covers everything a distributed build does before shipping a translation
+unit elsewhere: lexing, macro expansion, header search and writing the
+preprocessed output.
+"""
+
+import os
+import subprocess
+import sys
+import time
+
+def main():
+    from optparse import OptionParser
+    parser = OptionParser("usage: %prog [options] path/to/clang file... "
+                          "[-- cc1 args...]")
+    parser.add_option("-n", "--runs", dest="runs", type=int, default=10,
+                      help="number of times to preprocess each file "
+                      "[%default]")
+    opts, args = parser.parse_args()
+
+    cc1_args = []
+    if '--' in args:
+        cc1_args = args[args.index('--') + 1:]
+        args = args[:args.index('--')]
+    if len(args) < 2:
+        parser.error("invalid number of arguments")
+
+    clang, inputs = args[0], args[1:]
+    total_bytes = 0
+    total_time = 0.
+    for input in inputs:
+        cmd = [clang, '-cc1', '-E'] + cc1_args + [input]
+
+        # Measure the output once, which also warms up the file system caches.
+        output = subprocess.check_output(cmd)
+
+        times = []
+        devnull = open(os.devnull, 'w')
+        try:
+            for i in range(opts.runs):
+                start = time.time()
+                subprocess.check_call(cmd + ['-o', os.devnull],
+                                      stdout=devnull)
+                times.append(time.time() - start)
+        finally:
+            devnull.close()
+
+        times.sort()
+        median = times[len(times) // 2]
+        print '%s: %d bytes, median %.2fms, %.2f MB/s' % (
+            input, len(output), median * 1000.,
+            len(output) / median / (1024. * 1024.))
+        total_bytes += len(output) * len(times)
+        total_time += sum(times)
+
+    print 'total: %.2f MB/s' % (total_bytes / total_time / (1024. * 1024.))
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,59 @@
+#!/usr/bin/env python
+
+"""
+Measure the fixed cost of starting a compilation: run 'clang -cc1
+-fsyntax-only' on an empty file a number of times and report the timings.
+
+Anything done for every translation unit before the first user token is read
+(target setup, builtin registration, the predefines buffer) shows up here.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+def main():
+    from optparse import OptionParser
+    parser = OptionParser("usage: %prog [options] path/to/clang [cc1 args...]")
+    parser.add_option("-n", "--runs", dest="runs", type=int, default=50,
+                      help="number of compilations to time [%default]")
+    parser.add_option("-x", "--language", dest="language", default="c",
+                      help="input language passed with -x [%default]")
+    parser.add_option("", "--triple", dest="triple", default=None,
+                      help="target triple passed with -triple")
+    opts, args = parser.parse_args()
+
+    if not args:
+        parser.error("invalid number of arguments")
+
+    fd, input = tempfile.mkstemp(suffix='.' + opts.language)
+    os.close(fd)
+    try:
+        cmd = [args[0], '-cc1', '-fsyntax-only', '-x', opts.language]
+        if opts.triple:
+            cmd.extend(['-triple', opts.triple])
+        cmd.extend(args[1:])
+        cmd.append(input)
+
+        # Warm up the file system caches before timing.
+        subprocess.check_call(cmd)
+
+        times = []
+        for i in range(opts.runs):
+            start = time.time()
+            subprocess.check_call(cmd)
+            times.append(time.time() - start)
+    finally:
+        os.remove(input)
+
+    times.sort()
+    print 'runs: %d' % len(times)
+    print 'min:    %.2fms' % (times[0] * 1000.)
+    print 'median: %.2fms' % (times[len(times) // 2] * 1000.)
+    print 'mean:   %.2fms' % (sum(times) / len(times) * 1000.)
+    print 'max:    %.2fms' % (times[-1] * 1000.)
+
+if __name__ == '__main__':
+    main()